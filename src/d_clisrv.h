@@ -25,7 +25,11 @@
 #include "d_player.h"
 
 // more precise version number to compare in network
+#ifdef THINGGRID
+#define SUBVERSION 106 // can't play along with builds that touch things in blockmap order
+#else
 #define SUBVERSION 006
+#endif
 
 // Network play related stuff.
 // There is a data struct that stores network
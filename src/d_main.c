@@ -51,6 +51,7 @@
 #include "hu_stuff.h"
 #include "i_sound.h"
 #include "i_system.h"
+#include "i_threads.h"
 #include "i_video.h"
 #include "m_argv.h"
 #include "m_menu.h"
@@ -1416,8 +1417,29 @@ void D_SRB2Main(void)
 		G_ModifyGame();
 	}
 
+	// -simbench <map> [-bots <num>] [-tics <num>]: time the game logic and quit
+	if (M_CheckParm("-simbench") && M_IsNextParm())
+	{
+		int bots = 0;
+		tic_t tics = 60*TICRATE;
+
+		pstartmap = atoi(M_GetNextParm());
+		autostart = true;
+
+		if (M_CheckParm("-bots") && M_IsNextParm())
+			bots = atoi(M_GetNextParm());
+		if (M_CheckParm("-tics") && M_IsNextParm())
+			tics = (tic_t)atoi(M_GetNextParm());
+
+		nosound = nomidimusic = nodigimusic = true;
+		G_ModifyGame();
+		G_StartSimBench(bots, tics);
+	}
+
 	CONS_Printf("%s",text[Z_INIT]);
 	Z_Init();
+	P_InitObjectPools();
+	I_InitThreads();
 
 	// adapt tables to SRB2's needs, including extra slots for dehacked file support
 	P_PatchInfoTables();
@@ -24,6 +24,7 @@
 #include "console.h"
 #include "command.h"
 #include "i_system.h"
+#include "m_argv.h"
 #include "dstrings.h"
 #include "g_game.h"
 #include "hu_stuff.h"
@@ -822,6 +823,15 @@ void D_RegisterClientCommands(void)
 
 	COM_AddCommand("numthinkers", Command_Numthinkers_f);
 	COM_AddCommand("countmobjs", Command_CountMobjs_f);
+	COM_AddCommand("thinkprofile", Command_Thinkprofile_f);
+	if (M_CheckParm("-thinkprofile"))
+		thinkprofiling = true;
+	COM_AddCommand("sortbench", Command_SortBench_f);
+	COM_AddCommand("sightcounts", Command_Sightcounts_f);
+	COM_AddCommand("collidecounts", Command_Collidecounts_f);
+	COM_AddCommand("drawstats", Command_Drawstats_f);
+	COM_AddCommand("drawbench", Command_Drawbench_f);
+	COM_AddCommand("renderlimits", Command_Renderlimits_f);
 
 	COM_AddCommand("changeteam", Command_Teamchange_f);
 	COM_AddCommand("changeteam2", Command_Teamchange2_f);
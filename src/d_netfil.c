@@ -727,17 +727,14 @@ filestatus_t checkfilemd5(char *filename, const unsigned char *wantedmd5sum)
 	(void)wantedmd5sum;
 	(void)filename;
 #else
-	FILE *fhandle;
 	unsigned char md5sum[16];
 
 	if (!wantedmd5sum)
 		return FS_FOUND;
 
-	fhandle = fopen(filename, "rb");
-	if (fhandle)
+	// usually answered from the digest cache without reading the file
+	if (W_MakeFileMD5(filename, md5sum) == 0)
 	{
-		md5_stream(fhandle,md5sum);
-		fclose(fhandle);
 		if (!memcmp(wantedmd5sum, md5sum, 16))
 			return FS_FOUND;
 		return FS_MD5SUMBAD;
@@ -52,6 +52,10 @@ typedef struct thinker_s
 	struct thinker_s *next;
 	think_t function;
 
+	// Neighbours in the list of thinkers of the same class
+	struct thinker_s *cprev;
+	struct thinker_s *cnext;
+
 	// killough 11/98: count of how many other objects reference
 	// this one using pointers. Used for garbage collection.
 	int references;
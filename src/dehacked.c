@@ -1472,6 +1472,21 @@ static actionpointer_t actionpointers[] =
 	{{NULL},                   NULL},
 };
 
+/** Finds the name of an action, for reports.
+  *
+  * \param action The action function.
+  * \return Its name in ALL CAPS, or NULL if it isn't a known action.
+  */
+const char *DEH_ActionName(actionf_p1 action)
+{
+	size_t z;
+
+	for (z = 0; actionpointers[z].name; z++)
+		if (actionpointers[z].action.acp1 == action)
+			return actionpointers[z].name;
+	return NULL;
+}
+
 static void readframe(MYFILE *f, int num)
 {
 	XBOXSTATIC char s[MAXLINELEN];
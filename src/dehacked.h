@@ -19,6 +19,8 @@
 #ifndef __DEHACKED_H__
 #define __DEHACKED_H__
 
+#include "d_think.h"
+
 typedef enum
 {
 	UNDO_NONE    = 0x00,
@@ -37,6 +39,8 @@ void DEH_UnloadDehackedWad(USHORT wad);
 void DEH_LoadDehackedLump(lumpnum_t lumpnum);
 void DEH_LoadDehackedLumpPwad(USHORT wad, USHORT lump);
 
+const char *DEH_ActionName(actionf_p1 action);
+
 extern boolean deh_loaded, modcredits;
 
 #define MAXLINELEN 1024
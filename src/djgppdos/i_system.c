@@ -28,6 +28,7 @@
 #include <io.h>
 #include <stdarg.h>
 #include <sys/time.h>
+#include <time.h> // uclock
 #include <fcntl.h>
 
 #ifdef DJGPP
@@ -323,6 +324,18 @@ tic_t I_GetTime (void)
 	return ticcount;
 }
 
+//
+// I_GetTimeMicros
+// uclock counts at 1193180 Hz, from the first time it is called
+//
+UINT64 I_GetTimeMicros(void)
+{
+	UINT64 now = (UINT64)uclock();
+
+	return now / UCLOCKS_PER_SEC * 1000000
+		+ now % UCLOCKS_PER_SEC * 1000000 / UCLOCKS_PER_SEC;
+}
+
 
 void I_Sleep(void)
 {
@@ -298,6 +298,10 @@ ULONG glpolycount;
 
 
 #define NEWCLIP // FINALLY some real clipping that doesn't make walls dissappear AND speeds the game up
+// Finer grid than the blockmap for thing to thing collisions. Things get
+// touched in a different order with it, so its demos and netgames don't
+// mix with those of normal builds (see DEMOVERSION and SUBVERSION).
+//#define THINGGRID
 //#define PAPERMARIO
 #ifdef ESLOPE
 #define VPHYSICS // Full vector based sonic like physics!
@@ -107,6 +107,11 @@ int I_GetKey(void)
 
 void I_StartupTimer(void){}
 
+UINT64 I_GetTimeMicros(void)
+{
+	return 0;
+}
+
 void I_AddExitFunc(void (*func)())
 {
 	(void)func;
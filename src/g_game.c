@@ -261,6 +261,15 @@ static char demoname[32];
 boolean demorecording;
 boolean demoplayback;
 static byte *demobuffer = NULL;
+
+// First byte of a demo. THINGGRID builds touch things in another order,
+// so their demos only play back on each other.
+#define THINGGRIDDEMOVERSION 255
+#ifdef THINGGRID
+#define DEMOVERSION THINGGRIDDEMOVERSION
+#else
+#define DEMOVERSION VERSION
+#endif
 static byte *demo_p;
 static byte *demoend;
 boolean singledemo; // quit after playing a demo from cmdline
@@ -1584,6 +1593,15 @@ boolean G_Responder(event_t *ev)
 // G_Ticker
 // Make ticcmd_ts for the players.
 //
+// Simulation benchmark, see G_StartSimBench
+static boolean simbench = false;
+static int simbenchbots;
+static tic_t simbenchtics, simbenchtic;
+static UINT64 simbenchstart, simbenchtickermicros;
+static size_t simbenchloaded, simbenchpeak;
+
+static void G_SimBenchTicker(void);
+
 void G_Ticker(void)
 {
 	ULONG i;
@@ -1656,7 +1674,10 @@ dontcompleteyet:
 	switch (gamestate)
 	{
 		case GS_LEVEL:
-			P_Ticker(); // tic the game
+			if (simbench)
+				G_SimBenchTicker();
+			else
+				P_Ticker(); // tic the game
 			ST_Ticker();
 			AM_Ticker();
 			HU_Ticker();
@@ -3161,7 +3182,7 @@ void G_BeginRecording(void)
 
 	demo_p = demobuffer;
 
-	WRITEBYTE(demo_p,VERSION);
+	WRITEBYTE(demo_p,DEMOVERSION);
 	WRITEBYTE(demo_p,ultimatemode);
 	WRITEBYTE(demo_p,gamemap);
 	WRITEBYTE(demo_p,gametype);
@@ -3219,7 +3240,18 @@ void G_DoPlayDemo(char *defdemoname)
 
 	// read demo header
 	gameaction = ga_nothing;
-	(void)READBYTE(demo_p); // ultmode
+#ifdef THINGGRID
+	if (READBYTE(demo_p) != THINGGRIDDEMOVERSION)
+#else
+	if (READBYTE(demo_p) == THINGGRIDDEMOVERSION)
+#endif
+	{
+		CONS_Printf("\2ERROR: demo '%s' needs a build %s THINGGRID.\n", defdemoname,
+			DEMOVERSION == THINGGRIDDEMOVERSION ? "without" : "with");
+		Z_Free(demobuffer);
+		demobuffer = NULL;
+		return;
+	}
 	map = READBYTE(demo_p);
 
 	(void)READBYTE(demo_p);
@@ -3303,6 +3335,136 @@ void G_DoneLevelLoad(void)
 	demostarttime = I_GetTime();
 }
 
+//
+// SIMULATION BENCHMARK
+//
+// Runs the first level started for a fixed number of tics, as fast as
+// possible and without drawing, then reports how long the game logic
+// took and quits. The console player follows a fixed script and never
+// runs out of lives; with JTEBOTS, bots are added to follow them.
+//
+
+/**	\brief	Arms the benchmark, call before the level starts
+
+	\param	bots	bots to add when the level starts
+	\param	tics	tics of P_Ticker to time
+*/
+void G_StartSimBench(int bots, tic_t tics)
+{
+	simbench = true;
+	simbenchbots = bots;
+	simbenchtics = tics ? tics : 1;
+	simbenchtic = 0;
+
+	nodrawers = noblit = true;
+	singletics = true;
+	if (cv_vidwait.value)
+		CV_Set(&cv_vidwait, "0");
+}
+
+static void G_SimBenchAddPlayers(void)
+{
+#ifdef JTEBOTS
+	char name[MAXPLAYERNAME+1];
+	int i, skin;
+
+	for (i = 0; i < simbenchbots; i++)
+	{
+		skin = (players[consoleplayer].skin + i + 1) % numskins;
+		snprintf(name, sizeof (name), "%s-bot%d", skins[skin].name, i + 1);
+		if (!JB_BotAdd((byte)skin, consoleplayer, (byte)atoi(skins[skin].prefcolor), name))
+		{
+			CONS_Printf("Only room for %d bots\n", i);
+			break;
+		}
+	}
+#else
+	if (simbenchbots)
+		CONS_Printf("Bots need JTEBOTS, benchmarking without them\n");
+#endif
+}
+
+// Run forward, changing direction every three seconds and jumping
+// every two, so the player covers ground and sets things off.
+static void G_SimBenchCmd(player_t *player)
+{
+	ticcmd_t *cmd = &player->cmd;
+	const tic_t t = simbenchtic;
+
+	cmd->forwardmove = 50;
+	cmd->sidemove = 0;
+	cmd->angleturn = (short)((((t / (3*TICRATE)) * 7 % 8) * ANG45) >> 16) | TICCMD_RECEIVED;
+	cmd->aiming = 0;
+	cmd->buttons = (t % (2*TICRATE)) < TICRATE/3 ? BT_JUMP : 0;
+
+	player->lives = 9;
+}
+
+static void G_SimBenchReport(void)
+{
+	const char *phasenames[NUMTICKPHASES] = {"Players", "Thinkers", "After think",
+		"P_UpdateSpecials", "P_RespawnSpecials", "Other"};
+	const double wall = (double)(I_GetTimeMicros() - simbenchstart) / 1000000.0;
+	const double ticker = (double)simbenchtickermicros / 1000000.0;
+	thinker_t *th;
+	size_t things = 0;
+	int i;
+
+	for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
+		things++;
+
+	CONS_Printf("Simulated %u tics of MAP%02d with %d players, %"PRIdS" things at the end\n",
+		(unsigned int)simbenchtic, gamemap, D_NumPlayers(), things);
+	CONS_Printf("P_Ticker: %.3f sec, %.1f tics/sec\n", ticker, ticker > 0.0 ? simbenchtic / ticker : 0.0);
+	CONS_Printf("Overall:  %.3f sec, %.1f tics/sec\n", wall, wall > 0.0 ? simbenchtic / wall : 0.0);
+	for (i = 0; i < NUMTICKPHASES; i++)
+		CONS_Printf("  %-18s %9.1f us/tic %5.1f%%\n", phasenames[i],
+			(double)tickphasemicros[i] / simbenchtic,
+			simbenchtickermicros ? (double)tickphasemicros[i] * 100.0 / simbenchtickermicros : 0.0);
+	CONS_Printf("Zone memory: %"PRIdS" KB after loading, %"PRIdS" KB peak\n",
+		simbenchloaded>>10, simbenchpeak>>10);
+}
+
+// Takes the place of P_Ticker while benchmarking
+static void G_SimBenchTicker(void)
+{
+	UINT64 start;
+	size_t usage;
+	int i;
+
+	if (!simbenchtic)
+	{
+		// first tic of the level; bots spawn on the next G_Ticker
+		G_SimBenchAddPlayers();
+		memset(tickphasemicros, 0, sizeof (tickphasemicros));
+		tickphasetiming = true;
+		simbenchloaded = simbenchpeak = Z_TotalUsage();
+		simbenchstart = I_GetTimeMicros();
+	}
+
+	for (i = 0; i < MAXPLAYERS; i++)
+		if (playeringame[i]
+#ifdef JTEBOTS
+			&& !players[i].bot
+#endif
+			)
+			G_SimBenchCmd(&players[i]);
+
+	start = I_GetTimeMicros();
+	P_Ticker();
+	simbenchtickermicros += I_GetTimeMicros() - start;
+
+	usage = Z_TotalUsage();
+	if (usage > simbenchpeak)
+		simbenchpeak = usage;
+
+	if (++simbenchtic >= simbenchtics)
+	{
+		G_SimBenchReport();
+		I_Quit();
+	}
+}
+
 /*
 ===================
 =
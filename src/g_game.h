@@ -119,6 +119,7 @@ void G_DoPlayDemo(char *defdemoname);
 void G_TimeDemo(const char *name);
 void G_MovieMode(boolean enable);
 void G_DoneLevelLoad(void);
+void G_StartSimBench(int bots, tic_t tics);
 void G_StopDemo(void);
 boolean G_CheckDemoStatus(void);
 
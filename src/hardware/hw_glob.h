@@ -82,6 +82,7 @@ typedef struct gr_vissprite_s
 	boolean precip;
 	boolean vflip;
 	byte *colormap;
+	int frame; // sprite frame and FF_ flags, for precipitation
 
 	// SRB2CBTODO: sprite cutting
 	short sz, szt;
@@ -65,7 +65,7 @@ boolean hw_doorclosed;
 // SRB2CBTODO: Just place this in the right order!
 static void HWR_AddSprites(sector_t *sec);
 static void HWR_ProjectSprite(mobj_t *thing);
-static void HWR_ProjectPrecipitationSprite(precipmobj_t *thing);
+static void HWR_ProjectPrecipitation(sector_t *sec);
 
 static void HWR_AddTransparentFloor(const sector_t *sector, lumpnum_t lumpnum, extrasubsector_t *xsub,	fixed_t fixedheight,
                              byte lightlevel, byte alpha, sector_t *FOFSector, FBITFIELD blendmode, extracolormap_t *planecolormap);
@@ -3876,8 +3876,12 @@ void HWR_InitTextureMapping(void) // SRB2CBTODO: USE same thing as software does
 // sprites are drawn after all wall and planes are rendered, so that
 // sprite translucency effects apply on the rendered view (instead of the background sky!!)
 
-static gr_vissprite_t gr_vissprites[MAXVISSPRITES];
-static gr_vissprite_t *gr_vissprite_p;
+// Same as the software renderer: chunks that stay put and are reused
+// every frame, so there is no limit and handed out sprites never move
+#define GR_VISSPRITE(i) ((gr_vissprite_t *)R_ChunkElem(&gr_visspritechunks, i))
+
+renderusage_t grvisspriteusage = {"gr_vissprites", 0, 0, 0};
+static renderchunks_t gr_visspritechunks = {"gr_vissprites", sizeof (gr_vissprite_t), &grvisspriteusage, NULL, 0, 0};
 
 // --------------------------------------------------------------------------
 // HWR_ClearSprites
@@ -3885,21 +3889,15 @@ static gr_vissprite_t *gr_vissprite_p;
 // --------------------------------------------------------------------------
 static void HWR_ClearSprites(void)
 {
-	gr_vissprite_p = gr_vissprites;
+	R_ClearChunkArray(&gr_visspritechunks);
 }
 
 // --------------------------------------------------------------------------
 // HWR_NewVisSprite
 // --------------------------------------------------------------------------
-static gr_vissprite_t gr_overflowsprite;
-
 static gr_vissprite_t *HWR_NewVisSprite(void)
 {
-	if (gr_vissprite_p == &gr_vissprites[MAXVISSPRITES])
-		return &gr_overflowsprite;
-
-	gr_vissprite_p++;
-	return gr_vissprite_p-1;
+	return R_NewChunkElem(&gr_visspritechunks);
 }
 
 
@@ -5412,10 +5410,7 @@ static void HWR_DrawPrecipitationSprite(gr_vissprite_t *spr)
 	GLPatch_t *gpatch; // sprite patch converted to hardware
 	FSurfaceInfo Surf;
 
-	if (!spr->mobj)
-		return;
-
-	if (!spr->mobj->subsector)
+	if (!spr->sector)
 		return;
 
 	// cache sprite graphics
@@ -5456,7 +5451,7 @@ static void HWR_DrawPrecipitationSprite(gr_vissprite_t *spr)
 
 	// Perform colormapping and shading by proper sector lightlist
 	sector_t *sector;
-	sector = spr->mobj->subsector->sector;
+	sector = spr->sector;
 	int lightnum;
 	extracolormap_t *colormap;
 	lightnum = sector->lightlevel;
@@ -5468,12 +5463,12 @@ static void HWR_DrawPrecipitationSprite(gr_vissprite_t *spr)
 	{
 		for (l = 1; l < sector->numlights; l++)
 		{
-			if (sector->lightlist[l].height <= (spr->mobj->z + spr->mobj->height))
+			if (sector->lightlist[l].height <= spr->pzt)
 				continue;
 
-			if (!((spr->mobj->frame & (FF_FULLBRIGHT|FF_TRANSMASK))
-				  && (!(spr->mobj->subsector->sector->extra_colormap
-						&& spr->mobj->subsector->sector->extra_colormap->fog))))
+			if (!((spr->frame & (FF_FULLBRIGHT|FF_TRANSMASK))
+				  && (!(sector->extra_colormap
+						&& sector->extra_colormap->fog))))
 				lightnum = *sector->lightlist[l].lightlevel;
 			else
 				lightnum = 255;
@@ -5483,9 +5478,9 @@ static void HWR_DrawPrecipitationSprite(gr_vissprite_t *spr)
 	}
 	else
 	{
-		if (!((spr->mobj->frame & (FF_FULLBRIGHT|FF_TRANSMASK))
-			  && (!(spr->mobj->subsector->sector->extra_colormap
-					&& spr->mobj->subsector->sector->extra_colormap->fog))))
+		if (!((spr->frame & (FF_FULLBRIGHT|FF_TRANSMASK))
+			  && (!(sector->extra_colormap
+					&& sector->extra_colormap->fog))))
 			lightnum = sector->lightlevel;
 		else
 			lightnum = 255;
@@ -5493,7 +5488,7 @@ static void HWR_DrawPrecipitationSprite(gr_vissprite_t *spr)
 		colormap = sector->extra_colormap;
 	}
 
-	if (spr->mobj->frame & (FF_FULLBRIGHT))
+	if (spr->frame & (FF_FULLBRIGHT))
 		lightnum = 255;
 
 	if (colormap)
@@ -5502,7 +5497,7 @@ static void HWR_DrawPrecipitationSprite(gr_vissprite_t *spr)
 		Surf.FlatColor.rgba = HWR_Lighting(LightLevelToLum(lightnum), NORMALFOG, false, false);
 
 
-	blendmode = HWR_TranstableToAlpha((spr->mobj->frame & FF_TRANSMASK)>>FF_TRANSSHIFT, &Surf);
+	blendmode = HWR_TranstableToAlpha((spr->frame & FF_TRANSMASK)>>FF_TRANSSHIFT, &Surf);
 
 	// Make sure to define the alpha level
 	Surf.FlatColor.s.alpha = 255;
@@ -5523,23 +5518,22 @@ static void HWR_SortVisSprites(void)
 	gr_vissprite_t unsorted;
 	float bestdist;
 
-	count = gr_vissprite_p - gr_vissprites;
+	count = gr_visspritechunks.count;
 
 	unsorted.next = unsorted.prev = &unsorted;
 
 	if (!count)
 		return;
 
-	for (ds = gr_vissprites; ds < gr_vissprite_p; ds++)
+	for (i = 0; i < count; i++)
 	{
-		ds->next = ds+1;
-		ds->prev = ds-1;
+		ds = GR_VISSPRITE(i);
+		ds->next = i+1 < count ? GR_VISSPRITE(i+1) : &unsorted;
+		ds->prev = i ? GR_VISSPRITE(i-1) : &unsorted;
 	}
 
-	gr_vissprites[0].prev = &unsorted;
-	unsorted.next = &gr_vissprites[0];
-	(gr_vissprite_p-1)->next = &unsorted;
-	unsorted.prev = gr_vissprite_p-1;
+	unsorted.next = GR_VISSPRITE(0);
+	unsorted.prev = GR_VISSPRITE(count-1);
 
 	// Pull the vissprites out by scale
 	gr_vsprsortedhead.next = gr_vsprsortedhead.prev = &gr_vsprsortedhead;
@@ -5868,23 +5862,23 @@ static void HWR_CreateDrawNodes(void) // SRB2CBTODO: This is really OpenGL's R_D
 
 	gr_drawnode_t *sortnode = memset(malloc((sizeof(transplaneinfo_t)*numtransplanes) + (sizeof(transwallinfo_t)*numtranswalls)
 #ifdef SORTING
-											+ (sizeof(gr_vissprite_t)*(gr_vissprite_p - gr_vissprites))
+											+ (sizeof(gr_vissprite_t)*gr_visspritechunks.count)
 #endif
 											),
 									 0, (sizeof(transplaneinfo_t)*numtransplanes) + (sizeof(transwallinfo_t)*numtranswalls)
 #ifdef SORTING
-									 + (sizeof(gr_vissprite_t)*(gr_vissprite_p - gr_vissprites))
+									 + (sizeof(gr_vissprite_t)*gr_visspritechunks.count)
 #endif
 									 );
 
 	size_t *sortindex = memset(malloc(sizeof(size_t) * (numtransplanes + numtranswalls
 #ifdef SORTING
-														+ (gr_vissprite_p - gr_vissprites)
+														+ gr_visspritechunks.count
 #endif
 														)),
 							   0, sizeof(size_t) * (numtransplanes + numtranswalls
 #ifdef SORTING
-													+ (gr_vissprite_p - gr_vissprites)
+													+ gr_visspritechunks.count
 #endif
 													));
 
@@ -5901,7 +5895,7 @@ static void HWR_CreateDrawNodes(void) // SRB2CBTODO: This is really OpenGL's R_D
 	}
 
 #ifdef SORTING
-	if (gr_vissprite_p > gr_vissprites)
+	if (gr_visspritechunks.count)
 	{
 		gr_vissprite_t *spr;
 
@@ -6086,7 +6080,7 @@ static void HWR_CreateDrawNodes(void) // SRB2CBTODO: This is really OpenGL's R_D
 #ifndef SORTING
 static void HWR_DrawSprites(void)
 {
-	if (gr_vissprite_p > gr_vissprites)
+	if (gr_visspritechunks.count)
 	{
 		gr_vissprite_t *spr;
 
@@ -6113,7 +6107,7 @@ static void HWR_DrawMD2s(void)
 	if (!cv_grmd2.value)
 		return;
 
-	if (gr_vissprite_p > gr_vissprites)
+	if (gr_visspritechunks.count)
 	{
 		gr_vissprite_t *spr;
 
@@ -6148,8 +6142,6 @@ static void HWR_DrawMD2s(void)
 static void HWR_AddSprites(sector_t *sec)
 {
 	mobj_t *thing;
-	precipmobj_t *precipthing;
-	fixed_t adx, ady, approx_dist;
 
 	if (sec->validcount == validcount)
 		return;
@@ -6174,38 +6166,8 @@ static void HWR_AddSprites(sector_t *sec)
 				break;
 		}
 
-	if (playeringame[displayplayer] && players[displayplayer].mo) // ZTODO: Make a more efficient non-mobj weather system
-	{
-		for (precipthing = sec->preciplist; precipthing; precipthing = precipthing->snext)
-		{
-			if (!precipthing)
-				continue;
-
-			if (precipthing->invisible)
-				continue;
-
-			adx = abs(players[displayplayer].mo->x - precipthing->x);
-			ady = abs(players[displayplayer].mo->y - precipthing->y);
-
-			// From _GG1_ p.428. Approx. eucledian distance fast.
-			approx_dist = adx + ady - ((adx < ady ? adx : ady)>>1);
-
-			// Only draw the precipitation oh-so-far from the player.
-			if (approx_dist < (2320 << FRACBITS))
-				HWR_ProjectPrecipitationSprite(precipthing);
-			else if ((splitscreen && rendersplit) && players[secondarydisplayplayer].mo)
-			{
-				adx = abs(players[secondarydisplayplayer].mo->x - precipthing->x);
-				ady = abs(players[secondarydisplayplayer].mo->y - precipthing->y);
-
-				// From _GG1_ p.428. Approx. eucledian distance fast.
-				approx_dist = adx + ady - ((adx < ady ? adx : ady)>>1);
-
-				if (approx_dist < (2320 << FRACBITS))
-					HWR_ProjectPrecipitationSprite(precipthing);
-			}
-		}
-	}
+	if (playeringame[displayplayer] && players[displayplayer].mo)
+		HWR_ProjectPrecipitation(sec);
 }
 
 // --------------------------------------------------------------------------
@@ -6508,8 +6470,9 @@ static void HWR_ProjectSprite(mobj_t *thing) // SRB2CBTODO: MD2's projectsprite
 
 // Precipitation projector for hardware mode
 // Lighting, colormapping, and translucency handled in actually drawing the sprite
-static void HWR_ProjectPrecipitationSprite(precipmobj_t *thing)
+static void HWR_ProjectPrecipitationSprite(sector_t *sector, size_t drop)
 {
+	const state_t *st = &states[precipdrops.state[drop]];
 	gr_vissprite_t *vis;
 	float tr_x, tr_y;
 	float tx, tz;
@@ -6521,8 +6484,8 @@ static void HWR_ProjectPrecipitationSprite(precipmobj_t *thing)
 	byte flip;
 
 	// Transform the origin point
-	tr_x = FIXED_TO_FLOAT(thing->x) - gr_viewx;
-	tr_y = FIXED_TO_FLOAT(thing->y) - gr_viewy;
+	tr_x = FIXED_TO_FLOAT(precipdrops.x[drop]) - gr_viewx;
+	tr_y = FIXED_TO_FLOAT(precipdrops.y[drop]) - gr_viewy;
 
 	// Rotation around vertical axis
 	tz = (tr_x * gr_viewcos) + (tr_y * gr_viewsin);
@@ -6534,25 +6497,25 @@ static void HWR_ProjectPrecipitationSprite(precipmobj_t *thing)
 	tx = (tr_x * gr_viewsin) - (tr_y * gr_viewcos);
 
 	// Decide which patch to use for sprite relative to player
-	if ((unsigned int)thing->sprite >= numsprites)
+	if ((unsigned int)st->sprite >= numsprites)
 #ifdef RANGECHECK
 		I_Error("HWR_ProjectSprite: invalid sprite number %i ",
-		        thing->sprite);
+		        st->sprite);
 #else
 		return;
 #endif
 
-	sprdef = &sprites[thing->sprite];
+	sprdef = &sprites[st->sprite];
 
-	if ((byte)(thing->frame&FF_FRAMEMASK) >= sprdef->numframes)
+	if ((byte)(st->frame&FF_FRAMEMASK) >= sprdef->numframes)
 #ifdef RANGECHECK
 		I_Error("HWR_ProjectSprite: invalid sprite frame %i : %i for %s",
-		        thing->sprite, thing->frame, sprnames[thing->sprite]);
+		        st->sprite, st->frame, sprnames[st->sprite]);
 #else
 		return;
 #endif
 
-	sprframe = &sprdef->spriteframes[ thing->frame & FF_FRAMEMASK];
+	sprframe = &sprdef->spriteframes[ st->frame & FF_FRAMEMASK];
 
 	// use single rotation for all views
 	lumpnum = sprframe->lumpid[0];
@@ -6574,16 +6537,58 @@ static void HWR_ProjectPrecipitationSprite(precipmobj_t *thing)
 	vis->tz = tz;
 	vis->patchlumpnum = sprframe->lumppat[rot];
 	vis->flip = flip;
-	vis->mobj = (mobj_t *)thing;
+	vis->mobj = NULL;
+	vis->sector = sector;
+	vis->frame = st->frame;
 
 	vis->colormap = colormaps;
 
 	// set top/bottom coords
-	vis->ty = FIXED_TO_FLOAT(thing->z + spritecachedinfo[lumpnum].topoffset) - gr_viewz;
+	vis->ty = FIXED_TO_FLOAT(precipdrops.z[drop] + spritecachedinfo[lumpnum].topoffset) - gr_viewz;
+	vis->pz = precipdrops.z[drop];
+	vis->thingheight = 4*FRACUNIT;
+	vis->pzt = vis->pz + vis->thingheight;
 
 	vis->precip = true;
 }
 
+// Projects every drop in a sector near enough to the player to be seen
+static void HWR_ProjectPrecipitation(sector_t *sec)
+{
+	const mobj_t *mo = players[displayplayer].mo;
+	const mobj_t *mo2 = (splitscreen && rendersplit) ? players[secondarydisplayplayer].mo : NULL;
+	const size_t end = sec->firstprecip + sec->numprecip;
+	fixed_t adx, ady, approx_dist;
+	size_t i;
+
+	if (!sec->numprecip || !precipdrops.block || precipdrops.hidden)
+		return;
+
+	for (i = sec->firstprecip; i < end; i++)
+	{
+		adx = abs(mo->x - precipdrops.x[i]);
+		ady = abs(mo->y - precipdrops.y[i]);
+
+		// From _GG1_ p.428. Approx. eucledian distance fast.
+		approx_dist = adx + ady - ((adx < ady ? adx : ady)>>1);
+
+		// Only draw the precipitation oh-so-far from the player.
+		if (approx_dist < (2320 << FRACBITS))
+			HWR_ProjectPrecipitationSprite(sec, i);
+		else if (mo2)
+		{
+			adx = abs(mo2->x - precipdrops.x[i]);
+			ady = abs(mo2->y - precipdrops.y[i]);
+
+			// From _GG1_ p.428. Approx. eucledian distance fast.
+			approx_dist = adx + ady - ((adx < ady ? adx : ady)>>1);
+
+			if (approx_dist < (2320 << FRACBITS))
+				HWR_ProjectPrecipitationSprite(sec, i);
+		}
+	}
+}
+
 // ==========================================================================
 //
 // ==========================================================================
@@ -217,6 +217,12 @@ void I_StartupConsole(void);
 */
 void I_StartupTimer(void);
 
+/**	\brief	Microseconds from some arbitrary start, for profiling
+
+	\return	the time, as precisely as the system allows
+*/
+UINT64 I_GetTimeMicros(void);
+
 /**	\brief sample quit function
 */
 typedef void (*quitfuncptr)();
@@ -0,0 +1,200 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// Copyright (C) 1998-2000 by DooM Legacy Team.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//-----------------------------------------------------------------------------
+/// \file
+/// \brief Worker threads for background jobs
+///
+///	Jobs are taken from a single queue in the order they were added.
+///	A thread waiting on a job that no worker has started yet takes it
+///	off the queue and runs it itself, so waiting never costs more than
+///	doing the work directly.
+
+#include "doomdef.h"
+#include "i_threads.h"
+#include "i_system.h"
+#include "m_argv.h"
+
+#ifdef HAVE_THREADS
+#include <pthread.h>
+#include <unistd.h>
+
+#define MAXWORKERS 16
+
+static pthread_t workers[MAXWORKERS];
+static INT32 numworkers = 0;
+
+static pthread_mutex_t jobmutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t jobqueued = PTHREAD_COND_INITIALIZER; // a job was added, or shutting down
+static pthread_cond_t jobfinished = PTHREAD_COND_INITIALIZER; // some job is done
+static job_t *jobhead = NULL, *jobtail = NULL;
+static boolean stopworkers = false;
+
+// Call with jobmutex held
+static void I_UnqueueJob(job_t *job)
+{
+	if (job->prev)
+		job->prev->next = job->next;
+	else
+		jobhead = job->next;
+	if (job->next)
+		job->next->prev = job->prev;
+	else
+		jobtail = job->prev;
+	job->prev = job->next = NULL;
+}
+
+// Call with jobmutex held
+static void I_RunJob(job_t *job)
+{
+	job->taken = true;
+	pthread_mutex_unlock(&jobmutex);
+	job->func(job->data);
+	pthread_mutex_lock(&jobmutex);
+	job->done = true;
+	pthread_cond_broadcast(&jobfinished);
+}
+
+static void *I_WorkerThread(void *unused)
+{
+	job_t *job;
+
+	(void)unused;
+	pthread_mutex_lock(&jobmutex);
+	for (;;)
+	{
+		while (!jobhead && !stopworkers)
+			pthread_cond_wait(&jobqueued, &jobmutex);
+		if (!jobhead) // stopping, and nothing left to do
+			break;
+
+		job = jobhead;
+		I_UnqueueJob(job);
+		I_RunJob(job);
+	}
+	pthread_mutex_unlock(&jobmutex);
+	return NULL;
+}
+#endif
+
+void I_InitThreads(void)
+{
+#ifdef HAVE_THREADS
+	INT32 wanted = 0;
+	long cpus;
+
+	if (numworkers)
+		return;
+
+	if (M_CheckParm("-threads") && M_IsNextParm())
+		wanted = atoi(M_GetNextParm());
+	else
+	{
+		cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		wanted = cpus > 1 ? (INT32)cpus - 1 : 0;
+	}
+
+	if (wanted > MAXWORKERS)
+		wanted = MAXWORKERS;
+
+	stopworkers = false;
+	for (numworkers = 0; numworkers < wanted; numworkers++)
+		if (pthread_create(&workers[numworkers], NULL, I_WorkerThread, NULL) != 0)
+			break;
+
+	if (numworkers)
+	{
+		// joined by I_ShutdownSystem, before anything they use goes away
+		I_AddExitFunc(I_ShutdownThreads);
+		CONS_Printf("I_InitThreads: %d worker thread%s\n", numworkers, numworkers > 1 ? "s" : "");
+	}
+#endif
+}
+
+void I_ShutdownThreads(void)
+{
+#ifdef HAVE_THREADS
+	INT32 i;
+
+	if (!numworkers)
+		return;
+
+	pthread_mutex_lock(&jobmutex);
+	stopworkers = true;
+	pthread_cond_broadcast(&jobqueued);
+	pthread_mutex_unlock(&jobmutex);
+
+	for (i = 0; i < numworkers; i++)
+		pthread_join(workers[i], NULL);
+	numworkers = 0;
+#endif
+}
+
+INT32 I_NumWorkers(void)
+{
+#ifdef HAVE_THREADS
+	return numworkers;
+#else
+	return 0;
+#endif
+}
+
+void I_QueueJob(job_t *job)
+{
+	job->taken = job->done = false;
+	job->prev = job->next = NULL;
+
+#ifdef HAVE_THREADS
+	if (numworkers)
+	{
+		pthread_mutex_lock(&jobmutex);
+		job->prev = jobtail;
+		if (jobtail)
+			jobtail->next = job;
+		else
+			jobhead = job;
+		jobtail = job;
+		pthread_cond_signal(&jobqueued);
+		pthread_mutex_unlock(&jobmutex);
+		return;
+	}
+#endif
+
+	job->taken = true;
+	job->func(job->data);
+	job->done = true;
+}
+
+void I_WaitJob(job_t *job)
+{
+#ifdef HAVE_THREADS
+	// done is only ever read under jobmutex, which also makes whatever
+	// the worker wrote visible here. A job run right there in I_QueueJob
+	// is already done and falls straight through.
+	pthread_mutex_lock(&jobmutex);
+
+	// not started yet? then do it here instead of waiting for a worker
+	if (!job->taken)
+	{
+		I_UnqueueJob(job);
+		I_RunJob(job);
+	}
+
+	while (!job->done)
+		pthread_cond_wait(&jobfinished, &jobmutex);
+	pthread_mutex_unlock(&jobmutex);
+#else
+	(void)job; // always run right there in I_QueueJob
+#endif
+}
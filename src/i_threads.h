@@ -0,0 +1,71 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// Copyright (C) 1998-2000 by DooM Legacy Team.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//-----------------------------------------------------------------------------
+/// \file
+/// \brief Worker threads for background jobs
+
+#ifndef __I_THREADS__
+#define __I_THREADS__
+
+#include "doomtype.h"
+
+// POSIX threads are used where they are known to exist,
+// everywhere else jobs run on the main thread when they are queued
+#if defined (UNIXLIKE) && !defined (NOTHREADS)
+#define HAVE_THREADS
+#endif
+
+/**	\brief	A unit of work for the worker threads
+
+	The job belongs to whoever queued it and must stay valid until it is done.
+	Jobs must not touch the zone, the console or anything else that isn't
+	thread safe; errors are passed back to the main thread through data.
+*/
+typedef struct job_s
+{
+	void (*func)(void *data);
+	void *data;
+	boolean taken; // a thread has started it
+	boolean done; // only looked at under the job lock
+	struct job_s *prev, *next;
+} job_t;
+
+/**	\brief	Starts the worker threads, one less than the number of processors
+	unless -threads \<num\> says otherwise. -threads 0 runs every job on the
+	main thread.
+*/
+void I_InitThreads(void);
+
+/**	\brief	Stops the worker threads once all queued jobs are done
+*/
+void I_ShutdownThreads(void);
+
+/**	\brief	Number of worker threads, 0 if jobs run on the main thread
+*/
+INT32 I_NumWorkers(void);
+
+/**	\brief	Adds a job to the end of the queue
+
+	\param	job	the job to run, with func and data set
+*/
+void I_QueueJob(job_t *job);
+
+/**	\brief	Blocks until a queued job has finished
+
+	\param	job	a job given to I_QueueJob
+*/
+void I_WaitJob(job_t *job);
+
+#endif
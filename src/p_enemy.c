@@ -2099,7 +2099,7 @@ void A_BossDeath(mobj_t *mo)
 
 	// scan the remaining thinkers to see
 	// if all bosses are dead
-	for (th = thinkercap.next; th != &thinkercap; th = th->next)
+	for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 	{
 		if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 			continue;
@@ -2135,7 +2135,7 @@ void A_BossDeath(mobj_t *mo)
 
 		// Flee! Flee! Find a point to escape to! If none, just shoot upward!
 		// scan the thinkers to find the runaway point
-		for (th = thinkercap.next; th != &thinkercap; th = th->next)
+		for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 		{
 			if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 				continue;
@@ -4273,59 +4273,48 @@ void A_CrawlaCommanderThink(mobj_t *actor)
 // var1 = unused
 // var2 = unused
 //
-void A_RingExplode(mobj_t *actor)
+static boolean PIT_RingExplode(mobj_t *mo2, mobj_t *actor)
 {
-	mobj_t *mo2;
-	thinker_t *th;
-	int d;
-
-	// NOTE: This code would be very CPU-intense if it was much higher
-	for (d = 0; d < 16; d++)
-		P_SpawnParaloop(actor->x, actor->y, actor->z + actor->height, actor->info->painchance, 16, MT_NIGHTSPARKLE, d*(ANGLE_45/2), true, false);
+	// SRB2CBTODO: Bombs can repel you in the game, so you can use your own bombs to get around,
+	// requires lots of skill though, but very fun in the game
+	// SRB2CBTODO: Make bots smart enough to use this some day
 
-	S_StartSound(actor, sfx_prloop);
+	angle_t jumpangle;
 
-	for (th = thinkercap.next; th != &thinkercap; th = th->next)
-	{
-		if (th->function.acp1 != (actionf_p1)P_MobjThinker)
-			continue;
+	actor->flags2 |= MF2_DEBRIS;
 
-		mo2 = (mobj_t *)th;
+	// Repel away from the explosion
+	jumpangle = R_PointToAngle2(actor->x, actor->y, mo2->x, mo2->y);
 
-		if (mo2 == actor) // Don't explode yourself! Endless loop!
-			continue;
+	// Horizontal momentum
+	P_InstaThrust(mo2, jumpangle, 10*FRACUNIT);
 
-		if (P_AproxDistance(P_AproxDistance(mo2->x - actor->x, mo2->y - actor->y), mo2->z - actor->z) > actor->info->painchance)
-			continue;
+	mo2->momz += 9*FRACUNIT;
 
-		if (mo2->flags & MF_SHOOTABLE)
-		{
-			actor->flags2 |= MF2_DEBRIS;
+	/* LXShadow: ...
+	             So *this* is what broke the grenades! I'll bet the bombs were broken too. Fixed.*/
+	// Don't damage a player if he thew this bomb
+	if (!(actor->target && mo2->player && (mo2->player == actor->target->player) && actor->type == MT_THROWNEXPLOSION))
+		P_DamageMobj(mo2, actor, actor->target, 1);
 
-			// SRB2CBTODO: Bombs can repel you in the game, so you can use your own bombs to get around,
-			// requires lots of skill though, but very fun in the game
-			// SRB2CBTODO: Make bots smart enough to use this some day
-
-			angle_t jumpangle;
-
-			// Repel away from the explosion
-			jumpangle = R_PointToAngle2(actor->x, actor->y, mo2->x, mo2->y);
+	return true;
+}
 
-			// Horizontal momentum
-			P_InstaThrust(mo2, jumpangle, 10*FRACUNIT);
+void A_RingExplode(mobj_t *actor)
+{
+	thingsearch_t search;
+	int d;
 
-			mo2->momz += 9*FRACUNIT;
+	// NOTE: This code would be very CPU-intense if it was much higher
+	for (d = 0; d < 16; d++)
+		P_SpawnParaloop(actor->x, actor->y, actor->z + actor->height, actor->info->painchance, 16, MT_NIGHTSPARKLE, d*(ANGLE_45/2), true, false);
 
-            /* LXShadow: ...
-                         So *this* is what broke the grenades! I'll bet the bombs were broken too. Fixed.*/
-			// Don't damage a player if he thew this bomb
-			if (!(actor->target && mo2->player && (mo2->player == actor->target->player) && actor->type == MT_THROWNEXPLOSION))
-				P_DamageMobj(mo2, actor, actor->target, 1);
+	S_StartSound(actor, sfx_prloop);
 
-			continue;
-		}
-	}
-	return;
+	// Don't explode yourself! Endless loop!
+	P_InitThingSearch(&search, actor);
+	search.flags = MF_SHOOTABLE;
+	P_SearchThingsInRadius(&search, actor->info->painchance, PIT_RingExplode);
 }
 
 // Function: A_OldRingExplode
@@ -5653,7 +5642,7 @@ void A_FindTarget(mobj_t *actor)
 		CONS_Printf("A_FindTarget called from object type %d, var1: %d, var2: %d\n", actor->type, locvar1, locvar2);
 
 	// scan the thinkers
-	for (th = thinkercap.next; th != &thinkercap; th = th->next)
+	for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 	{
 		if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 			continue;
@@ -5713,7 +5702,7 @@ void A_FindTracer(mobj_t *actor)
 		CONS_Printf("A_FindTracer called from object type %d, var1: %d, var2: %d\n", actor->type, locvar1, locvar2);
 
 	// scan the thinkers
-	for (th = thinkercap.next; th != &thinkercap; th = th->next)
+	for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 	{
 		if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 			continue;
@@ -5959,7 +5948,7 @@ void A_SetTargetsTarget(mobj_t *actor)
 		return; // Don't search for nothing.
 
 	// scan the thinkers
-	for (th = thinkercap.next; th != &thinkercap; th = th->next)
+	for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 	{
 		if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 			continue;
@@ -6224,7 +6213,7 @@ void A_RemoteAction(mobj_t *actor)
 		fixed_t dist1 = 0, dist2 = 0;
 
 		// scan the thinkers
-		for (th = thinkercap.next; th != &thinkercap; th = th->next)
+		for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 		{
 			if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 				continue;
@@ -1877,7 +1877,7 @@ void T_ThwompSector(levelspecthink_t *thwomp)
 		mobj_t *mo;
 
 		// scan the thinkers to find players!
-		for (th = thinkercap.next; th != &thinkercap; th = th->next)
+		for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 		{
 			if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 				continue;
@@ -1932,6 +1932,9 @@ void T_NoEnemiesSector(levelspecthink_t *nobaddies)
 			{
 				checksector = &sectors[s];
 
+				if (!checksector->numenemies) // nothing to look for
+					continue;
+
 				node = checksector->touching_thinglist; // things touching this sector
 				while (node)
 				{
@@ -2040,6 +2043,9 @@ void T_EachTimeThinker(levelspecthink_t *eachtime)
 			{
 				targetsec = &sectors[targetsecnum];
 
+				if (!targetsec->numplayers)
+					continue;
+
 				for (j = 0; j < MAXPLAYERS; j++)
 				{
 					if (!playeringame[j])
@@ -2073,7 +2079,7 @@ void T_EachTimeThinker(levelspecthink_t *eachtime)
 			}
 		}
 
-		if (!FOFsector)
+		if (!FOFsector && sec->numplayers)
 		{
 			for (i = 0; i < MAXPLAYERS; i++)
 			{
@@ -2410,7 +2416,7 @@ int EV_DoFloor(line_t *line, floor_e floortype)
 		// new floor thinker
 		rtn = 1;
 		dofloor = Z_Calloc(sizeof (*dofloor), PU_LEVSPEC, NULL);
-		P_AddThinker(&dofloor->thinker);
+		P_AddThinker(THINK_SPECIAL, &dofloor->thinker);
 
 		// make sure another floor thinker won't get started over this one
 		sec->floordata = dofloor;
@@ -2617,7 +2623,7 @@ int EV_DoElevator(line_t *line, elevator_e elevtype, boolean customspeed)
 		// create and initialize new elevator thinker
 		rtn = 1;
 		elevator = Z_Calloc(sizeof (*elevator), PU_LEVSPEC, NULL);
-		P_AddThinker(&elevator->thinker);
+		P_AddThinker(THINK_SPECIAL, &elevator->thinker);
 		sec->floordata = elevator;
 		sec->ceilingdata = elevator;
 		elevator->thinker.function.acp1 = (actionf_p1)T_MoveElevator;
@@ -2817,6 +2823,10 @@ void EV_CrumbleChain(sector_t *sec, ffloor_t *rover)
 	rover->master->frontsector->floorheight = rover->master->frontsector->ceilingheight - a;
 	rover->master->frontsector->moved = true;
 	sec->moved = true;
+
+	// Called from mobj and player code, where the thinker loop
+	// doesn't clear the sight cache for us
+	P_ClearSightCache();
 }
 
 // Used for bobbing platforms on the water
@@ -2831,8 +2841,8 @@ int EV_BounceSector(sector_t *sec, fixed_t momz, line_t *sourceline) // Momz is
 	if (sec->ceilingdata) // One at a time, ma'am.
 		return 0;
 
-	bouncer = Z_Calloc(sizeof (*bouncer), PU_LEVSPEC, NULL);
-	P_AddThinker(&bouncer->thinker);
+	bouncer = Z_PoolCalloc(levspecpool);
+	P_AddThinker(THINK_SPECIAL, &bouncer->thinker);
 	sec->ceilingdata = bouncer;
 	bouncer->thinker.function.acp1 = (actionf_p1)T_BounceCheese;
 
@@ -2865,8 +2875,8 @@ int EV_DoContinuousFall(sector_t *sec, sector_t *backsector, fixed_t spd, boolea
 		backsector = sec;
 
 	// create and initialize new thinker
-	faller = Z_Calloc(sizeof (*faller), PU_LEVSPEC, NULL);
-	P_AddThinker(&faller->thinker);
+	faller = Z_PoolCalloc(levspecpool);
+	P_AddThinker(THINK_SPECIAL, &faller->thinker);
 	faller->thinker.function.acp1 = (actionf_p1)T_ContinuousFalling;
 
 	// set up the fields
@@ -2915,7 +2925,7 @@ int EV_StartCrumble(sector_t *sec, ffloor_t *rover, boolean floating,
 
 	// create and initialize new elevator thinker
 	elevator = Z_Calloc(sizeof (*elevator), PU_LEVSPEC, NULL);
-	P_AddThinker(&elevator->thinker);
+	P_AddThinker(THINK_SPECIAL, &elevator->thinker);
 	elevator->thinker.function.acp1 = (actionf_p1)T_StartCrumble;
 
 	// Does this crumbler return?
@@ -2988,8 +2998,8 @@ int EV_MarioBlock(sector_t *sec, sector_t *roversector, fixed_t topheight, mobj_
 		}
 		
 		// create and initialize new elevator thinker
-		block = Z_Calloc(sizeof (*block), PU_LEVSPEC, NULL);
-		P_AddThinker(&block->thinker);
+		block = Z_PoolCalloc(levspecpool);
+		P_AddThinker(THINK_SPECIAL, &block->thinker);
 		sec->floordata = block;
 		sec->ceilingdata = block;
 		block->thinker.function.acp1 = (actionf_p1)T_MarioBlock;
@@ -28,6 +28,7 @@
 #include "p_tick.h"
 #include "r_defs.h"
 #include "p_maputl.h"
+#include "z_zone.h"
 
 #define MOBJFLOATSPEED (FRACUNIT*4/NEWTICRATERATIO) // Sets how fast a mobj will float
 
@@ -39,6 +40,7 @@
 #define MAPBLOCKUNITS 128
 #define MAPBLOCKSIZE  (MAPBLOCKUNITS*FRACUNIT)
 #define MAPBLOCKSHIFT (FRACBITS+7)
+#define THINGGRIDSHIFT (FRACBITS+6) // 64 units, see P_ThingsInBoxIterator
 #define MAPBMASK      (MAPBLOCKSIZE-1)
 #define MAPBTOFRAC    (MAPBLOCKSHIFT-FRACBITS)
 
@@ -83,10 +85,31 @@
 
 // both the head and tail of the thinker list
 extern thinker_t thinkercap;
+
+// Every thinker is also kept in the list of its class, in the same order
+// as thinkercap, so code that only wants mobjs doesn't have to walk the
+// sector specials and lights too. Thinkers waiting to be removed
+// stay in their class list until P_RunThinkers frees them.
+typedef enum
+{
+	THINK_MOBJ,
+	THINK_LIGHT,
+	THINK_POLYOBJ,
+	THINK_SPECIAL, // sector specials, scrollers, executors and everything else
+	NUM_THINKERLISTS
+} thinklistnum_t;
+
+// both the head and tail of each class list
+extern thinker_t thlist[NUM_THINKERLISTS];
 extern int runcount;
 
+// fixed-size pools for mobjs, thinkers and sector nodes
+extern mempool_t *mobjpool, *levspecpool;
+extern mempool_t *secnodepool;
+
+void P_InitObjectPools(void);
 void P_InitThinkers(void);
-void P_AddThinker(thinker_t *thinker);
+void P_AddThinker(const thinklistnum_t n, thinker_t *thinker);
 void P_RemoveThinker(thinker_t *thinker);
 
 //
@@ -299,8 +322,6 @@ extern line_t *ceilingline;
 extern line_t *blockingline;
 extern msecnode_t *sector_list;
 
-extern mprecipsecnode_t *precipsector_list;
-
 void P_UnsetThingPosition(mobj_t *thing);
 void P_SetThingPosition(mobj_t *thing);
 
@@ -311,16 +332,24 @@ boolean P_TeleportMove(mobj_t *thing, fixed_t x, fixed_t y, fixed_t z);
 void P_SlideMove(mobj_t *mo);
 void P_BounceMove(mobj_t *mo);
 boolean P_CheckSight(mobj_t *t1, mobj_t *t2);
+void P_LoadReject(lumpnum_t lumpnum);
+void P_GroupSightSectors(void);
+void P_ClearSightCache(void);
+void Command_Sightcounts_f(void);
+void Command_Collidecounts_f(void);
 void P_CheckHoopPosition(mobj_t *hoopthing, fixed_t x, fixed_t y, fixed_t z, fixed_t radius);
 
 boolean P_CheckSector(sector_t *sector, boolean crunch);
 
 void P_DelSeclist(msecnode_t *node);
-void P_DelPrecipSeclist(mprecipsecnode_t *node);
 
 void P_CreateSecNodeList(mobj_t *thing, fixed_t x, fixed_t y);
 void P_Initsecnode(void);
 
+// what sector_t->numenemies counts
+#define P_IsLiveEnemy(mo) (((mo)->flags & (MF_ENEMY|MF_BOSS)) && (mo)->health > 0)
+void P_UpdateSectorEnemies(mobj_t *thing);
+
 extern mobj_t *linetarget; // who got hit (or NULL)
 extern fixed_t attackrange;
 
@@ -47,11 +47,6 @@ static int tmflags;
 static fixed_t tmx;
 static fixed_t tmy;
 
-static precipmobj_t *tmprecipthing;
-static fixed_t preciptmx;
-static fixed_t preciptmy;
-static fixed_t preciptmbbox[4];
-static int preciptmflags;
 
 // If "floatok" true, move would be ok
 // if within "tmfloorz - tmceilingz".
@@ -68,6 +63,16 @@ fixed_t tmsectorceilingz;
 // turned on or off in PIT_CheckThing
 boolean tmsprung;
 
+typedef enum
+{
+	COLLIDE_CHECKS,     // P_CheckPosition calls that looked for things
+	COLLIDE_CANDIDATES, // things passed to PIT_CheckThing
+	COLLIDE_CONTACTS,   // of those, things close enough to touch
+	NUMCOLLIDECOUNTS
+} collidecount_t;
+
+static ULONG collidecounts[NUMCOLLIDECOUNTS];
+
 // keep track of the line that lowers the ceiling,
 // so missiles don't explode against sky hack walls
 line_t *ceilingline;
@@ -77,7 +82,6 @@ line_t *ceilingline;
 line_t *blockingline;
 
 msecnode_t *sector_list = NULL;
-mprecipsecnode_t *precipsector_list = NULL;
 static camera_t *mapcampointer;
 
 //
@@ -241,6 +245,8 @@ static boolean PIT_CheckThing(mobj_t *thing)
 {
 	fixed_t blockdist, topz, tmtopz;
 
+	collidecounts[COLLIDE_CANDIDATES]++;
+
 	// don't clip against self
 	tmsprung = false;
 
@@ -279,6 +285,8 @@ static boolean PIT_CheckThing(mobj_t *thing)
 	if (abs(thing->x - tmx) >= blockdist || abs(thing->y - tmy) >= blockdist)
 		return true; // didn't hit it
 
+	collidecounts[COLLIDE_CONTACTS]++;
+
 	if (thing->type == MT_HOOPCOLLIDE)
 	{
 		if (thing->flags & MF_SPECIAL)
@@ -1309,6 +1317,11 @@ boolean P_CheckPosition(mobj_t *thing, fixed_t x, fixed_t y)
 	// MF_NOCLIPTHING: used by camera to not be blocked by things
 	if (!(thing->flags & MF_NOCLIPTHING))
 	{
+		collidecounts[COLLIDE_CHECKS]++;
+#ifdef THINGGRID
+		if (!P_ThingsInBoxIterator(tmbbox, PIT_CheckThing))
+			blockval = false;
+#else
 		xl = (unsigned int)(tmbbox[BOXLEFT] - bmaporgx - MAXRADIUS)>>MAPBLOCKSHIFT;
 		xh = (unsigned int)(tmbbox[BOXRIGHT] - bmaporgx + MAXRADIUS)>>MAPBLOCKSHIFT;
 		yl = (unsigned int)(tmbbox[BOXBOTTOM] - bmaporgy - MAXRADIUS)>>MAPBLOCKSHIFT;
@@ -1318,6 +1331,7 @@ boolean P_CheckPosition(mobj_t *thing, fixed_t x, fixed_t y)
 			for (by = yl; by <= yh; by++)
 				if (!P_BlockThingsIterator(bx, by, PIT_CheckThing))
 					blockval = false;
+#endif
 	}
 
 	validcount++;
@@ -3712,7 +3726,7 @@ static boolean PIT_ChangeSector(mobj_t *thing, boolean realcrush) // SRB2CBTODO:
 					thinker_t *think;
 					elevator_t *crumbler;
 
-					for (think = thinkercap.next; think != &thinkercap; think = think->next)
+					for (think = thlist[THINK_SPECIAL].cnext; think != &thlist[THINK_SPECIAL]; think = think->cnext)
 					{
 						if (think->function.acp1 != (actionf_p1)T_StartCrumble)
 							continue;
@@ -3770,6 +3784,8 @@ boolean P_CheckSector(sector_t *sector, boolean crunch)
 	nofit = false;
 	crushchange = crunch;
 
+	P_ClearSightCache(); // the sector has moved
+
 	// killough 4/4/98: scan list front-to-back until empty or exhausted,
 	// restarting from beginning after each thing is processed. Avoids
 	// crashes, and is sure to examine all things in the sector, and only
@@ -3906,12 +3922,10 @@ boolean P_CheckSector(sector_t *sector, boolean crunch)
 */
 
 static msecnode_t *headsecnode = NULL;
-static mprecipsecnode_t *headprecipsecnode = NULL;
 
 void P_Initsecnode(void)
 {
 	headsecnode = NULL;
-	headprecipsecnode = NULL;
 }
 
 // P_GetSecnode() retrieves a node from the freelist. The calling routine
@@ -3927,21 +3941,7 @@ static msecnode_t *P_GetSecnode(void)
 		headsecnode = headsecnode->m_snext;
 	}
 	else
-		node = Z_Calloc(sizeof (*node), PU_LEVEL, NULL);
-	return node;
-}
-
-static mprecipsecnode_t *P_GetPrecipSecnode(void)
-{
-	mprecipsecnode_t *node;
-
-	if (headprecipsecnode)
-	{
-		node = headprecipsecnode;
-		headprecipsecnode = headprecipsecnode->m_snext;
-	}
-	else
-		node = Z_Calloc(sizeof (*node), PU_LEVEL, NULL);
+		node = Z_PoolCalloc(secnodepool);
 	return node;
 }
 
@@ -3952,13 +3952,6 @@ static inline void P_PutSecnode(msecnode_t *node)
 	headsecnode = node;
 }
 
-// Node for precip
-static inline void P_PutPrecipSecnode(mprecipsecnode_t *node)
-{
-	node->m_snext = headprecipsecnode;
-	headprecipsecnode = node;
-}
-
 // P_AddSecnode() searches the current list to see if this sector is
 // already there. If not, it adds a sector node at the head of the list of
 // sectors this object appears in. This is called when creating a list of
@@ -3973,6 +3966,14 @@ static msecnode_t *P_AddSecnode(sector_t *s, mobj_t *thing, msecnode_t *nextnode
 		if (node->m_sector == s) // Already have a node for this sector?
 		{
 			node->m_thing = thing; // Yes. Setting m_thing says 'keep it'.
+			if (node->enemy != P_IsLiveEnemy(thing)) // changed since it was counted
+			{
+				node->enemy = !node->enemy;
+				if (node->enemy)
+					s->numenemies++;
+				else
+					s->numenemies--;
+			}
 			return nextnode;
 		}
 		node = node->m_tnext;
@@ -3986,6 +3987,10 @@ static msecnode_t *P_AddSecnode(sector_t *s, mobj_t *thing, msecnode_t *nextnode
 	// mark new nodes unvisited.
 	node->visited = 0;
 
+	node->enemy = P_IsLiveEnemy(thing);
+	if (node->enemy)
+		s->numenemies++;
+
 	node->m_sector = s; // sector
 	node->m_thing = thing; // mobj
 	node->m_tprev = NULL; // prev node on Thing thread
@@ -4003,46 +4008,6 @@ static msecnode_t *P_AddSecnode(sector_t *s, mobj_t *thing, msecnode_t *nextnode
 	return node;
 }
 
-// Add nodes for precip
-static mprecipsecnode_t *P_AddPrecipSecnode(sector_t *s, precipmobj_t *thing, mprecipsecnode_t *nextnode)
-{
-	mprecipsecnode_t *node;
-
-	node = nextnode;
-	while (node)
-	{
-		if (node->m_sector == s) // Already have a node for this sector?
-		{
-			node->m_thing = thing; // Yes. Setting m_thing says 'keep it'.
-			return nextnode;
-		}
-		node = node->m_tnext;
-	}
-
-	// Couldn't find an existing node for this sector. Add one at the head
-	// of the list.
-	node = P_GetPrecipSecnode();
-
-	// mark new nodes unvisited.
-	node->visited = 0;
-
-	node->m_sector = s; // sector
-	node->m_thing = thing; // mobj
-	node->m_tprev = NULL; // prev node on Thing thread
-	node->m_tnext = nextnode; // next node on Thing thread
-	if (nextnode)
-		nextnode->m_tprev = node; // set back link on Thing
-
-	// Add new node at head of sector thread starting at s->touching_thinglist
-
-	node->m_sprev = NULL; // prev node on sector thread
-	node->m_snext = s->touching_preciplist; // next node on sector thread
-	if (s->touching_preciplist)
-		node->m_snext->m_sprev = node;
-	s->touching_preciplist = node;
-	return node;
-}
-
 // P_DelSecnode() deletes a sector node from the list of
 // sectors this object appears in. Returns a pointer to the next node
 // on the linked list, or NULL.
@@ -4079,48 +4044,12 @@ static msecnode_t *P_DelSecnode(msecnode_t *node)
 	if (sn)
 		sn->m_sprev = sp;
 
-	// Return this node to the freelist
-
-	P_PutSecnode(node);
-	return tn;
-}
-
-// Delete nodes for precip
-static mprecipsecnode_t *P_DelPrecipSecnode(mprecipsecnode_t *node)
-{
-	mprecipsecnode_t *tp; // prev node on thing thread
-	mprecipsecnode_t *tn; // next node on thing thread
-	mprecipsecnode_t *sp; // prev node on sector thread
-	mprecipsecnode_t *sn; // next node on sector thread
-
-	if (!node)
-		return NULL;
-
-	// Unlink from the Thing thread. The Thing thread begins at
-	// sector_list and not from mobj_t->touching_sectorlist.
-
-	tp = node->m_tprev;
-	tn = node->m_tnext;
-	if (tp)
-		tp->m_tnext = tn;
-	if (tn)
-		tn->m_tprev = tp;
-
-	// Unlink from the sector thread. This thread begins at
-	// sector_t->touching_thinglist.
-
-	sp = node->m_sprev;
-	sn = node->m_snext;
-	if (sp)
-		sp->m_snext = sn;
-	else
-		node->m_sector->touching_preciplist = sn;
-	if (sn)
-		sn->m_sprev = sp;
+	if (node->enemy)
+		node->m_sector->numenemies--;
 
 	// Return this node to the freelist
 
-	P_PutPrecipSecnode(node);
+	P_PutSecnode(node);
 	return tn;
 }
 
@@ -4131,13 +4060,29 @@ void P_DelSeclist(msecnode_t *node)
 		node = P_DelSecnode(node);
 }
 
-// Delete an entire sector list for precip
-void P_DelPrecipSeclist(mprecipsecnode_t *node)
+// P_UpdateSectorEnemies
+// Brings numenemies of every sector the thing touches up to date, for
+// when its health or flags change without it moving. Nodes are always
+// updated together, so the first one tells if anything changed.
+void P_UpdateSectorEnemies(mobj_t *thing)
 {
-	while (node)
-		node = P_DelPrecipSecnode(node);
+	msecnode_t *node = thing->touching_sectorlist;
+	const boolean enemy = P_IsLiveEnemy(thing);
+
+	if (!node || node->enemy == enemy)
+		return;
+
+	for (; node; node = node->m_tnext)
+	{
+		node->enemy = enemy;
+		if (enemy)
+			node->m_sector->numenemies++;
+		else
+			node->m_sector->numenemies--;
+	}
 }
 
+
 // PIT_GetSectors
 // Locates all the sectors the object is in by looking at the lines that
 // cross through it. You have already decided that the object is allowed
@@ -4175,38 +4120,6 @@ static inline boolean PIT_GetSectors(line_t *ld)
 	return true;
 }
 
-// Get intercepts for precip
-static inline boolean PIT_GetPrecipSectors(line_t *ld)
-{
-	if (preciptmbbox[BOXRIGHT] <= ld->bbox[BOXLEFT] ||
-		preciptmbbox[BOXLEFT] >= ld->bbox[BOXRIGHT] ||
-		preciptmbbox[BOXTOP] <= ld->bbox[BOXBOTTOM] ||
-		preciptmbbox[BOXBOTTOM] >= ld->bbox[BOXTOP])
-	return true;
-
-	if (P_BoxOnLineSide(preciptmbbox, ld) != -1)
-		return true;
-
-	// This line crosses through the object.
-
-	// Collect the sector(s) from the line and add to the
-	// sector_list you're examining. If the Thing ends up being
-	// allowed to move to this position, then the sector_list
-	// will be attached to the Thing's mobj_t at touching_sectorlist.
-
-	precipsector_list = P_AddPrecipSecnode(ld->frontsector, tmprecipthing, precipsector_list);
-
-	// Don't assume all lines are 2-sided, since some Things
-	// like MT_TFOG are allowed regardless of whether their radius takes
-	// them beyond an impassable linedef.
-
-	// Use sidedefs instead of 2s flag to determine two-sidedness.
-	if (ld->backsector)
-		precipsector_list = P_AddPrecipSecnode(ld->backsector, tmprecipthing, precipsector_list);
-
-	return true;
-}
-
 // P_CreateSecNodeList alters/creates the sector_list that shows what sectors
 // the object resides in.
 void P_CreateSecNodeList(mobj_t *thing, fixed_t x, fixed_t y)
@@ -4292,75 +4205,6 @@ void P_CreateSecNodeList(mobj_t *thing, fixed_t x, fixed_t y)
 	}
 }
 
-// Create a list of sectors for precipitation
-void P_CreatePrecipSecNodeList(precipmobj_t *thing, fixed_t x, fixed_t y)
-{
-	int xl, xh, yl, yh, bx, by;
-	mprecipsecnode_t *node = precipsector_list;
-	precipmobj_t *saved_tmthing = tmprecipthing; /* cph - see comment at func end */
-
-	// First, clear out the existing m_thing fields. As each node is
-	// added or verified as needed, m_thing will be set properly. When
-	// finished, delete all nodes where m_thing is still NULL. These
-	// represent the sectors the Thing has vacated.
-
-	while (node)
-	{
-		node->m_thing = NULL;
-		node = node->m_tnext;
-	}
-
-	tmprecipthing = thing;
-	preciptmflags = thing->flags;
-
-	preciptmx = x;
-	preciptmy = y;
-
-	preciptmbbox[BOXTOP] = y + 2*FRACUNIT;
-	preciptmbbox[BOXBOTTOM] = y - 2*FRACUNIT;
-	preciptmbbox[BOXRIGHT] = x + 2*FRACUNIT;
-	preciptmbbox[BOXLEFT] = x - 2*FRACUNIT;
-
-	validcount++; // used to make sure we only process a line once
-
-	xl = (ULONG)(preciptmbbox[BOXLEFT] - bmaporgx)>>MAPBLOCKSHIFT;
-	xh = (ULONG)(preciptmbbox[BOXRIGHT] - bmaporgx)>>MAPBLOCKSHIFT;
-	yl = (ULONG)(preciptmbbox[BOXBOTTOM] - bmaporgy)>>MAPBLOCKSHIFT;
-	yh = (ULONG)(preciptmbbox[BOXTOP] - bmaporgy)>>MAPBLOCKSHIFT;
-
-	for (bx = xl; bx <= xh; bx++)
-		for (by = yl; by <= yh; by++)
-			P_BlockLinesIterator(bx, by, PIT_GetPrecipSectors);
-
-	// Add the sector of the (x, y) point to sector_list.
-	precipsector_list = P_AddPrecipSecnode(thing->subsector->sector, thing, precipsector_list);
-
-	// Now delete any nodes that won't be used. These are the ones where
-	// m_thing is still NULL.
-	node = precipsector_list;
-	while (node)
-	{
-		if (!node->m_thing)
-		{
-			if (node == precipsector_list)
-				precipsector_list = node->m_tnext;
-			node = P_DelPrecipSecnode(node);
-		}
-		else
-			node = node->m_tnext;
-	}
-
-	/* cph -
-	* This is the strife we get into for using global variables. tmthing
-	*  is being used by several different functions calling
-	*  P_BlockThingIterator, including functions that can be called *from*
-	*  P_BlockThingIterator. Using a global tmthing is not reentrant.
-	* OTOH for Boom/MBF demos we have to preserve the buggy behavior.
-	*  Fun. We restore its previous value unless we're in a Boom/MBF demo.
-	*/
-	tmprecipthing = saved_tmthing;
-}
-
 /* cphipps 2004/08/30 -
  * Must clear tmthing at tic end, as it might contain a pointer to a removed thinker,
  or the level might have ended/been ended and we clear the objects it was pointing too.
@@ -4609,3 +4453,30 @@ mobj_t *P_CheckOnmobj(mobj_t *thing)
 	*tmthing = oldmo;
 	return NULL;
 }
+
+//
+// Command_Collidecounts_f
+//
+// How many things P_CheckPosition looked at against how many were
+// actually touched. "collidecounts reset" starts counting again.
+//
+void Command_Collidecounts_f(void)
+{
+	ULONG checks, candidates;
+
+	if (COM_Argc() > 1 && !stricmp(COM_Argv(1), "reset"))
+	{
+		memset(collidecounts, 0, sizeof (collidecounts));
+		return;
+	}
+
+	checks = collidecounts[COLLIDE_CHECKS];
+	candidates = collidecounts[COLLIDE_CANDIDATES];
+	CONS_Printf("Position checks:  %lu\n", checks);
+	if (!checks)
+		return;
+
+	CONS_Printf("Things tested:    %lu (%lu per check)\n", candidates, candidates/checks);
+	CONS_Printf("Things in reach:  %lu (%lu%% of tested)\n", collidecounts[COLLIDE_CONTACTS],
+		candidates ? collidecounts[COLLIDE_CONTACTS]*100/candidates : 0);
+}
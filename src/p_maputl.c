@@ -789,6 +789,139 @@ no_thing:
 }
 
 
+#ifdef THINGGRID
+//
+// THING GRID
+//
+// Things in the blockmap are also kept in a grid with cells a quarter
+// of a mapblock, so collision checks look at far fewer things that
+// can't touch. Like blocklinks, things are linked by their origin, so
+// a search is widened by MAXRADIUS. Things wider than that are kept
+// on their own list and checked against every search instead.
+//
+
+static mobj_t **thinggrid = NULL;
+static int thinggridwidth, thinggridheight;
+static mobj_t *bigthings = NULL;
+
+//
+// P_InitThingGrid
+// Call after the blockmap is loaded and before any things are spawned.
+//
+void P_InitThingGrid(void)
+{
+	thinggridwidth = bmapwidth << (MAPBLOCKSHIFT - THINGGRIDSHIFT);
+	thinggridheight = bmapheight << (MAPBLOCKSHIFT - THINGGRIDSHIFT);
+	Z_Calloc(sizeof (*thinggrid) * thinggridwidth * thinggridheight, PU_LEVEL, &thinggrid);
+	bigthings = NULL;
+}
+
+static void P_LinkThingGrid(mobj_t *thing)
+{
+	mobj_t **link;
+
+	if (!thinggrid)
+		return;
+
+	if (thing->radius > MAXRADIUS)
+		link = &bigthings;
+	else
+	{
+		const int gx = (thing->x - bmaporgx)>>THINGGRIDSHIFT;
+		const int gy = (thing->y - bmaporgy)>>THINGGRIDSHIFT;
+		if (gx < 0 || gx >= thinggridwidth || gy < 0 || gy >= thinggridheight)
+			return;
+		link = &thinggrid[gy*thinggridwidth + gx];
+	}
+
+	if ((thing->gnext = *link) != NULL)
+		thing->gnext->gprev = &thing->gnext;
+	thing->gprev = link;
+	*link = thing;
+}
+
+static void P_UnlinkThingGrid(mobj_t *thing)
+{
+	mobj_t *gnext, **gprev = thing->gprev;
+
+	if (gprev && (*gprev = gnext = thing->gnext) != NULL)
+		gnext->gprev = gprev;
+	thing->gprev = NULL;
+}
+
+//
+// P_UpdateThingGrid
+// Relinks a thing after its radius was changed without moving it,
+// since that decides whether it belongs with the wide things.
+//
+void P_UpdateThingGrid(mobj_t *thing)
+{
+	if (!thing->gprev)
+		return;
+
+	P_UnlinkThingGrid(thing);
+	P_LinkThingGrid(thing);
+}
+
+//
+// P_ThingsInBoxIterator
+// Calls func for every thing that may touch a thing with bounding box
+// bbox, in the grid cells around it and on the list of wide things.
+// A false return skips the rest of that cell, as with
+// P_BlockThingsIterator, and makes the whole iteration return false.
+//
+boolean P_ThingsInBoxIterator(const fixed_t *bbox, boolean (*func)(mobj_t *))
+{
+	const fixed_t centerx = bbox[BOXLEFT]/2 + bbox[BOXRIGHT]/2;
+	const fixed_t centery = bbox[BOXBOTTOM]/2 + bbox[BOXTOP]/2;
+	const fixed_t halfwidth = bbox[BOXRIGHT]/2 - bbox[BOXLEFT]/2;
+	const fixed_t halfheight = bbox[BOXTOP]/2 - bbox[BOXBOTTOM]/2;
+	int xl, xh, yl, yh, gx, gy;
+	mobj_t *mo;
+	boolean result = true;
+
+	if (!thinggrid)
+		return true;
+
+	xl = (bbox[BOXLEFT] - bmaporgx - MAXRADIUS)>>THINGGRIDSHIFT;
+	xh = (bbox[BOXRIGHT] - bmaporgx + MAXRADIUS)>>THINGGRIDSHIFT;
+	yl = (bbox[BOXBOTTOM] - bmaporgy - MAXRADIUS)>>THINGGRIDSHIFT;
+	yh = (bbox[BOXTOP] - bmaporgy + MAXRADIUS)>>THINGGRIDSHIFT;
+
+	if (xl < 0)
+		xl = 0;
+	if (yl < 0)
+		yl = 0;
+	if (xh >= thinggridwidth)
+		xh = thinggridwidth - 1;
+	if (yh >= thinggridheight)
+		yh = thinggridheight - 1;
+
+	for (gx = xl; gx <= xh; gx++)
+		for (gy = yl; gy <= yh; gy++)
+			for (mo = thinggrid[gy*thinggridwidth + gx]; mo; mo = mo->gnext)
+				if (!func(mo))
+				{
+					result = false;
+					break;
+				}
+
+	for (mo = bigthings; mo; mo = mo->gnext)
+	{
+		if (abs(mo->x - centerx) >= mo->radius + halfwidth
+			|| abs(mo->y - centery) >= mo->radius + halfheight)
+			continue;
+		if (!func(mo))
+		{
+			result = false;
+			break;
+		}
+	}
+
+	return result;
+}
+#endif
+
 //
 // THING POSITION SETTING
 //
@@ -823,6 +956,9 @@ void P_UnsetThingPosition(mobj_t *thing)
 		if ((*sprev = snext) != NULL)  // unlink from sector list
 			snext->sprev = sprev;
 
+		if (thing->type == MT_PLAYER)
+			thing->subsector->sector->numplayers--;
+
 		// phares 3/14/98
 		//
 		// Save the sector list pointed to by touching_sectorlist.
@@ -857,17 +993,10 @@ void P_UnsetThingPosition(mobj_t *thing)
 		if (bprev && (*bprev = bnext = thing->bnext) != NULL)  // unlink from block map
 			bnext->bprev = bprev;
 	}
-}
-
-void P_UnsetPrecipThingPosition(precipmobj_t *thing)
-{
-	precipmobj_t **sprev = thing->sprev;
-	precipmobj_t  *snext = thing->snext;
-	if ((*sprev = snext) != NULL)  // unlink from sector list
-		snext->sprev = sprev;
 
-	precipsector_list = thing->touching_sectorlist;
-	thing->touching_sectorlist = NULL; //to be restored by P_SetPrecipThingPosition
+#ifdef THINGGRID
+	P_UnlinkThingGrid(thing);
+#endif
 }
 
 //
@@ -914,6 +1043,9 @@ void P_SetThingPosition(mobj_t *thing)
 		thing->sprev = link;
 		*link = thing;
 
+		if (thing->type == MT_PLAYER)
+			ss->sector->numplayers++;
+
 		// phares 3/16/98
 		//
 		// If sector_list isn't NULL, it has a collection of sector
@@ -951,6 +1083,9 @@ void P_SetThingPosition(mobj_t *thing)
 				bnext->bprev = &thing->bnext;
 			thing->bprev = link;
 			*link = thing;
+#ifdef THINGGRID
+			P_LinkThingGrid(thing);
+#endif
 		}
 		else // thing is off the map
 			thing->bnext = NULL, thing->bprev = NULL;
@@ -966,22 +1101,6 @@ void P_SetThingPosition(mobj_t *thing)
 	}
 }
 
-void P_SetPrecipitationThingPosition(precipmobj_t *thing)
-{
-	subsector_t *ss = thing->subsector = R_PointInSubsector(thing->x, thing->y);
-
-	precipmobj_t **link = &ss->sector->preciplist;
-	precipmobj_t *snext = *link;
-	if ((thing->snext = snext) != NULL)
-		snext->sprev = &thing->snext;
-	thing->sprev = link;
-	*link = thing;
-
-	P_CreatePrecipSecNodeList(thing, thing->x, thing->y);
-	thing->touching_sectorlist = precipsector_list; // Attach to Thing's precipmobj_t
-	precipsector_list = NULL; // clear for next time
-}
-
 //
 // BLOCK MAP ITERATORS
 // For each line/thing in the given mapblock,
@@ -1077,6 +1196,320 @@ boolean P_BlockThingsIterator(int x, int y, boolean (*func)(mobj_t *)) // TODO:
 	return true;
 }
 
+//
+// SPATIAL SEARCHES
+//
+// Finding things near a point by walking the blockmap around it, so the
+// cost depends on how much is nearby rather than on how much is in the
+// level. Things with MF_NOBLOCKMAP aren't in the blockmap and are never
+// found this way.
+//
+
+typedef struct
+{
+	mobj_t *mo;
+	fixed_t dist;
+	size_t seq; // keeps equally distant things in the order they were found
+} searchcand_t;
+
+static searchcand_t *searchheap = NULL;
+static size_t searchheapsize = 0, searchheapmax = 0;
+static size_t searchseq;
+
+//
+// P_InitThingSearch
+// Search from searcher's position, in 3D, for anything but searcher.
+//
+void P_InitThingSearch(thingsearch_t *search, mobj_t *searcher)
+{
+	search->x = searcher->x;
+	search->y = searcher->y;
+	search->z = searcher->z;
+	search->threed = true;
+	search->flags = 0;
+	search->type = NUMMOBJTYPES;
+	search->searcher = searcher;
+	search->check = NULL;
+}
+
+static fixed_t P_SearchDistance(const thingsearch_t *search, const mobj_t *mo)
+{
+	fixed_t dist = P_AproxDistance(mo->x - search->x, mo->y - search->y);
+
+	if (search->threed)
+		dist = P_AproxDistance(dist, mo->z - search->z);
+	return dist;
+}
+
+// Everything but the check function, which may be expensive
+static boolean P_SearchWants(const thingsearch_t *search, const mobj_t *mo)
+{
+	if (mo == search->searcher)
+		return false;
+	if (search->flags && !(mo->flags & search->flags))
+		return false;
+	if (search->type != NUMMOBJTYPES && mo->type != search->type)
+		return false;
+	return true;
+}
+
+// Block column or row of a map coordinate, which may be off the map
+static int P_SearchBlockX(INT64 x)
+{
+	return (int)((x - bmaporgx) >> MAPBLOCKSHIFT);
+}
+
+static int P_SearchBlockY(INT64 y)
+{
+	return (int)((y - bmaporgy) >> MAPBLOCKSHIFT);
+}
+
+//
+// P_SearchThingsInBox
+// Calls func for each thing the search accepts whose centre is inside
+// bbox. Returns false if func stopped the search early.
+//
+boolean P_SearchThingsInBox(const thingsearch_t *search, const fixed_t *bbox,
+	boolean (*func)(mobj_t *mo, mobj_t *searcher))
+{
+	int xl, xh, yl, yh, bx, by;
+	mobj_t *mo;
+
+	xl = P_SearchBlockX(bbox[BOXLEFT]);
+	xh = P_SearchBlockX(bbox[BOXRIGHT]);
+	yl = P_SearchBlockY(bbox[BOXBOTTOM]);
+	yh = P_SearchBlockY(bbox[BOXTOP]);
+
+	if (xl < 0)
+		xl = 0;
+	if (yl < 0)
+		yl = 0;
+	if (xh >= bmapwidth)
+		xh = bmapwidth - 1;
+	if (yh >= bmapheight)
+		yh = bmapheight - 1;
+
+	for (by = yl; by <= yh; by++)
+		for (bx = xl; bx <= xh; bx++)
+			for (mo = blocklinks[by*bmapwidth + bx]; mo; mo = mo->bnext)
+			{
+				if (mo->x < bbox[BOXLEFT] || mo->x > bbox[BOXRIGHT]
+					|| mo->y < bbox[BOXBOTTOM] || mo->y > bbox[BOXTOP])
+					continue;
+				if (!P_SearchWants(search, mo))
+					continue;
+				if (search->check && !search->check(mo, search->searcher))
+					continue;
+				if (!func(mo, search->searcher))
+					return false;
+			}
+
+	return true;
+}
+
+//
+// P_SearchThingsInRadius
+// Calls func for each thing the search accepts no more than radius
+// away. Returns false if func stopped the search early.
+//
+boolean P_SearchThingsInRadius(const thingsearch_t *search, fixed_t radius,
+	boolean (*func)(mobj_t *mo, mobj_t *searcher))
+{
+	int xl, xh, yl, yh, bx, by;
+	mobj_t *mo;
+
+	xl = P_SearchBlockX((INT64)search->x - radius);
+	xh = P_SearchBlockX((INT64)search->x + radius);
+	yl = P_SearchBlockY((INT64)search->y - radius);
+	yh = P_SearchBlockY((INT64)search->y + radius);
+
+	if (xl < 0)
+		xl = 0;
+	if (yl < 0)
+		yl = 0;
+	if (xh >= bmapwidth)
+		xh = bmapwidth - 1;
+	if (yh >= bmapheight)
+		yh = bmapheight - 1;
+
+	for (by = yl; by <= yh; by++)
+		for (bx = xl; bx <= xh; bx++)
+			for (mo = blocklinks[by*bmapwidth + bx]; mo; mo = mo->bnext)
+			{
+				if (!P_SearchWants(search, mo))
+					continue;
+				if (P_SearchDistance(search, mo) > radius)
+					continue;
+				if (search->check && !search->check(mo, search->searcher))
+					continue;
+				if (!func(mo, search->searcher))
+					return false;
+			}
+
+	return true;
+}
+
+static inline boolean P_SearchCandBefore(const searchcand_t *a, const searchcand_t *b)
+{
+	return a->dist < b->dist || (a->dist == b->dist && a->seq < b->seq);
+}
+
+static void P_PushSearchCand(mobj_t *mo, fixed_t dist)
+{
+	size_t i, parent;
+	searchcand_t cand;
+
+	if (searchheapsize == searchheapmax)
+	{
+		searchheapmax = searchheapmax ? searchheapmax*2 : 64;
+		searchheap = realloc(searchheap, searchheapmax * sizeof (*searchheap));
+		if (!searchheap)
+			I_Error("Out of memory in P_PushSearchCand");
+	}
+
+	cand.mo = mo;
+	cand.dist = dist;
+	cand.seq = searchseq++;
+
+	for (i = searchheapsize++; i; i = parent)
+	{
+		parent = (i - 1) / 2;
+		if (!P_SearchCandBefore(&cand, &searchheap[parent]))
+			break;
+		searchheap[i] = searchheap[parent];
+	}
+	searchheap[i] = cand;
+}
+
+static mobj_t *P_PopSearchCand(void)
+{
+	mobj_t *mo = searchheap[0].mo;
+	searchcand_t last = searchheap[--searchheapsize];
+	size_t i, child;
+
+	for (i = 0; (child = 2*i + 1) < searchheapsize; i = child)
+	{
+		if (child + 1 < searchheapsize && P_SearchCandBefore(&searchheap[child+1], &searchheap[child]))
+			child++;
+		if (!P_SearchCandBefore(&searchheap[child], &last))
+			break;
+		searchheap[i] = searchheap[child];
+	}
+	if (searchheapsize)
+		searchheap[i] = last;
+	return mo;
+}
+
+static void P_SearchBlock(const thingsearch_t *search, int bx, int by, fixed_t maxdist)
+{
+	mobj_t *mo;
+	fixed_t dist;
+
+	if (bx < 0 || by < 0 || bx >= bmapwidth || by >= bmapheight)
+		return;
+
+	for (mo = blocklinks[by*bmapwidth + bx]; mo; mo = mo->bnext)
+	{
+		if (!P_SearchWants(search, mo))
+			continue;
+		dist = P_SearchDistance(search, mo);
+		if (maxdist && dist > maxdist)
+			continue;
+		P_PushSearchCand(mo, dist);
+	}
+}
+
+//
+// P_SearchNearestThings
+// Finds up to k things the search accepts, nearest first, no more than
+// maxdist away (0 for anywhere on the map). Blocks are searched in
+// growing square rings around the start, and the check function is only
+// called on things once nothing unsearched could be closer, so it isn't
+// wasted on things farther away than the ones returned.
+//
+// The check function must not start another search.
+//
+size_t P_SearchNearestThings(const thingsearch_t *search, fixed_t maxdist, mobj_t **found, size_t k)
+{
+	int ox, oy, r, maxring, i;
+	INT64 left, right, bottom, top, bound;
+	size_t numfound = 0;
+	mobj_t *mo;
+
+	if (!k || !blocklinks)
+		return 0;
+
+	ox = P_SearchBlockX(search->x);
+	oy = P_SearchBlockY(search->y);
+
+	// the ring that reaches the far side of the map
+	maxring = max(max(ox, bmapwidth - 1 - ox), max(oy, bmapheight - 1 - oy));
+	if (maxdist > 0)
+	{
+		r = max(max(ox - P_SearchBlockX((INT64)search->x - maxdist), P_SearchBlockX((INT64)search->x + maxdist) - ox),
+			max(oy - P_SearchBlockY((INT64)search->y - maxdist), P_SearchBlockY((INT64)search->y + maxdist) - oy));
+		if (r < maxring)
+			maxring = r;
+	}
+	else
+		maxdist = 0;
+
+	searchheapsize = searchseq = 0;
+
+	for (r = 0; r <= maxring && numfound < k; r++)
+	{
+		if (!r)
+			P_SearchBlock(search, ox, oy, maxdist);
+		else
+		{
+			for (i = -r; i <= r; i++)
+			{
+				P_SearchBlock(search, ox + i, oy - r, maxdist);
+				P_SearchBlock(search, ox + i, oy + r, maxdist);
+			}
+			for (i = -r + 1; i < r; i++)
+			{
+				P_SearchBlock(search, ox - r, oy + i, maxdist);
+				P_SearchBlock(search, ox + r, oy + i, maxdist);
+			}
+		}
+
+		// anything in a later ring is at least this far away
+		if (r == maxring)
+			bound = MAXINT;
+		else
+		{
+			left = search->x - (bmaporgx + (INT64)(ox - r)*MAPBLOCKSIZE);
+			right = bmaporgx + (INT64)(ox + r + 1)*MAPBLOCKSIZE - search->x;
+			bottom = search->y - (bmaporgy + (INT64)(oy - r)*MAPBLOCKSIZE);
+			top = bmaporgy + (INT64)(oy + r + 1)*MAPBLOCKSIZE - search->y;
+			bound = min(min(left, right), min(bottom, top));
+		}
+
+		while (searchheapsize && numfound < k && searchheap[0].dist <= bound)
+		{
+			mo = P_PopSearchCand();
+			if (!search->check || search->check(mo, search->searcher))
+				found[numfound++] = mo;
+		}
+	}
+
+	return numfound;
+}
+
+//
+// P_SearchNearestThing
+// The nearest thing the search accepts, or NULL.
+//
+mobj_t *P_SearchNearestThing(const thingsearch_t *search, fixed_t maxdist)
+{
+	mobj_t *mo;
+
+	if (!P_SearchNearestThings(search, maxdist, &mo, 1))
+		return NULL;
+	return mo;
+}
+
 //
 // INTERCEPT ROUTINES
 //
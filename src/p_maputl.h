@@ -55,9 +55,6 @@ void P_MakeDivline(line_t *li, divline_t *dl);
 void P_CameraLineOpening(line_t *plinedef);
 fixed_t P_InterceptVector(divline_t *v2, divline_t *v1);
 int P_BoxOnLineSide(fixed_t *tmbox, line_t *ld);
-void P_UnsetPrecipThingPosition(precipmobj_t *thing);
-void P_SetPrecipitationThingPosition(precipmobj_t *thing);
-void P_CreatePrecipSecNodeList(precipmobj_t *thing, fixed_t x,fixed_t y);
 boolean P_SceneryTryMove(mobj_t *thing, fixed_t x, fixed_t y);
 
 extern fixed_t opentop, openbottom, openrange, lowfloor;
@@ -67,6 +64,35 @@ void P_LineOpening(line_t *plinedef);
 boolean P_BlockLinesIterator(int x, int y, boolean(*func)(line_t *));
 boolean P_BlockThingsIterator(int x, int y, boolean(*func)(mobj_t *));
 
+#ifdef THINGGRID
+void P_InitThingGrid(void);
+void P_UpdateThingGrid(mobj_t *thing);
+boolean P_ThingsInBoxIterator(const fixed_t *bbox, boolean (*func)(mobj_t *));
+#endif
+
+/**	\brief	What a spatial search over the blockmap is looking for
+
+	Distances are P_AproxDistance between centres. Things with
+	MF_NOBLOCKMAP aren't in the blockmap and are never found.
+*/
+typedef struct
+{
+	fixed_t x, y, z; // where to search from
+	boolean threed; // measure distance in 3D, not just across the map
+	int flags; // the thing must have one of these flags, 0 for any
+	mobjtype_t type; // the thing must be this type, NUMMOBJTYPES for any
+	mobj_t *searcher; // never found, and passed to check and func
+	boolean (*check)(mobj_t *mo, mobj_t *searcher); // anything else, NULL for nothing
+} thingsearch_t;
+
+void P_InitThingSearch(thingsearch_t *search, mobj_t *searcher);
+boolean P_SearchThingsInBox(const thingsearch_t *search, const fixed_t *bbox,
+	boolean (*func)(mobj_t *mo, mobj_t *searcher));
+boolean P_SearchThingsInRadius(const thingsearch_t *search, fixed_t radius,
+	boolean (*func)(mobj_t *mo, mobj_t *searcher));
+size_t P_SearchNearestThings(const thingsearch_t *search, fixed_t maxdist, mobj_t **found, size_t k);
+mobj_t *P_SearchNearestThing(const thingsearch_t *search, fixed_t maxdist);
+
 #define PT_ADDLINES     1
 #define PT_ADDTHINGS    2
 #define PT_EARLYOUT     4
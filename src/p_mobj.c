@@ -74,6 +74,7 @@ void P_RunCachedActions(void)
 		var1 = states[ac->statenum].var1;
 		var2 = states[ac->statenum].var2;
 		states[ac->statenum].action.acp1(ac->mobj);
+		P_UpdateSectorEnemies(ac->mobj);
 		next = ac->next;
 		Z_Free(ac);
 	}
@@ -199,7 +200,7 @@ boolean P_SetPlayerMobjState(mobj_t *mobj, statenum_t state)
 		{
 			var1 = st->var1;
 			var2 = st->var2;
-			st->action.acp1(mobj);
+			P_RunStateAction(st->action.acp1, mobj);
 		}
 
 		seenstate[state] = 1 + st->nextstate;
@@ -265,7 +266,11 @@ boolean P_SetMobjState(mobj_t *mobj, statenum_t state)
 		{
 			var1 = st->var1;
 			var2 = st->var2;
-			st->action.acp1(mobj);
+			P_RunStateAction(st->action.acp1, mobj);
+
+			// Actions like A_MinusPopup and A_SetObjectFlags turn things
+			// into enemies and back, so sector counts must follow at once
+			P_UpdateSectorEnemies(mobj);
 		}
 
 		seenstate[state] = 1 + st->nextstate;
@@ -308,23 +313,6 @@ boolean P_SetMobjStateNF(mobj_t *mobj, statenum_t state)
 	return true;
 }
 
-static boolean P_SetPrecipMobjState(precipmobj_t *mobj, statenum_t state)
-{
-	state_t *st;
-
-	if (state == S_NULL)
-	{ // Remove mobj
-		P_RemovePrecipMobj(mobj);
-		return false;
-	}
-	st = &states[state];
-	mobj->state = st;
-	mobj->tics = st->tics;
-	mobj->sprite = st->sprite;
-	mobj->frame = st->frame;
-	return true;
-}
-
 //
 // P_EmeraldManager
 //
@@ -351,7 +339,7 @@ void P_EmeraldManager(void)
 		spawnpoints[i] = NULL;
 	}
 
-	for (think = thinkercap.next; think != &thinkercap; think = think->next)
+	for (think = thlist[THINK_MOBJ].cnext; think != &thlist[THINK_MOBJ]; think = think->cnext)
 	{
 		if (think->function.acp1 != (actionf_p1)P_MobjThinker)
 			continue; // not a mobj thinker
@@ -3145,7 +3133,7 @@ void P_DestroyRobots(void)
 	thinker_t *think;
 
 	count = 0;
-	for (think = thinkercap.next; think != &thinkercap; think = think->next)
+	for (think = thlist[THINK_MOBJ].cnext; think != &thlist[THINK_MOBJ]; think = think->cnext)
 	{
 		if (think->function.acp1 != (actionf_p1)P_MobjThinker)
 			continue; // not a mobj thinker
@@ -3711,28 +3699,31 @@ animonly:
 	}
 }
 
-static void CalculatePrecipFloor(precipmobj_t *mobj)
+//
+// Precipitation
+//
+precipdrops_t precipdrops;
+
+// Where a drop at x, y in the sector lands
+static fixed_t P_PrecipFloor(const sector_t *sector, fixed_t x, fixed_t y)
 {
-	// Recalculate floorz each time
-	const sector_t *mobjsecsubsec;
-	if (mobj && mobj->subsector && mobj->subsector->sector)
-		mobjsecsubsec = mobj->subsector->sector;
-	else
-		return;
+	fixed_t floorz;
 #ifdef ESLOPE
 	// NOTE: P_GetMobjZAtF can't be used here
-	mobj->floorz = (mobjsecsubsec->f_slope ?
-	 P_GetZAt(mobjsecsubsec->f_slope, mobj->x, mobj->y):
-	 mobjsecsubsec->floorheight);
+	floorz = (sector->f_slope ?
+	 P_GetZAt(sector->f_slope, x, y):
+	 sector->floorheight);
 #else
-	mobj->floorz = mobjsecsubsec->floorheight;
+	(void)x;
+	(void)y;
+	floorz = sector->floorheight;
 #endif
 
-	if (mobjsecsubsec->ffloors)
+	if (sector->ffloors)
 	{
 		ffloor_t *rover;
 
-		for (rover = mobjsecsubsec->ffloors; rover; rover = rover->next)
+		for (rover = sector->ffloors; rover; rover = rover->next)
 		{
 			// If it exists, it'll get rained on.
 			if (!(rover->flags & FF_EXISTS))
@@ -3741,98 +3732,186 @@ static void CalculatePrecipFloor(precipmobj_t *mobj)
 			if (!(rover->flags & FF_BLOCKOTHERS) && !(rover->flags & FF_SWIMMABLE))
 				continue;
 
-			if (*rover->topheight > mobj->floorz)
-				mobj->floorz = *rover->topheight;
+			if (*rover->topheight > floorz)
+				floorz = *rover->topheight;
 		}
 	}
+
+	return floorz;
 }
 
 void P_RecalcPrecipInSector(sector_t *sector)
 {
-	mprecipsecnode_t *psecnode;
+	size_t i;
 
 	if (!sector)
 		return;
 
 	sector->moved = true; // Recalc lighting and things too, maybe
 
-	for (psecnode = sector->touching_preciplist; psecnode; psecnode = psecnode->m_snext)
-		CalculatePrecipFloor(psecnode->m_thing);
+	if (!precipdrops.block)
+		return;
+
+	for (i = sector->firstprecip; i < sector->firstprecip + sector->numprecip; i++)
+		precipdrops.floorz[i] = P_PrecipFloor(sector, precipdrops.x[i], precipdrops.y[i]);
 }
 
-//
-// P_NullPrecipThinker
-//
-// For "Blank" precipitation
-//
-void P_NullPrecipThinker(precipmobj_t *mobj)
+static void P_SetPrecipState(size_t i, statenum_t state)
 {
-	(void)mobj;
+	precipdrops.state[i] = state;
+	precipdrops.tics[i] = states[state].tics;
 }
 
 // NOTE: A very important thing to know is that precip actually goes
 // back to the top of where it spawned so that new precip does not have
 // to be regenerated once it hits the floor
-void P_SnowThinker(precipmobj_t *mobj)
+static void P_SnowFall(const sector_t *sector)
 {
-	if (P_FreezeObjectplace())
-		return;
-
-	// adjust height
-	mobj->z += mobj->momz;
-
-	if (mobj->z <= mobj->floorz) // Precipmobjs can't use P_IsObjectOnGround
-		mobj->z = mobj->subsector->sector->ceilingheight;
+	const fixed_t top = sector->ceilingheight;
+	fixed_t *z = precipdrops.z + sector->firstprecip;
+	const fixed_t *floorz = precipdrops.floorz + sector->firstprecip;
+	const fixed_t *momz = precipdrops.momz + sector->firstprecip;
+	const size_t n = sector->numprecip;
+	size_t i;
 
-	return;
+	// Precipmobjs can't use P_IsObjectOnGround
+	for (i = 0; i < n; i++)
+	{
+		const fixed_t newz = z[i] + momz[i];
+		z[i] = newz <= floorz[i] ? top : newz;
+	}
 }
 
-void P_RainThinker(precipmobj_t *mobj)
+static void P_RainFall(const sector_t *sector)
 {
-	if (P_FreezeObjectplace())
-		return;
+	fixed_t *z = precipdrops.z + sector->firstprecip;
+	const fixed_t *momz = precipdrops.momz + sector->firstprecip;
+	const size_t n = sector->numprecip;
+	size_t i;
 
 	// adjust height
-	mobj->z += mobj->momz;
+	for (i = 0; i < n; i++)
+		z[i] += momz[i];
 
-	if (mobj->state != &states[S_RAIN1])
+	for (i = sector->firstprecip; i < sector->firstprecip + n; i++)
 	{
-		// cycle through states,
-		// calling action functions at transitions
-		if (mobj->tics != -1)
+		if (precipdrops.state[i] != S_RAIN1)
 		{
-			mobj->tics--;
+			// cycle through states
+			if (precipdrops.tics[i] != -1 && !--precipdrops.tics[i])
+				P_SetPrecipState(i, states[precipdrops.state[i]].nextstate);
 
-			// you can cycle through multiple states in a tic
-			if (!mobj->tics)
-				if (!P_SetPrecipMobjState(mobj, mobj->state->nextstate))
-					return; // freed itself
+			if (precipdrops.state[i] == S_RAINRETURN)
+			{
+				precipdrops.z[i] = sector->ceilingheight;
+				precipdrops.momz[i] = mobjinfo[MT_RAIN].speed/NEWTICRATERATIO;
+				P_SetPrecipState(i, S_RAIN1);
+			}
 		}
-
-		if (mobj->state == &states[S_RAINRETURN])
+		// Precipmobjs can't use P_IsObjectOnGround
+		else if (precipdrops.z[i] <= precipdrops.floorz[i] && precipdrops.momz[i])
 		{
-			mobj->z = mobj->subsector->sector->ceilingheight;
-			mobj->momz = mobjinfo[MT_RAIN].speed/NEWTICRATERATIO;
-			P_SetPrecipMobjState(mobj, S_RAIN1);
+			// No splashes on sky or bottomless pits
+			if (precipdrops.z[i] <= sector->floorheight
+				&& (GETSECSPECIAL(sector->special, 1) == 7 || GETSECSPECIAL(sector->special, 1) == 6
+				|| sector->floorpic == skyflatnum))
+				precipdrops.z[i] = sector->ceilingheight;
+			else
+			{
+				precipdrops.momz[i] = 0;
+				precipdrops.z[i] = precipdrops.floorz[i];
+				P_SetPrecipState(i, S_SPLASH1);
+			}
 		}
 	}
-	// Precipmobjs can't use P_IsObjectOnGround
-	else if (mobj->z <= mobj->floorz && mobj->momz)
+}
+
+//
+// P_RunPrecipitation
+//
+// Moves every drop, a sector at a time.
+//
+void P_RunPrecipitation(void)
+{
+	size_t i;
+
+	if (!precipdrops.block || precipdrops.hidden)
+		return;
+
+	if (P_FreezeObjectplace())
+		return;
+
+	for (i = 0; i < numsectors; i++)
 	{
-		// No splashes on sky or bottomless pits
-		if (mobj->z <= mobj->subsector->sector->floorheight
-			&& (GETSECSPECIAL(mobj->subsector->sector->special, 1) == 7 || GETSECSPECIAL(mobj->subsector->sector->special, 1) == 6
-			|| mobj->subsector->sector->floorpic == skyflatnum))
-			mobj->z = mobj->subsector->sector->ceilingheight;
+		if (!sectors[i].numprecip)
+			continue;
+
+		if (precipdrops.kind == PRECIP_SNOW)
+			P_SnowFall(&sectors[i]);
 		else
+			P_RainFall(&sectors[i]);
+	}
+}
+
+// Random snowflake state, some flakes are smaller than others
+static statenum_t P_RandomSnowState(void)
+{
+	const byte z = M_Random(); // Doesn't need to use P_Random().
+
+	if (z < 64)
+		return S_SNOW3;
+	else if (z < 144)
+		return S_SNOW2;
+	return mobjinfo[MT_SNOWFLAKE].spawnstate;
+}
+
+//
+// P_SetPrecipitationKind
+//
+// Turns the drops there are into rain or snow, or hides them
+// (PRECIP_BLANK), so changing the weather doesn't have to spawn them again.
+//
+void P_SetPrecipitationKind(int kind)
+{
+	size_t i;
+
+	if (!precipdrops.block)
+		return;
+
+	if (kind != PRECIP_RAIN && kind != PRECIP_SNOW)
+	{
+		precipdrops.hidden = true;
+		return;
+	}
+
+	for (i = 0; i < precipdrops.num; i++)
+	{
+		if (kind == PRECIP_RAIN)
 		{
-			mobj->momz = 0;
-			mobj->z = mobj->floorz;
-			P_SetPrecipMobjState(mobj, S_SPLASH1);
+			P_SetPrecipState(i, mobjinfo[MT_RAIN].spawnstate);
+			precipdrops.momz[i] = mobjinfo[MT_RAIN].speed/NEWTICRATERATIO;
+		}
+		else
+		{
+			P_SetPrecipState(i, P_RandomSnowState());
+			precipdrops.momz[i] = mobjinfo[MT_SNOWFLAKE].speed/NEWTICRATERATIO;
 		}
 	}
 
-	return;
+	precipdrops.kind = kind;
+	precipdrops.hidden = false;
+}
+
+void P_ClearPrecipitation(void)
+{
+	size_t i;
+
+	if (precipdrops.block)
+		Z_Free(precipdrops.block);
+	memset(&precipdrops, 0, sizeof (precipdrops));
+
+	for (i = 0; i < numsectors; i++)
+		sectors[i].firstprecip = sectors[i].numprecip = 0;
 }
 
 static void P_RingThinker(mobj_t *mobj)
@@ -4268,7 +4347,7 @@ static void P_Boss3Thinker(mobj_t *mobj)
 		// scan the thinkers
 		// to find a point that matches
 		// the number
-		for (th = thinkercap.next; th != &thinkercap; th = th->next)
+		for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 		{
 			if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 				continue;
@@ -4625,7 +4704,7 @@ static void P_Boss7Thinker(mobj_t *mobj)
 
 		// scan the remaining thinkers to see
 		// if all bosses are dead
-		for (th = thinkercap.next; th != &thinkercap; th = th->next)
+		for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 		{
 			if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 				continue;
@@ -4945,7 +5024,7 @@ RetryAttack:
 				closestdist = 16384*FRACUNIT; // Just in case...
 
 				// Find waypoint he is closest to
-				for (th = thinkercap.next; th != &thinkercap; th = th->next)
+				for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 				{
 					if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 						continue;
@@ -4997,7 +5076,7 @@ RetryAttack:
 
 		// scan the thinkers to find
 		// the waypoint to use
-		for (th = thinkercap.next; th != &thinkercap; th = th->next)
+		for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 		{
 			if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 				continue;
@@ -5172,7 +5251,7 @@ mobj_t *P_GetClosestAxis(mobj_t *source)
 	fixed_t dist1, dist2 = 0;
 
 	// scan the thinkers to find the closest axis point
-	for (th = thinkercap.next; th != &thinkercap; th = th->next)
+	for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 	{
 		if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 			continue;
@@ -5495,6 +5574,9 @@ void P_SetScale(mobj_t *mobj, USHORT newscale)
 
 	mobj->radius = (fixed_t)FIXEDSCALE(mobj->info->radius, newscale);
 	mobj->height = (fixed_t)FIXEDSCALE(mobj->info->height, newscale);
+#ifdef THINGGRID
+	P_UpdateThingGrid(mobj);
+#endif
 
 	player = mobj->player;
 
@@ -5545,7 +5627,7 @@ static boolean P_BossDoesntExist(void)
 	mobj_t *mo2;
 
 	// scan the thinkers
-	for (th = thinkercap.next; th != &thinkercap; th = th->next)
+	for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 	{
 		if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 			continue;
@@ -5706,6 +5788,9 @@ void P_MobjThinker(mobj_t *mobj)
 	if (!mobj)
 		return;
 
+	// MF_ENEMY or health may have been changed directly since last tic
+	P_UpdateSectorEnemies(mobj);
+
 	// NOTE: MF_NOTHINK will only occur here if a mobj's MF_NOTHINK flag
 	// is changed after it was spawned
 	if (mobj->flags & MF_NOTHINK)
@@ -7747,7 +7832,7 @@ mobj_t *P_SpawnMobj(fixed_t x, fixed_t y, fixed_t z, mobjtype_t type) // TODO: M
 	state_t *st;
 	mobj_t *mobj = NULL;
 
-	mobj = Z_Calloc(sizeof(*mobj), PU_LEVEL, NULL);
+	mobj = Z_PoolCalloc(mobjpool);
 
 	mobj->type = type;
 	mobj->info = info;
@@ -7979,7 +8064,7 @@ mobj_t *P_SpawnMobj(fixed_t x, fixed_t y, fixed_t z, mobjtype_t type) // TODO: M
 
 	// Kalaron: Always add a thinker, even if the mobj has MF_NOTHINK
 	mobj->thinker.function.acp1 = (actionf_p1)P_MobjThinker;
-	P_AddThinker(&mobj->thinker);
+	P_AddThinker(THINK_MOBJ, &mobj->thinker);
 
 	// Call action functions when the state is set
 	if (st->action.acp1 && (mobj->flags & MF_RUNSPAWNFUNC))
@@ -7996,7 +8081,8 @@ mobj_t *P_SpawnMobj(fixed_t x, fixed_t y, fixed_t z, mobjtype_t type) // TODO: M
 		{
 			var1 = st->var1;
 			var2 = st->var2;
-			st->action.acp1(mobj);
+			P_RunStateAction(st->action.acp1, mobj);
+			P_UpdateSectorEnemies(mobj);
 		}
 	}
 
@@ -8006,100 +8092,6 @@ mobj_t *P_SpawnMobj(fixed_t x, fixed_t y, fixed_t z, mobjtype_t type) // TODO: M
 	return mobj;
 }
 
-static inline precipmobj_t *P_SpawnRainMobj(fixed_t x, fixed_t y, fixed_t z, mobjtype_t type)
-{
-	state_t *st;
-	// PU_LEVEL is more effecient than a manual calloc since the mobj cannot be freed until the level ends
-	precipmobj_t *mobj = Z_Calloc(sizeof (*mobj), PU_LEVEL, NULL);
-
-	mobj->x = x;
-	mobj->y = y;
-	mobj->flags = mobjinfo[type].flags;
-
-	// Do not set the state with P_SetMobjState,
-	// because action routines can not be called yet
-	st = &states[mobjinfo[type].spawnstate];
-
-	mobj->state = st;
-	mobj->tics = st->tics;
-	mobj->sprite = st->sprite;
-	mobj->frame = st->frame; // FF_FRAMEMASK for frame, and other bits..
-
-	// set subsector and/or block links
-	P_SetPrecipitationThingPosition(mobj);
-
-	fixed_t mfloorz;
-	fixed_t mceilingz;
-	mfloorz = R_PointInSubsector(x, y)->sector->floorheight;
-	mceilingz = R_PointInSubsector(x, y)->sector->ceilingheight;
-#ifdef ESLOPE
-	if (R_PointInSubsector(x, y)->sector->f_slope)
-		mfloorz = P_GetZAt(R_PointInSubsector(x, y)->sector->f_slope, x, y);
-	if (R_PointInSubsector(x, y)->sector->c_slope)
-		mceilingz = P_GetZAt(R_PointInSubsector(x, y)->sector->c_slope, x, y);
-#endif
-
-	mobj->floorz = mfloorz;
-	mobj->ceilingz = mceilingz;
-
-	mobj->z = z;
-	mobj->momz = mobjinfo[type].speed/NEWTICRATERATIO;
-
-	mobj->thinker.function.acp1 = (actionf_p1)P_RainThinker;
-	P_AddThinker(&mobj->thinker);
-
-	CalculatePrecipFloor(mobj);
-
-	return mobj;
-}
-
-static precipmobj_t *P_SpawnSnowMobj(fixed_t x, fixed_t y, fixed_t z, mobjtype_t type)
-{
-	state_t *st;
-	// PU_LEVEL is more effecient than a manual calloc since the mobj cannot be freed until the level ends
-	precipmobj_t *mobj = Z_Calloc(sizeof (*mobj), PU_LEVEL, NULL);
-
-	mobj->x = x;
-	mobj->y = y;
-	mobj->flags = mobjinfo[type].flags;
-
-	// Do not set the state with P_SetMobjState,
-	// because action routines can not be called yet
-	st = &states[mobjinfo[type].spawnstate];
-
-	mobj->state = st;
-	mobj->tics = st->tics;
-	mobj->sprite = st->sprite;
-	mobj->frame = st->frame; // FF_FRAMEMASK for frame, and other bits..
-
-	// set subsector and/or block links
-	P_SetPrecipitationThingPosition(mobj);
-
-	fixed_t mfloorz;
-	fixed_t mceilingz;
-	mfloorz = R_PointInSubsector(x, y)->sector->floorheight;
-	mceilingz = R_PointInSubsector(x, y)->sector->ceilingheight;
-#ifdef ESLOPE
-	if (R_PointInSubsector(x, y)->sector->f_slope)
-		mfloorz = P_GetZAt(R_PointInSubsector(x, y)->sector->f_slope, x, y);
-	if (R_PointInSubsector(x, y)->sector->c_slope)
-		mceilingz = P_GetZAt(R_PointInSubsector(x, y)->sector->c_slope, x, y);
-#endif
-
-	mobj->floorz = mfloorz;
-	mobj->ceilingz = mceilingz;
-
-	mobj->z = z;
-	mobj->momz = mobjinfo[type].speed/NEWTICRATERATIO;
-
-	mobj->thinker.function.acp1 = (actionf_p1)P_SnowThinker;
-	P_AddThinker(&mobj->thinker);
-
-	CalculatePrecipFloor(mobj);
-
-	return mobj;
-}
-
 //
 // P_RemoveMobj
 //
@@ -8166,21 +8158,6 @@ void P_RemoveMobj(mobj_t *mobj)
 	P_RemoveThinker((thinker_t *)mobj);
 }
 
-void P_RemovePrecipMobj(precipmobj_t *mobj)
-{
-	// unlink from sector and block lists
-	P_UnsetPrecipThingPosition(mobj);
-
-	if (precipsector_list)
-	{
-		P_DelPrecipSeclist(precipsector_list);
-		precipsector_list = NULL;
-	}
-
-	// free block
-	P_RemoveThinker((thinker_t *)mobj);
-}
-
 // Clearing out stuff for savegames
 void P_RemoveSavegameMobj(mobj_t *mobj)
 {
@@ -8206,7 +8183,7 @@ boolean P_CheckSameMobjAtPos(mobjtype_t type, fixed_t x, fixed_t y, fixed_t z, b
 {
 	thinker_t *th;
 
-	for (th = thinkercap.next; th != &thinkercap; th = th->next)
+	for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 	{
 		if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 			continue;
@@ -8248,14 +8225,13 @@ static CV_PossibleValue_t flagtime_cons_t[] = {{0, "MIN"}, {300, "MAX"}, {0, NUL
 consvar_t cv_flagtime = {"flagtime", "30", CV_NETVAR, flagtime_cons_t, NULL, 0, NULL, NULL, 0, 0, NULL};
 consvar_t cv_suddendeath = {"suddendeath", "Off", CV_NETVAR, CV_OnOff, NULL, 0, NULL, NULL, 0, 0, NULL};
 
-static fixed_t P_Rand(void)
+// A number from 0 up to but not including 1, for placing precipitation.
+// Two calls to rand() are used because Windows' RAND_MAX is only 0x7FFF.
+static double P_PrecipRand(void)
 {
-	// Do not use RAND_MAX, it equals 0x7fffffff(2147483647) on some OS's,
-	// but may equal 0x7FFF(32767) under Window's rand(), this difference may cause undesired operation,
-	// so just use Window's random // SRB2CBTODO: Use this for any other differences
-	const unsigned int d = (unsigned int)rand()*FRACUNIT;
-	const fixed_t t = (fixed_t)(d/0x7FFF);
-	return (t-FRACUNIT/2)<<FRACBITS;
+	const double range = (double)RAND_MAX + 1.0;
+	const int hi = rand(), lo = rand();
+	return (hi * range + lo) / (range * range);
 }
 
 static boolean P_ObjectInWater(sector_t *sector, fixed_t z)
@@ -8591,19 +8567,160 @@ mobj_t *P_SpawnGhostMobjXYZ(mobj_t *mobj, fixed_t x, fixed_t y, fixed_t z)
 	return ghost;
 }
 
-void P_SpawnPrecipitation(void)
+//
+// Precipitation placement
+//
+// Drops used to be placed by throwing 8M random points at the whole
+// 65536 unit cube the map lives in and keeping the ones that landed in
+// open air under a sky. Instead, only the bounding box of each sector
+// that can hold drops is probed, at the same density, and a probe is
+// kept when the BSP puts it in that sector. Every point of open air is
+// still probed equally often, without walking the BSP for all the
+// empty space around the map.
+//
+#define PRECIPVOLUMEPERDROP 33554432.0 // cube volume / probes, in map units
+#define PRECIPUNITS(x) ((double)(x) / FRACUNIT)
+
+typedef struct
 {
-	const int preloop = 1048576*8; // 0x100000 * 12
-	int i;
-	fixed_t x = 0, y = 0, height;
-	subsector_t *precipsector = NULL;
+	fixed_t x, y, z;
+	sector_t *sector;
+} precipplace_t;
+
+// Replaces the drops there are with new ones at the places given,
+// grouping them by sector
+static void P_StorePrecipitation(const precipplace_t *places, size_t num, boolean snow)
+{
+	const size_t dropsize = 5*sizeof (fixed_t) + sizeof (int) + sizeof (statenum_t);
+	size_t i, first = 0;
+
+	P_ClearPrecipitation();
 
+	if (!num)
+		return;
+
+	// Count the drops in each sector to find where each sector's drops start
+	for (i = 0; i < num; i++)
+		places[i].sector->numprecip++;
+	for (i = 0; i < numsectors; i++)
+	{
+		sectors[i].firstprecip = first;
+		first += sectors[i].numprecip;
+		sectors[i].numprecip = 0;
+	}
+
+	Z_Malloc(num * dropsize, PU_LEVEL, &precipdrops.block);
+	precipdrops.x = precipdrops.block;
+	precipdrops.y = precipdrops.x + num;
+	precipdrops.z = precipdrops.y + num;
+	precipdrops.floorz = precipdrops.z + num;
+	precipdrops.momz = precipdrops.floorz + num;
+	precipdrops.tics = (int *)(precipdrops.momz + num);
+	precipdrops.state = (statenum_t *)(precipdrops.tics + num);
+	precipdrops.num = num;
+	precipdrops.kind = snow ? PRECIP_SNOW : PRECIP_RAIN;
+	precipdrops.hidden = false;
+
+	for (i = 0; i < num; i++)
+	{
+		sector_t *sec = places[i].sector;
+		const size_t j = sec->firstprecip + sec->numprecip++;
+		const mobjtype_t type = snow ? MT_SNOWFLAKE : MT_RAIN;
+
+		precipdrops.x[j] = places[i].x;
+		precipdrops.y[j] = places[i].y;
+		precipdrops.z[j] = places[i].z;
+		precipdrops.floorz[j] = P_PrecipFloor(sec, places[i].x, places[i].y);
+		precipdrops.momz[j] = mobjinfo[type].speed/NEWTICRATERATIO;
+		P_SetPrecipState(j, snow ? P_RandomSnowState() : mobjinfo[type].spawnstate);
+	}
+}
+
+static void P_PlacePrecipitation(boolean snow)
+{
+	precipplace_t *places = NULL;
+	size_t numplaces = 0, maxplaces = 0, probes, i, j;
+	fixed_t left, right, bottom, top, x, y, height;
+	subsector_t *ss;
+	double volume;
+
+	for (i = 0; i < numsectors; i++)
+	{
+		sector_t *sec = &sectors[i];
+
+		if (!(i % 256))
+			P_LoadingScreen("Precipitation", (short)((i*100)/numsectors));
+
+		if (snow)
+		{
+			if (!(maptol & TOL_NIGHTS) && sec->ceilingpic != skyflatnum)
+				continue;
+
+			if (sec->floorheight > sec->ceilingheight - (32<<FRACBITS))
+				continue;
+		}
+		else if (sec->ceilingpic != skyflatnum || sec->floorheight >= sec->ceilingheight)
+			continue;
+
+		if (!sec->linecount)
+			continue;
+
+		// The sector's bounding box, from its lines
+		left = right = sec->lines[0]->v1->x;
+		bottom = top = sec->lines[0]->v1->y;
+		for (j = 0; j < sec->linecount; j++)
+		{
+			const line_t *ld = sec->lines[j];
+			left = min(left, min(ld->v1->x, ld->v2->x));
+			right = max(right, max(ld->v1->x, ld->v2->x));
+			bottom = min(bottom, min(ld->v1->y, ld->v2->y));
+			top = max(top, max(ld->v1->y, ld->v2->y));
+		}
+
+		volume = (PRECIPUNITS(right) - PRECIPUNITS(left)) * (PRECIPUNITS(top) - PRECIPUNITS(bottom))
+			* (PRECIPUNITS(sec->ceilingheight) - PRECIPUNITS(sec->floorheight));
+		probes = (size_t)(volume / PRECIPVOLUMEPERDROP + P_PrecipRand());
+
+		for (j = 0; j < probes; j++)
+		{
+			x = left + (fixed_t)(P_PrecipRand() * ((double)right - left));
+			y = bottom + (fixed_t)(P_PrecipRand() * ((double)top - bottom));
+
+			// the box covers other sectors too, and the void between them
+			ss = R_IsPointInSubsector(x, y);
+			if (!ss || ss->sector != sec)
+				continue;
+
+			height = sec->floorheight + (fixed_t)(P_PrecipRand() * ((double)sec->ceilingheight - sec->floorheight));
+			if (P_ObjectInWater(sec, height))
+				continue;
+
+			if (numplaces == maxplaces)
+			{
+				maxplaces = maxplaces ? maxplaces*2 : 1024;
+				places = realloc(places, maxplaces * sizeof (*places));
+				if (!places)
+					I_Error("Out of Memory in P_PlacePrecipitation");
+			}
+
+			places[numplaces].x = x;
+			places[numplaces].y = y;
+			places[numplaces].z = height;
+			places[numplaces].sector = sec;
+			numplaces++;
+		}
+	}
+
+	P_StorePrecipitation(places, numplaces, snow);
+	free(places);
+}
+
+void P_SpawnPrecipitation(void)
+{
 	if (dedicated) return;
 
 	if (curWeather == PRECIP_SNOW)
 	{
-		byte z = 0;
-
 		if (rendermode != render_none)
 		{
 			if (gamestate != wipegamestate)
@@ -8630,41 +8747,7 @@ void P_SpawnPrecipitation(void)
 			}
 		}
 
-		for (i = 0; i < preloop; i++)
-		{
-			x = P_Rand();
-			y = P_Rand();
-			height = P_Rand();
-
-			precipsector = R_IsPointInSubsector(x, y);
-
-			if (!precipsector)
-				continue;
-
-			if (!(maptol & TOL_NIGHTS) && !(precipsector->sector->ceilingpic == skyflatnum))
-				continue;
-
-			if (!(precipsector->sector->floorheight <= precipsector->sector->ceilingheight - (32<<FRACBITS)))
-				continue;
-
-			if (height < precipsector->sector->floorheight ||
-				height >= precipsector->sector->ceilingheight)
-				continue;
-
-			if (P_ObjectInWater(precipsector->sector, height))
-				continue;
-
-			if (!(i % 1000) || !i)
-				P_LoadingScreen("Precipitation", ((i*100)/preloop));
-
-			z = M_Random(); // Doesn't need to use P_Random().
-			if (z < 64)
-				P_SetPrecipMobjState(P_SpawnSnowMobj(x, y, height, MT_SNOWFLAKE), S_SNOW3);
-			else if (z < 144)
-				P_SetPrecipMobjState(P_SpawnSnowMobj(x, y, height, MT_SNOWFLAKE), S_SNOW2);
-			else
-				P_SpawnSnowMobj(x, y, height, MT_SNOWFLAKE);
-		}
+		P_PlacePrecipitation(true);
 	}
 	else if (curWeather == PRECIP_STORM || curWeather == PRECIP_RAIN || curWeather == PRECIP_BLANK
 		|| curWeather == PRECIP_STORM_NORAIN || curWeather == PRECIP_STORM_NOSTRIKES)
@@ -8692,33 +8775,7 @@ void P_SpawnPrecipitation(void)
 			WipeInAction = false;
 		}
 
-		for (i = 0; i < preloop; i++)
-		{
-			x = P_Rand();
-			y = P_Rand();
-			height = P_Rand();
-
-			precipsector = R_IsPointInSubsector(x, y);
-
-			if (!precipsector)
-				continue;
-
-			if (!(precipsector->sector->ceilingpic == skyflatnum
-				  && precipsector->sector->floorheight < precipsector->sector->ceilingheight))
-				continue;
-
-			if (height < precipsector->sector->floorheight ||
-					height >= precipsector->sector->ceilingheight)
-				continue;
-
-			if (P_ObjectInWater(precipsector->sector, height))
-				continue;
-
-			if (!(i % 1000) || !i)
-				P_LoadingScreen("Precipitation", ((i*100)/preloop));
-
-			P_SpawnRainMobj(x, y, height, MT_RAIN);
-		}
+		P_PlacePrecipitation(false);
 	}
 
 	if (curWeather == PRECIP_BLANK)
@@ -9758,7 +9815,12 @@ ML_NOCLIMB : Direction not controllable
 				mobj->flags |= MF_AMBUSH;
 
 			if (mthing->angle > 0)
+			{
 				mobj->radius = (mthing->angle & 16383)*FRACUNIT;
+#ifdef THINGGRID
+				P_UpdateThingGrid(mobj);
+#endif
+			}
 		}
 	}
 	else if (i == MT_EMMY)
@@ -9802,7 +9864,7 @@ ML_NOCLIMB : Direction not controllable
 		}
 
 		// See if other starposts exist in this level that have the same value.
-		for (th = thinkercap.next; th != &thinkercap; th = th->next)
+		for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 		{
 			if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 				continue;
@@ -285,6 +285,10 @@ typedef struct mobj_s
 	// Links in blocks (if needed).
 	struct mobj_s *bnext;
 	struct mobj_s **bprev;
+#ifdef THINGGRID
+	struct mobj_s *gnext; // links in the thing grid, see P_ThingsInBoxIterator
+	struct mobj_s **gprev;
+#endif
 
 	// Additional pointers for NiGHTS hoops
 	struct mobj_s *hnext;
@@ -350,47 +354,27 @@ typedef struct mobj_s
 //
 // For precipitation
 //
-// Sometimes this is casted to a mobj_t,
-// so please keep the start of the
-// structure the same.
+// Drops aren't thinkers; they are kept in arrays grouped by the sector
+// they're in, from firstprecip to firstprecip+numprecip-1 in sector_t.
+// Drops never move sideways, so they stay in the same place in the arrays
+// for the whole level. Every drop has the same radius (2*FRACUNIT)
+// and height (4*FRACUNIT).
 //
-typedef struct precipmobj_s
+typedef struct
 {
-	// List: thinker links.
-	thinker_t thinker;
-
-	// Info for drawing: position.
-	fixed_t x, y, z;
-
-	// More list: links in sector (if needed)
-	struct precipmobj_s *snext;
-	struct precipmobj_s **sprev; // killough 8/11/98: change to ptr-to-ptr
-
-	// More drawing info: to determine current sprite.
-	angle_t angle;  // orientation
-	spritenum_t sprite; // used to find patch_t and flip value
-	int frame; // frame number, plus bits see p_pspr.h
+	fixed_t *x, *y, *z;
+	fixed_t *floorz; // Where the drop lands.
+	fixed_t *momz;
+	int *tics; // state tic counter
+	statenum_t *state;
 
-	struct mprecipsecnode_s *touching_sectorlist; // a linked list of sectors where this object appears
+	size_t num;
+	int kind; // PRECIP_RAIN or PRECIP_SNOW
+	boolean hidden; // Not updated or drawn, but kept to be reused.
+	void *block; // All the arrays, PU_LEVEL; NULL if there are no drops.
+} precipdrops_t;
 
-	struct subsector_s *subsector; // Subsector the mobj resides in.
-
-	// The closest interval over all contacted sectors (or things).
-	fixed_t floorz; // Nearest floor below.
-	fixed_t ceilingz; // Nearest ceiling above.
-
-	// For movement checking.
-	fixed_t radius; // Fixed at 2*FRACUNIT
-	fixed_t height; // Fixed at 4*FRACUNIT
-
-	// Momentums, used to update position.
-	fixed_t momx, momy, momz;
-	fixed_t invisible; // fixed_t so it uses the same spot as "pmomz."
-
-	int tics; // state tic counter
-	state_t *state;
-	int flags; // flags from mobjinfo tables
-} precipmobj_t;
+extern precipdrops_t precipdrops;
 
 typedef struct actioncache_s
 {
@@ -422,10 +406,9 @@ void P_SpawnParaloop(fixed_t x, fixed_t y, fixed_t z, fixed_t radius, int number
 					 mobjtype_t type, angle_t rotangle, boolean spawncenter, boolean ghostit);
 boolean P_SupermanLook4Players(mobj_t *actor);
 void P_DestroyRobots(void);
-void P_SnowThinker(precipmobj_t *mobj);
-void P_RainThinker(precipmobj_t *mobj);
-void P_NullPrecipThinker(precipmobj_t *mobj);
-void P_RemovePrecipMobj(precipmobj_t *mobj);
+void P_RunPrecipitation(void);
+void P_SetPrecipitationKind(int kind);
+void P_ClearPrecipitation(void);
 void P_SetScale(mobj_t *mobj, USHORT newscale);
 fixed_t P_ScaleMomentum(fixed_t momentum, USHORT scale);
 void P_XYMovement(mobj_t *mo);
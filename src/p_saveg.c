@@ -887,7 +887,7 @@ static void P_NetArchiveThinkers(void)
 	ULONG diff;
 
 	// save off the current thinkers
-	for (th = thinkercap.next; th != &thinkercap; th = th->next)
+	for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 	{
 		if (th->function.acp1 == (actionf_p1)P_MobjThinker)
 		{
@@ -1101,10 +1101,6 @@ static void P_NetArchiveThinkers(void)
 
 			WRITEULONG(save_p, mobj->mobjnum);
 		}
-#ifdef PARANOIA
-		else if (th->function.acp1 == (actionf_p1)P_RainThinker
-			|| th->function.acp1 == (actionf_p1)P_SnowThinker);
-#endif
 		else if (th->function.acp1 == (actionf_p1)T_MoveCeiling)
 		{
 			ceiling_t *ceiling;
@@ -1370,7 +1366,7 @@ static mobj_t *FindNewPosition(ULONG oldposition)
 	thinker_t *th;
 	mobj_t *mobj;
 
-	for (th = thinkercap.next; th != &thinkercap; th = th->next)
+	for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 	{
 		if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 			continue;
@@ -1398,7 +1394,7 @@ static mobj_t *FindNewPosition(ULONG oldposition)
 //
 static void LoadSpecialLevelThinker(int floorOrCeiling, actionf_p1 thinker)
 {
-	levelspecthink_t *specthinker = M_Memcpy(Z_Malloc(sizeof (*specthinker), PU_LEVEL, NULL), save_p, sizeof (levelspecthink_t));
+	levelspecthink_t *specthinker = M_Memcpy(Z_PoolCalloc(levspecpool), save_p, sizeof (levelspecthink_t));
 	save_p += sizeof (levelspecthink_t);
 	specthinker->sector = &sectors[(size_t)specthinker->sector];
 	specthinker->sourceline = &lines[(size_t)specthinker->sourceline];
@@ -1411,7 +1407,7 @@ static void LoadSpecialLevelThinker(int floorOrCeiling, actionf_p1 thinker)
 		specthinker->sector->floordata = specthinker;
 
 	specthinker->thinker.function.acp1 = thinker;
-	P_AddThinker(&specthinker->thinker);
+	P_AddThinker(THINK_SPECIAL, &specthinker->thinker);
 }
 
 //
@@ -1474,13 +1470,13 @@ static void P_NetUnArchiveThinkers(void)
 						continue;
 					}
 
-					mobj = Z_Calloc(sizeof (*mobj), PU_LEVEL, NULL);
+					mobj = Z_PoolCalloc(mobjpool);
 
 					mobj->spawnpoint = &mapthings[spawnpointnum];
 					mapthings[spawnpointnum].mobj = mobj;
 				}
 				else
-					mobj = Z_Calloc(sizeof (*mobj), PU_LEVEL, NULL);
+					mobj = Z_PoolCalloc(mobjpool);
 
 				mobj->z = z;
 				mobj->floorz = floorz;
@@ -1661,7 +1657,7 @@ static void P_NetUnArchiveThinkers(void)
 				}
 
 				mobj->thinker.function.acp1 = (actionf_p1)P_MobjThinker;
-				P_AddThinker(&mobj->thinker);
+				P_AddThinker(THINK_MOBJ, &mobj->thinker);
 
 				mobj->info = (mobjinfo_t *)next; // temporarily, set when leave this function
 				break;
@@ -1676,7 +1672,7 @@ static void P_NetUnArchiveThinkers(void)
 					if (ceiling->thinker.function.acp1)
 						ceiling->thinker.function.acp1 = (actionf_p1)T_MoveCeiling;
 
-					P_AddThinker(&ceiling->thinker);
+					P_AddThinker(THINK_SPECIAL, &ceiling->thinker);
 				}
 				break;
 
@@ -1690,7 +1686,7 @@ static void P_NetUnArchiveThinkers(void)
 					if (ceiling->thinker.function.acp1)
 						ceiling->thinker.function.acp1 = (actionf_p1)T_CrushCeiling;
 
-					P_AddThinker(&ceiling->thinker);
+					P_AddThinker(THINK_SPECIAL, &ceiling->thinker);
 				}
 				break;
 
@@ -1701,7 +1697,7 @@ static void P_NetUnArchiveThinkers(void)
 					loadfloor->sector = &sectors[(size_t)loadfloor->sector];
 					loadfloor->sector->floordata = loadfloor;
 					loadfloor->thinker.function.acp1 = (actionf_p1)T_MoveFloor;
-					P_AddThinker(&loadfloor->thinker);
+					P_AddThinker(THINK_SPECIAL, &loadfloor->thinker);
 				}
 				break;
 
@@ -1712,7 +1708,7 @@ static void P_NetUnArchiveThinkers(void)
 					flash->sector = &sectors[(size_t)flash->sector];
 					flash->sector->lightingdata = flash;
 					flash->thinker.function.acp1 = (actionf_p1)T_LightningFlash;
-					P_AddThinker(&flash->thinker);
+					P_AddThinker(THINK_LIGHT, &flash->thinker);
 				}
 				break;
 
@@ -1723,7 +1719,7 @@ static void P_NetUnArchiveThinkers(void)
 					strobe->sector = &sectors[(size_t)strobe->sector];
 					strobe->sector->lightingdata = strobe;
 					strobe->thinker.function.acp1 = (actionf_p1)T_StrobeFlash;
-					P_AddThinker(&strobe->thinker);
+					P_AddThinker(THINK_LIGHT, &strobe->thinker);
 				}
 				break;
 
@@ -1734,7 +1730,7 @@ static void P_NetUnArchiveThinkers(void)
 					glow->sector = &sectors[(size_t)glow->sector];
 					glow->sector->lightingdata = glow;
 					glow->thinker.function.acp1 = (actionf_p1)T_Glow;
-					P_AddThinker(&glow->thinker);
+					P_AddThinker(THINK_LIGHT, &glow->thinker);
 				}
 				break;
 
@@ -1745,7 +1741,7 @@ static void P_NetUnArchiveThinkers(void)
 					ff->sector = &sectors[(size_t)ff->sector];
 					ff->sector->lightingdata = ff;
 					ff->thinker.function.acp1 = (actionf_p1)T_FireFlicker;
-					P_AddThinker(&ff->thinker);
+					P_AddThinker(THINK_LIGHT, &ff->thinker);
 				}
 				break;
 
@@ -1758,7 +1754,7 @@ static void P_NetUnArchiveThinkers(void)
 					elevator->sector->ceilingdata = elevator;
 					elevator->sourceline = &lines[(size_t)elevator->sourceline];
 					elevator->thinker.function.acp1 = (actionf_p1)T_MoveElevator;
-					P_AddThinker(&elevator->thinker);
+					P_AddThinker(THINK_SPECIAL, &elevator->thinker);
 				}
 				break;
 
@@ -1795,7 +1791,7 @@ static void P_NetUnArchiveThinkers(void)
 					elevator->sector = &sectors[(size_t)elevator->sector];
 					elevator->actionsector = &sectors[(size_t)elevator->actionsector];
 					elevator->thinker.function.acp1 = (actionf_p1)T_CameraScanner;
-					P_AddThinker(&elevator->thinker);
+					P_AddThinker(THINK_SPECIAL, &elevator->thinker);
 				}
 				break;
 
@@ -1811,7 +1807,7 @@ static void P_NetUnArchiveThinkers(void)
 					elevator->sourceline = &lines[(size_t)elevator->sourceline];
 					elevator->sector->floordata = elevator;
 					elevator->thinker.function.acp1 = (actionf_p1)T_StartCrumble;
-					P_AddThinker(&elevator->thinker);
+					P_AddThinker(THINK_SPECIAL, &elevator->thinker);
 				}
 				break;
 
@@ -1840,7 +1836,7 @@ static void P_NetUnArchiveThinkers(void)
 					laser->ffloor = &(laser->sector->ffloors)[(size_t)laser->ffloor];
 					laser->sourceline = &lines[(size_t)laser->sourceline];
 					laser->thinker.function.acp1 = (actionf_p1)T_LaserFlash;
-					P_AddThinker(&laser->thinker);
+					P_AddThinker(THINK_SPECIAL, &laser->thinker);
 				}
 				break;
 
@@ -1851,7 +1847,7 @@ static void P_NetUnArchiveThinkers(void)
 					ll->sector = &sectors[(size_t)ll->sector];
 					ll->sector->lightingdata = ll;
 					ll->thinker.function.acp1 = (actionf_p1)T_LightFade;
-					P_AddThinker(&ll->thinker);
+					P_AddThinker(THINK_LIGHT, &ll->thinker);
 				}
 				break;
 
@@ -1863,7 +1859,7 @@ static void P_NetUnArchiveThinkers(void)
 					restoreNum = true;
 //					e->caller = FindNewPosition((size_t)e->caller); // Restored further down
 					e->thinker.function.acp1 = (actionf_p1)T_ExecutorDelay;
-					P_AddThinker(&e->thinker);
+					P_AddThinker(THINK_SPECIAL, &e->thinker);
 				}
 				break;
 
@@ -1872,7 +1868,7 @@ static void P_NetUnArchiveThinkers(void)
 					disappear_t *disappear = M_Memcpy(Z_Malloc(sizeof (*disappear), PU_LEVEL, NULL), save_p, sizeof (disappear_t));
 					save_p += sizeof (disappear_t);
 					disappear->thinker.function.acp1 = (actionf_p1)T_Disappear;
-					P_AddThinker(&disappear->thinker);
+					P_AddThinker(THINK_SPECIAL, &disappear->thinker);
 				}
 				break;
 #ifdef POLYOBJECTS
@@ -1881,7 +1877,7 @@ static void P_NetUnArchiveThinkers(void)
 					polyrotate_t *polyrot = M_Memcpy(Z_Malloc(sizeof (*polyrot), PU_LEVEL, NULL), save_p, sizeof (polyrotate_t));
 					save_p += sizeof (polyrotate_t);
 					polyrot->thinker.function.acp1 = (actionf_p1)T_PolyObjRotate;
-					P_AddThinker(&polyrot->thinker);
+					P_AddThinker(THINK_POLYOBJ, &polyrot->thinker);
 				}
 				break;
 
@@ -1890,7 +1886,7 @@ static void P_NetUnArchiveThinkers(void)
 					polymove_t *polymove = M_Memcpy(Z_Malloc(sizeof (*polymove), PU_LEVEL, NULL), save_p, sizeof (polymove_t));
 					save_p += sizeof (polymove_t);
 					polymove->thinker.function.acp1 = (actionf_p1)T_PolyObjMove;
-					P_AddThinker(&polymove->thinker);
+					P_AddThinker(THINK_POLYOBJ, &polymove->thinker);
 				}
 				break;
 
@@ -1899,7 +1895,7 @@ static void P_NetUnArchiveThinkers(void)
 					polywaypoint_t *polywaypoint = M_Memcpy(Z_Malloc(sizeof (*polywaypoint), PU_LEVEL, NULL), save_p, sizeof (polywaypoint_t));
 					save_p += sizeof (polywaypoint_t);
 					polywaypoint->thinker.function.acp1 = (actionf_p1)T_PolyObjWaypoint;
-					P_AddThinker(&polywaypoint->thinker);
+					P_AddThinker(THINK_POLYOBJ, &polywaypoint->thinker);
 				}
 				break;
 
@@ -1908,7 +1904,7 @@ static void P_NetUnArchiveThinkers(void)
 					polyslidedoor_t *psldoor = M_Memcpy(Z_Malloc(sizeof (*psldoor), PU_LEVEL, NULL), save_p, sizeof (polyslidedoor_t));
 					save_p += sizeof (polyslidedoor_t);
 					psldoor->thinker.function.acp1 = (actionf_p1)T_PolyDoorSlide;
-					P_AddThinker(&psldoor->thinker);
+					P_AddThinker(THINK_POLYOBJ, &psldoor->thinker);
 				}
 				break;
 
@@ -1917,7 +1913,7 @@ static void P_NetUnArchiveThinkers(void)
 					polyswingdoor_t *pswdoor = M_Memcpy(Z_Malloc(sizeof (*pswdoor), PU_LEVEL, NULL), save_p, sizeof (polyswingdoor_t));
 					save_p += sizeof (polyswingdoor_t);
 					pswdoor->thinker.function.acp1 = (actionf_p1)T_PolyDoorSwing;
-					P_AddThinker(&pswdoor->thinker);
+					P_AddThinker(THINK_POLYOBJ, &pswdoor->thinker);
 				}
 				break;
 			case tc_polyflag:
@@ -1925,7 +1921,7 @@ static void P_NetUnArchiveThinkers(void)
 					polymove_t *polyflag = M_Memcpy(Z_Malloc(sizeof (*polyflag), PU_LEVEL, NULL), save_p, sizeof (polymove_t));
 					save_p += sizeof (polymove_t);
 					polyflag->thinker.function.acp1 = (actionf_p1)T_PolyObjFlag;
-					P_AddThinker(&polyflag->thinker);
+					P_AddThinker(THINK_POLYOBJ, &polyflag->thinker);
 				}
 				break;
 #endif
@@ -1934,7 +1930,7 @@ static void P_NetUnArchiveThinkers(void)
 					scroll_t *scroll = M_Memcpy(Z_Malloc(sizeof (*scroll), PU_LEVEL, NULL), save_p, sizeof (scroll_t));
 					save_p += sizeof (scroll_t);
 					scroll->thinker.function.acp1 = (actionf_p1)T_Scroll;
-					P_AddThinker(&scroll->thinker);
+					P_AddThinker(THINK_SPECIAL, &scroll->thinker);
 				}
 				break;
 
@@ -1943,7 +1939,7 @@ static void P_NetUnArchiveThinkers(void)
 					friction_t *friction = M_Memcpy(Z_Malloc(sizeof (*friction), PU_LEVEL, NULL), save_p, sizeof (friction_t));
 					save_p += sizeof (friction_t);
 					friction->thinker.function.acp1 = (actionf_p1)T_Friction;
-					P_AddThinker(&friction->thinker);
+					P_AddThinker(THINK_SPECIAL, &friction->thinker);
 				}
 				break;
 
@@ -1953,7 +1949,7 @@ static void P_NetUnArchiveThinkers(void)
 					save_p += sizeof (pusher_t);
 					pusher->thinker.function.acp1 = (actionf_p1)T_Pusher;
 					pusher->source = P_GetPushThing(pusher->affectee);
-					P_AddThinker(&pusher->thinker);
+					P_AddThinker(THINK_SPECIAL, &pusher->thinker);
 				}
 				break;
 
@@ -1964,8 +1960,8 @@ static void P_NetUnArchiveThinkers(void)
 
 	if (restoreNum)
 	{
-		for (currentthinker = thinkercap.next; currentthinker != &thinkercap;
-			currentthinker = currentthinker->next)
+		for (currentthinker = thlist[THINK_SPECIAL].cnext; currentthinker != &thlist[THINK_SPECIAL];
+			currentthinker = currentthinker->cnext)
 		{
 			if (currentthinker->function.acp1 == (actionf_p1)T_ExecutorDelay)
 			{
@@ -2056,8 +2052,8 @@ static void P_FinishMobjs(void)
 	mobj_t *mobj;
 
 	// put info field there real value
-	for (currentthinker = thinkercap.next; currentthinker != &thinkercap;
-		currentthinker = currentthinker->next)
+	for (currentthinker = thlist[THINK_MOBJ].cnext; currentthinker != &thlist[THINK_MOBJ];
+		currentthinker = currentthinker->cnext)
 	{
 		if (currentthinker->function.acp1 == (actionf_p1)P_MobjThinker)
 		{
@@ -2074,8 +2070,8 @@ static void P_RelinkPointers(void)
 	ULONG temp;
 
 	// use info field (value = oldposition) to relink mobjs
-	for (currentthinker = thinkercap.next; currentthinker != &thinkercap;
-		currentthinker = currentthinker->next)
+	for (currentthinker = thlist[THINK_MOBJ].cnext; currentthinker != &thlist[THINK_MOBJ];
+		currentthinker = currentthinker->cnext)
 	{
 		if (currentthinker->function.acp1 == (actionf_p1)P_MobjThinker)
 		{
@@ -2414,7 +2410,7 @@ void P_SaveNetGame(void)
 	P_NetArchiveMisc();
 
 	// Assign the mobjnumber for pointer tracking
-	for (th = thinkercap.next; th != &thinkercap; th = th->next)
+	for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 	{
 		if (th->function.acp1 == (actionf_p1)P_MobjThinker)
 		{
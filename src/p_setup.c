@@ -409,9 +409,9 @@ static inline long SafeUintIndex(short input, int limit, const char *func,
  */
 static inline void P_LoadVertexes(lumpnum_t lumpnum) // SRB2CBTODO: Use Eternity's superior and simplier code!(for other things too)
 {
-	byte *data;
+	const byte *data;
 	size_t i;
-	mapvertex_t *ml;
+	const mapvertex_t *ml;
 	vertex_t *li;
 
 	// Determine number of lumps:
@@ -424,10 +424,10 @@ static inline void P_LoadVertexes(lumpnum_t lumpnum) // SRB2CBTODO: Use Eternity
 	// Allocate zone memory for buffer.
 	vertexes = Z_Calloc(numvertexes * sizeof (*vertexes), PU_LEVEL, NULL);
 
-	// Load data into cache.
-	data = W_CacheLumpNum(lumpnum, PU_STATIC);
+	// Read the data straight from the wad if it's mapped.
+	data = W_MapLumpNum(lumpnum);
 
-	ml = (mapvertex_t *)data;
+	ml = (const mapvertex_t *)data;
 	li = vertexes;
 
 	// Copy and convert vertex coordinates, internal representation as fixed.
@@ -438,7 +438,7 @@ static inline void P_LoadVertexes(lumpnum_t lumpnum) // SRB2CBTODO: Use Eternity
 	}
 
 	// Free buffer memory.
-	Z_Free(data);
+	W_UnmapLumpNum(lumpnum);
 }
 
 
@@ -450,16 +450,16 @@ static inline void P_LoadVertexes(lumpnum_t lumpnum) // SRB2CBTODO: Use Eternity
 static void P_LoadSegs(lumpnum_t lumpnum)
 {
 	size_t i;
-	byte *data;
+	const byte *data;
 
 	numsegs = W_LumpLength(lumpnum) / sizeof (mapseg_t);
 	if (numsegs <= 0)
 		I_Error("Level has no segs!"); // instead of crashing
 	segs = Z_Calloc(numsegs * sizeof (*segs), PU_LEVEL, NULL);
-	data = W_CacheLumpNum(lumpnum, PU_STATIC);
+	data = W_MapLumpNum(lumpnum);
 
 	seg_t *li = segs;
-	mapseg_t *ml = (mapseg_t *)data;
+	const mapseg_t *ml = (const mapseg_t *)data;
 
 	for (i = 0; i < numsegs; i++, li++, ml++)
 	{
@@ -496,7 +496,7 @@ static void P_LoadSegs(lumpnum_t lumpnum)
 		li->len = P_CalcSegLength(li);
 	}
 
-	Z_Free(data);
+	W_UnmapLumpNum(lumpnum);
 }
 
 /** Loads the SSECTORS resource from a level.
@@ -506,18 +506,18 @@ static void P_LoadSegs(lumpnum_t lumpnum)
   */
 static inline void P_LoadSubsectors(lumpnum_t lumpnum)
 {
-	void *data;
+	const void *data;
 	size_t i;
-	mapsubsector_t *ms;
+	const mapsubsector_t *ms;
 	subsector_t *ss;
 
 	numsubsectors = W_LumpLength(lumpnum) / sizeof (mapsubsector_t);
 	if (numsubsectors <= 0)
 		I_Error("Level has no subsectors: It may not have been run through a nodebuilder");
 	ss = subsectors = Z_Calloc(numsubsectors * sizeof (*subsectors), PU_LEVEL, NULL);
-	data = W_CacheLumpNum(lumpnum, PU_STATIC);
+	data = W_MapLumpNum(lumpnum);
 
-	ms = (mapsubsector_t *)data;
+	ms = (const mapsubsector_t *)data;
 
 	for (i = 0; i < numsubsectors; i++, ss++, ms++)
 	{
@@ -530,7 +530,7 @@ static inline void P_LoadSubsectors(lumpnum_t lumpnum)
 		ss->validcount = 0;
 	}
 
-	Z_Free(data);
+	W_UnmapLumpNum(lumpnum);
 }
 
 //
@@ -603,9 +603,9 @@ long P_AddLevelFlat(const char *flatname, levelflat_t *levelflat)
 
 static void P_LoadSectors(lumpnum_t lumpnum)
 {
-	byte *data;
+	const byte *data;
 	size_t i;
-	mapsector_t *ms;
+	const mapsector_t *ms;
 	sector_t *ss;
 	levelflat_t *foundflats;
 
@@ -613,7 +613,7 @@ static void P_LoadSectors(lumpnum_t lumpnum)
 	if (numsectors <= 0)
 		I_Error("Map Loading Error: Level has no sectors\n It may not have been run through a nodebuilder.");
 	sectors = Z_Calloc(numsectors*sizeof (*sectors), PU_LEVEL, NULL);
-	data = W_CacheLumpNum(lumpnum, PU_STATIC);
+	data = W_MapLumpNum(lumpnum);
 
 	foundflats = calloc(MAXLEVELFLATS, sizeof (*foundflats));
 	if (!foundflats)
@@ -621,7 +621,7 @@ static void P_LoadSectors(lumpnum_t lumpnum)
 
 	numlevelflats = 0;
 
-	ms = (mapsector_t *)data;
+	ms = (const mapsector_t *)data;
 	ss = sectors;
 	for (i = 0; i < numsectors; i++, ss++, ms++)
 	{
@@ -644,8 +644,8 @@ static void P_LoadSectors(lumpnum_t lumpnum)
 
 		ss->thinglist = NULL;
 		ss->touching_thinglist = NULL;
-		ss->preciplist = NULL;
-		ss->touching_preciplist = NULL;
+		ss->firstprecip = ss->numprecip = 0;
+		ss->numenemies = ss->numplayers = 0;
 
 		ss->floordata = NULL;
 		ss->ceilingdata = NULL;
@@ -688,7 +688,7 @@ static void P_LoadSectors(lumpnum_t lumpnum)
 #endif
 	}
 
-	Z_Free(data);
+	W_UnmapLumpNum(lumpnum);
 
 	// set the sky flat num
 	skyflatnum = P_AddLevelFlat("F_SKY1", foundflats);
@@ -708,7 +708,7 @@ static void P_LoadSectors(lumpnum_t lumpnum)
 // ignore this lump and completely reimplement!
 static void P_LoadNodes(lumpnum_t lumpnum)
 {
-	byte *data;
+	const byte *data;
 	size_t i;
 
 	numnodes = W_LumpLength(lumpnum) / sizeof (mapnode_t);
@@ -716,13 +716,13 @@ static void P_LoadNodes(lumpnum_t lumpnum)
 		I_Error("Map Loading Error: Level has no nodes, this level was built incorrectly");
 
 	byte j, k;
-	mapnode_t *mn;
+	const mapnode_t *mn;
 	node_t *no;
 
 	nodes = Z_Calloc(numnodes * sizeof (*nodes), PU_LEVEL, NULL);
-	data = W_CacheLumpNum(lumpnum, PU_STATIC);
+	data = W_MapLumpNum(lumpnum);
 
-	mn = (mapnode_t *)data;
+	mn = (const mapnode_t *)data;
 	no = nodes;
 
 	for (i = 0; i < numnodes; i++, no++, mn++)
@@ -739,7 +739,7 @@ static void P_LoadNodes(lumpnum_t lumpnum)
 		}
 	}
 
-	Z_Free(data);
+	W_UnmapLumpNum(lumpnum);
 }
 
 //
@@ -1039,9 +1039,9 @@ void P_WriteThings(lumpnum_t lumpnum)
 //
 static void P_LoadLineDefs(lumpnum_t lumpnum)
 {
-	byte *data;
+	const byte *data;
 	size_t i;
-	maplinedef_t *mld;
+	const maplinedef_t *mld;
 	line_t *ld;
 	vertex_t *v1, *v2;
 
@@ -1049,9 +1049,9 @@ static void P_LoadLineDefs(lumpnum_t lumpnum)
 	if (numlines <= 0)
 		I_Error("Level has no linedefs");
 	lines = Z_Calloc(numlines * sizeof (*lines), PU_LEVEL, NULL);
-	data = W_CacheLumpNum(lumpnum, PU_STATIC);
+	data = W_MapLumpNum(lumpnum);
 
-	mld = (maplinedef_t *)data;
+	mld = (const maplinedef_t *)data;
 	ld = lines;
 	for (i = 0; i < numlines; i++, mld++, ld++)
 	{
@@ -1150,7 +1150,7 @@ static void P_LoadLineDefs(lumpnum_t lumpnum)
 #endif
 	}
 
-	Z_Free(data);
+	W_UnmapLumpNum(lumpnum);
 }
 
 static void P_LoadLineDefs2(void)
@@ -1675,10 +1675,247 @@ static void P_CreateBlockMapo(void) // SRB2CBTODO: Make this actualy effecient
 	}
 }
 #else
-static void P_CreateBlockMap(void) // SRB2CBTODO: CLEANUP!! and optimize
+static INT32 P_MakeBufferMD5(const char *buffer, size_t len, void *resblock);
+
+// Walks the blocks a linedef passes through, one step at a time towards the
+// ending block (killough's blockmap builder). On the counting pass, cells is
+// NULL and cellpos[b] counts the lines in block b; on the filling pass,
+// cellpos[b] is one past the last free cell of block b's list.
+static void P_RasterizeBlockMapLine(size_t i, fixed_t minx, fixed_t miny, size_t tot, size_t *cellpos, long *cells)
+{
+	// starting coordinates
+	int x = (lines[i].v1->x >> FRACBITS) - minx;
+	int y = (lines[i].v1->y >> FRACBITS) - miny;
+
+	// x-y deltas
+	int adx = lines[i].dx >> FRACBITS, dx = adx < 0 ? -1 : 1;
+	int ady = lines[i].dy >> FRACBITS, dy = ady < 0 ? -1 : 1;
+
+	// difference in preferring to move across y (> 0) instead of x (< 0)
+	int diff = !adx ? 1 : !ady ? -1 : (((x >> MAPBTOFRAC) << MAPBTOFRAC) +
+									   (dx > 0 ? MAPBLOCKUNITS-1 : 0) - x) * (ady = abs(ady)) * dx -
+	(((y >> MAPBTOFRAC) << MAPBTOFRAC) +
+	 (dy > 0 ? MAPBLOCKUNITS-1 : 0) - y) * (adx = abs(adx)) * dy;
+
+	// starting block
+	size_t b = (y >> MAPBTOFRAC) * bmapwidth + (x >> MAPBTOFRAC);
+
+	// ending block
+	size_t bend = (((lines[i].v2->y >> FRACBITS) - miny) >> MAPBTOFRAC) *
+	bmapwidth + (((lines[i].v2->x >> FRACBITS) - minx) >> MAPBTOFRAC);
+
+	// delta for block number when moving across y
+	dy *= bmapwidth;
+
+	// deltas for diff inside the loop
+	adx <<= MAPBTOFRAC;
+	ady <<= MAPBTOFRAC;
+
+	// Now we simply iterate block-by-block until we reach the end block.
+	while (b < tot) // failsafe -- should ALWAYS be true
+	{
+		// Lists are filled from the back, so each ends up
+		// with the highest numbered linedef first
+		if (cells)
+			cells[--cellpos[b]] = (long)i;
+		else
+			cellpos[b]++;
+
+		// If we have reached the last block, exit
+		if (b == bend)
+			break;
+
+		// Move in either the x or y direction to the next block
+		if (diff < 0)
+			diff += ady, b += dx;
+		else
+			diff -= adx, b += dy;
+	}
+}
+
+//
+// Blockmap cache
+//
+// Built blockmaps are saved in srb2home as bmap<map md5>.dat so the same
+// map doesn't have to be built again the next time it's loaded. The map
+// MD5 doesn't cover the VERTEXES lump, so that is hashed into the header
+// as well. -noblockmapcache turns the cache off.
+//
+#define BLOCKMAPCACHEID "SRB2BMAP"
+#define BLOCKMAPCACHEVERSION 1
+
+typedef struct
+{
+	char id[8];
+	INT32 version;
+	unsigned char vertexmd5[16];
+	INT32 numlines;
+	INT32 orgx, orgy, width, height;
+	INT32 count; // words in the blockmap, including the 4 header words
+} bmapcacheheader_t;
+
+static boolean P_BlockMapCacheKey(unsigned char *vertexmd5)
+{
+#ifdef NOMD5
+	(void)vertexmd5;
+	return false;
+#else
+	const UINT8 *datavertexes;
+	UINT8 i;
+
+	if (M_CheckParm("-noblockmapcache"))
+		return false;
+
+	for (i = 0; i < 16; i++)
+		if (mapmd5[i])
+			break;
+	if (i == 16) // no map MD5 to go by
+		return false;
+
+	datavertexes = W_MapLumpNum(lastloadedmaplumpnum + ML_VERTEXES);
+	P_MakeBufferMD5((const char *)datavertexes, W_LumpLength(lastloadedmaplumpnum + ML_VERTEXES), vertexmd5);
+	W_UnmapLumpNum(lastloadedmaplumpnum + ML_VERTEXES);
+	return true;
+#endif
+}
+
+static const char *P_BlockMapCacheName(void)
+{
+	char hex[33];
+	UINT8 i;
+
+	for (i = 0; i < 16; i++)
+		sprintf(&hex[i*2], "%02x", mapmd5[i]);
+	return va("%s"PATHSEP"bmap%s.dat", srb2home, hex);
+}
+
+/** Loads a blockmap built on an earlier run.
+  *
+  * Every offset and list in the file is checked, so a damaged or stale
+  * file is rebuilt rather than trusted.
+  *
+  * \param vertexmd5 Digest of the VERTEXES lump.
+  * \return True if blockmaplump was loaded.
+  */
+static boolean P_LoadBlockMapCache(const unsigned char *vertexmd5)
+{
+	bmapcacheheader_t header;
+	size_t tot = bmapwidth * bmapheight;
+	size_t count, i;
+	INT32 *data;
+	long *lump;
+	FILE *f = fopen(P_BlockMapCacheName(), "rb");
+
+	if (!f)
+		return false;
+
+	if (fread(&header, sizeof header, 1, f) != 1
+		|| memcmp(header.id, BLOCKMAPCACHEID, sizeof header.id)
+		|| LONG(header.version) != BLOCKMAPCACHEVERSION
+		|| memcmp(header.vertexmd5, vertexmd5, 16)
+		|| (size_t)LONG(header.numlines) != numlines
+		|| LONG(header.orgx) != bmaporgx>>FRACBITS || LONG(header.orgy) != bmaporgy>>FRACBITS
+		|| LONG(header.width) != bmapwidth || LONG(header.height) != bmapheight
+		|| LONG(header.count) < 0 || (size_t)LONG(header.count) < tot + 6)
+	{
+		fclose(f);
+		return false;
+	}
+
+	count = LONG(header.count);
+	data = malloc(count * sizeof (*data));
+	if (!data || fread(data, sizeof (*data), count, f) != count)
+	{
+		free(data);
+		fclose(f);
+		return false;
+	}
+	fclose(f);
+
+	lump = Z_Malloc(count * sizeof (*lump), PU_LEVEL, NULL);
+	for (i = 0; i < count; i++)
+		lump[i] = LONG(data[i]);
+	free(data);
+
+	// Every block must point at a header word, followed by
+	// linedefs that exist, followed by a trailer
+	for (i = 4; i < tot + 4; i++)
+	{
+		size_t ndx = (size_t)lump[i];
+
+		if (lump[i] < (long)(tot + 4) || ndx >= count || lump[ndx] != 0)
+			break;
+		for (ndx++; ndx < count && lump[ndx] != -1; ndx++)
+			if (lump[ndx] < 0 || (size_t)lump[ndx] >= numlines)
+				break;
+		if (ndx >= count || lump[ndx] != -1)
+			break;
+	}
+
+	if (i < tot + 4)
+	{
+		Z_Free(lump);
+		return false;
+	}
+
+	blockmaplump = lump;
+	return true;
+}
+
+static void P_SaveBlockMapCache(const unsigned char *vertexmd5, size_t count)
+{
+	bmapcacheheader_t header;
+	INT32 *data;
+	size_t i;
+	FILE *f;
+
+	data = malloc(count * sizeof (*data));
+	if (!data)
+		return;
+	for (i = 0; i < count; i++)
+		data[i] = LONG((INT32)blockmaplump[i]);
+
+	memcpy(header.id, BLOCKMAPCACHEID, sizeof header.id);
+	header.version = LONG(BLOCKMAPCACHEVERSION);
+	memcpy(header.vertexmd5, vertexmd5, 16);
+	header.numlines = LONG((INT32)numlines);
+	header.orgx = LONG(bmaporgx>>FRACBITS);
+	header.orgy = LONG(bmaporgy>>FRACBITS);
+	header.width = LONG(bmapwidth);
+	header.height = LONG(bmapheight);
+	header.count = LONG((INT32)count);
+
+	f = fopen(P_BlockMapCacheName(), "wb");
+	if (f)
+	{
+		if (fwrite(&header, sizeof header, 1, f) != 1
+			|| fwrite(data, sizeof (*data), count, f) != count)
+		{
+			fclose(f);
+			remove(P_BlockMapCacheName()); // don't leave half a blockmap behind
+		}
+		else
+			fclose(f);
+	}
+	free(data);
+}
+
+// Hash of a block's linedef list, for finding blocks with the same list
+static ULONG P_BlockListHash(const long *list, size_t n)
+{
+	ULONG hash = 2166136261u;
+
+	while (n--)
+		hash = (hash ^ (ULONG)*list++) * 16777619u;
+	return hash;
+}
+
+static void P_CreateBlockMap(void)
 {
 	register size_t i;
 	fixed_t minx, miny, maxx, maxy;
+	unsigned char vertexmd5[16];
+	boolean usecache;
 
 	if (numvertexes <= 0)
 		CorruptMapError(va("P_CreateBlockMap:\n "
@@ -1715,173 +1952,173 @@ static void P_CreateBlockMap(void) // SRB2CBTODO: CLEANUP!! and optimize
 	bmaporgx = minx << FRACBITS;
 	bmaporgy = miny << FRACBITS;
 
-	// Compute blockmap, which is stored as a 2d array of variable-sized lists.
-	//
-	// Pseudocode:
-	//
-	// For each linedef:
-	//
-	//   Map the starting and ending vertices to blocks.
-	//
-	//   Starting in the starting vertex's block, do:
-	//
-	//     Add linedef to current block's list, dynamically resizing it.
-	//
-	//     If current block is the same as the ending vertex's block, exit loop.
-	//
-	//     Move to an adjacent block by moving towards the ending block in
-	//     either the x or y direction, to the block which contains the linedef.
-
+	if (gamestate != wipegamestate)
 	{
-		typedef struct
-		{
-			int n, nalloc;
-			int *list;
-		} bmap_t; // blocklist structure
-
-		size_t tot = bmapwidth * bmapheight; // size of blockmap
-		bmap_t *bmap = calloc(tot, sizeof *bmap); // array of blocklists
+		F_WipeStartScreen();
 
-		if (gamestate != wipegamestate)
+		if (!(mapheaderinfo[gamemap-1].interscreen[0] == '#'
+			  && gamestate == GS_INTERMISSION))
 		{
-			F_WipeStartScreen();
-
-			if (!(mapheaderinfo[gamemap-1].interscreen[0] == '#'
-				  && gamestate == GS_INTERMISSION))
-			{
-				V_DrawFill(0, 0, vid.width, vid.height, 31);
+			V_DrawFill(0, 0, vid.width, vid.height, 31);
 #ifdef HWRENDER
-				if (rendermode == render_opengl)
-					HWR_PrepFadeToBlack(false);
+			if (rendermode == render_opengl)
+				HWR_PrepFadeToBlack(false);
 #endif
-			}
+		}
 
-			F_WipeEndScreen(0, 0, vid.width, vid.height);
+		F_WipeEndScreen(0, 0, vid.width, vid.height);
 
-			F_RunWipe(TICRATE);
+		F_RunWipe(TICRATE);
 
-			F_WipeStartScreen();
+		F_WipeStartScreen();
 
-			WipeInAction = false;
-		}
+		WipeInAction = false;
+	}
 
+	usecache = P_BlockMapCacheKey(vertexmd5);
+	if (usecache && P_LoadBlockMapCache(vertexmd5))
+	{
+		if (cv_devmode)
+			CONS_Printf("P_CreateBlockMap: Loaded cached blockmap for level %d\n", gamemap);
+	}
+	else
+	{
+		// Compute blockmap, which is stored as a 2d array of variable-sized lists.
+		//
+		// Each linedef is walked from its starting block to its ending block
+		// twice: once to count the lines in every block, and once to drop
+		// them into one array holding every block's list back to back.
+		// Blocks with the same list then share it in the compressed blockmap.
+
+		size_t tot = bmapwidth * bmapheight; // size of blockmap
+		size_t numcells = 0, count = tot + 6; // we need at least 1 word per block, plus reserved's
+		size_t numlists = 0, numshared = 0;
+		size_t *cellpos = calloc(tot + 1, sizeof *cellpos); // start of each block's list
+		size_t *owner = malloc(tot * sizeof *owner); // block whose list this block uses
+		size_t hashsize = 1, *hashtable;
+		long *cells;
+
+		if (!cellpos || !owner)
+			I_Error("Out of Memory in P_CreateBlockMap");
+
+		// XSRB2
+		// Displaying is a slow process, updating the loading screen
+		// too much will actually make the loading take longer!
 		for (i = 0; i < numlines; i++)
 		{
-			// starting coordinates
-			int x = (lines[i].v1->x >> FRACBITS) - minx;
-			int y = (lines[i].v1->y >> FRACBITS) - miny;
+			if (!(i % 500))
+				P_LoadingScreen("Building Blockmap", (short)((i*50)/numlines));
+			P_RasterizeBlockMapLine(i, minx, miny, tot, cellpos, NULL);
+		}
 
-			// x-y deltas
-			int adx = lines[i].dx >> FRACBITS, dx = adx < 0 ? -1 : 1;
-			int ady = lines[i].dy >> FRACBITS, dy = ady < 0 ? -1 : 1;
+		// Turn the counts into the end of each block's list
+		for (i = 0; i < tot; i++)
+			cellpos[i] = numcells += cellpos[i];
+		cellpos[tot] = numcells;
 
-			// difference in preferring to move across y (> 0) instead of x (< 0)
-			int diff = !adx ? 1 : !ady ? -1 : (((x >> MAPBTOFRAC) << MAPBTOFRAC) +
-											   (dx > 0 ? MAPBLOCKUNITS-1 : 0) - x) * (ady = abs(ady)) * dx -
-			(((y >> MAPBTOFRAC) << MAPBTOFRAC) +
-			 (dy > 0 ? MAPBLOCKUNITS-1 : 0) - y) * (adx = abs(adx)) * dy;
+		cells = malloc((numcells ? numcells : 1) * sizeof *cells);
+		if (!cells)
+			I_Error("Out of Memory in P_CreateBlockMap");
 
-			// starting block, and pointer to its blocklist structure
-			size_t b = (y >> MAPBTOFRAC) * bmapwidth + (x >> MAPBTOFRAC);
+		for (i = 0; i < numlines; i++)
+		{
+			if (!(i % 500))
+				P_LoadingScreen("Building Blockmap", (short)(50 + (i*50)/numlines));
+			P_RasterizeBlockMapLine(i, minx, miny, tot, cellpos, cells);
+		}
 
-			// ending block
-			size_t bend = (((lines[i].v2->y >> FRACBITS) - miny) >> MAPBTOFRAC) *
-			bmapwidth + (((lines[i].v2->x >> FRACBITS) - minx) >> MAPBTOFRAC);
+		// Find the blocks with the same list as an earlier block
+		while (hashsize < tot*2)
+			hashsize <<= 1;
+		hashtable = malloc(hashsize * sizeof *hashtable);
+		if (!hashtable)
+			I_Error("Out of Memory in P_CreateBlockMap");
+		memset(hashtable, 0xff, hashsize * sizeof *hashtable); // (size_t)-1 is an empty slot
 
-			// delta for pointer when moving across y
-			dy *= bmapwidth;
+		for (i = 0; i < tot; i++)
+		{
+			size_t n = cellpos[i+1] - cellpos[i];
+			size_t slot;
 
-			// deltas for diff inside the loop
-			adx <<= MAPBTOFRAC;
-			ady <<= MAPBTOFRAC;
+			owner[i] = i;
+			if (!n)
+				continue;
 
-			// Now we simply iterate block-by-block until we reach the end block.
-			while (b < tot) // failsafe -- should ALWAYS be true
+			slot = (size_t)P_BlockListHash(&cells[cellpos[i]], n) & (hashsize - 1);
+			for (; hashtable[slot] != (size_t)-1; slot = (slot + 1) & (hashsize - 1))
 			{
-				// Increase size of allocated list if necessary
-				if (bmap[b].n >= bmap[b].nalloc)
-				{
-					// Make the code more readable, don't realloc a null pointer
-					// (because it crashes for me, and because the comp.lang.c FAQ says so)
-					if (bmap[b].nalloc == 0)
-					{
-						bmap[b].nalloc = 8;
-						bmap[b].list = malloc(bmap[b].nalloc * sizeof (*bmap->list));
-					}
-					else
-					{
-						bmap[b].nalloc = bmap[b].nalloc * 2;
-						bmap[b].list = realloc(bmap[b].list, bmap[b].nalloc * sizeof (*bmap->list));
-					}
-					if (!bmap[b].list)
-						I_Error("Out of Memory in P_CreateBlockMap");
-				}
-
-				// Add linedef to end of list
-				bmap[b].list[bmap[b].n++] = (unsigned int)i;
+				size_t j = hashtable[slot];
 
-				// If we have reached the last block, exit
-				if (b == bend)
+				if (cellpos[j+1] - cellpos[j] == n
+					&& !memcmp(&cells[cellpos[j]], &cells[cellpos[i]], n * sizeof *cells))
+				{
+					owner[i] = j;
 					break;
+				}
+			}
 
-				// XSRB2
-				// Displaying is a slow process, updating the loading screen
-				// too much will actually make the loading take longer!
-				// Note: This function's i value is not always ++ the last one!
-				if (!(i % 500) || !i)
-					P_LoadingScreen("Building Blockmap", ((i*100)/numlines));
-
-				// Move in either the x or y direction to the next block
-				if (diff < 0)
-					diff += ady, b += dx;
-				else
-					diff -= adx, b += dy;
+			if (owner[i] == i)
+			{
+				hashtable[slot] = i;
+				count += n + 2; // 1 header word + 1 trailer word + blocklist
+				numlists++;
 			}
+			else
+				numshared++;
 		}
+		free(hashtable);
 
-		// Compute the total size of the blockmap.
+		// Allocate blockmap lump with computed count
+		blockmaplump = Z_Calloc(sizeof (*blockmaplump) * count, PU_LEVEL, NULL);
+
+		// Now compress the blockmap.
 		//
 		// Compression of empty blocks is performed by reserving two offset words
 		// at tot and tot+1.
 		//
-		// 4 words, unused if this routine is called, are reserved at the start.
+		// The first 4 words hold the same header as a BLOCKMAP lump.
 		{
-			size_t count = tot + 6; // we need at least 1 word per block, plus reserved's
+			size_t ndx = tot + 4; // Advance index to start of linedef lists
+			long empty = (long)ndx;
 
-			for (i = 0; i < tot; i++)
-				if (bmap[i].n)
-					count += bmap[i].n + 2; // 1 header word + 1 trailer word + blocklist
-
-			// Allocate blockmap lump with computed count
-			blockmaplump = Z_Calloc(sizeof (*blockmaplump) * count, PU_LEVEL, NULL);
-		}
-
-		// Now compress the blockmap.
-		{
-			int ndx = tot += 4; // Advance index to start of linedef lists
-			bmap_t *bp = bmap; // Start of uncompressed blockmap
+			blockmaplump[0] = minx;
+			blockmaplump[1] = miny;
+			blockmaplump[2] = bmapwidth;
+			blockmaplump[3] = bmapheight;
 
 			blockmaplump[ndx++] = 0; // Store an empty blockmap list at start
 			blockmaplump[ndx++] = -1; // (Used for compression)
 
-			for (i = 4; i < tot; i++, bp++)
+			for (i = 0; i < tot; i++)
 			{
-				if (bp->n) // Non-empty blocklist
+				if (cellpos[i+1] == cellpos[i]) // Empty blocklist: point to reserved empty blocklist
+					blockmaplump[i+4] = empty;
+				else if (owner[i] != i) // Same list as an earlier block
+					blockmaplump[i+4] = blockmaplump[owner[i]+4];
+				else // Non-empty blocklist
 				{
-					blockmaplump[blockmaplump[i] = ndx++] = 0; // Store index & header
-					do
-						blockmaplump[ndx++] = bp->list[--bp->n]; // Copy linedef list
-					while (bp->n);
+					size_t j;
+
+					blockmaplump[blockmaplump[i+4] = (long)(ndx++)] = 0; // Store index & header
+					for (j = cellpos[i]; j < cellpos[i+1]; j++)
+						blockmaplump[ndx++] = cells[j]; // Copy linedef list
 					blockmaplump[ndx++] = -1; // Store trailer
-					free(bp->list); // Free linedef list
 				}
-				else // Empty blocklist: point to reserved empty blocklist
-					blockmaplump[i] = tot;
 			}
-
-			free(bmap); // Free uncompressed blockmap
 		}
+
+		free(cells);
+		free(owner);
+		free(cellpos);
+
+		if (cv_devmode)
+			CONS_Printf("P_CreateBlockMap: %"PRIdS" block lists, %"PRIdS" shared\n",
+						numlists, numshared);
+
+		if (usecache)
+			P_SaveBlockMapCache(vertexmd5, count);
 	}
+
 	{
 		size_t count;
 		count = sizeof (*blocklinks) * bmapwidth * bmapheight;
@@ -2364,7 +2601,7 @@ void P_RehitStarposts(void)
 	thinker_t *think;
 	int i;
 
-	for (think = thinkercap.next; think != &thinkercap; think = think->next)
+	for (think = thlist[THINK_MOBJ].cnext; think != &thlist[THINK_MOBJ]; think = think->cnext)
 	{
 		if (think->function.acp1 != (actionf_p1)P_MobjThinker)
 			continue; // not a mobj thinker
@@ -2396,7 +2633,7 @@ void P_LoadThingsOnly(void)
 	mobj_t *mo;
 	thinker_t *think;
 
-	for (think = thinkercap.next; think != &thinkercap; think = think->next)
+	for (think = thlist[THINK_MOBJ].cnext; think != &thlist[THINK_MOBJ]; think = think->cnext)
 	{
 		if (think->function.acp1 != (actionf_p1)P_MobjThinker)
 			continue; // not a mobj thinker
@@ -2543,20 +2780,20 @@ static void P_MakeMapMD5(lumpnum_t maplumpnum, void *dest)
 
 	// Create a hash for the current map
 	// get the actual lumps!
-	UINT8 *datalines   = W_CacheLumpNum(maplumpnum + ML_LINEDEFS, PU_CACHE);
-	UINT8 *datasectors = W_CacheLumpNum(maplumpnum + ML_SECTORS, PU_CACHE);
-	UINT8 *datathings  = W_CacheLumpNum(maplumpnum + ML_THINGS, PU_CACHE);
-	UINT8 *datasides   = W_CacheLumpNum(maplumpnum + ML_SIDEDEFS, PU_CACHE);
+	const UINT8 *datalines   = W_MapLumpNum(maplumpnum + ML_LINEDEFS);
+	const UINT8 *datasectors = W_MapLumpNum(maplumpnum + ML_SECTORS);
+	const UINT8 *datathings  = W_MapLumpNum(maplumpnum + ML_THINGS);
+	const UINT8 *datasides   = W_MapLumpNum(maplumpnum + ML_SIDEDEFS);
 
-	P_MakeBufferMD5((char*)datalines,   W_LumpLength(maplumpnum + ML_LINEDEFS), linemd5);
-	P_MakeBufferMD5((char*)datasectors, W_LumpLength(maplumpnum + ML_SECTORS),  sectormd5);
-	P_MakeBufferMD5((char*)datathings,  W_LumpLength(maplumpnum + ML_THINGS),   thingmd5);
-	P_MakeBufferMD5((char*)datasides,   W_LumpLength(maplumpnum + ML_SIDEDEFS), sidedefmd5);
+	P_MakeBufferMD5((const char*)datalines,   W_LumpLength(maplumpnum + ML_LINEDEFS), linemd5);
+	P_MakeBufferMD5((const char*)datasectors, W_LumpLength(maplumpnum + ML_SECTORS),  sectormd5);
+	P_MakeBufferMD5((const char*)datathings,  W_LumpLength(maplumpnum + ML_THINGS),   thingmd5);
+	P_MakeBufferMD5((const char*)datasides,   W_LumpLength(maplumpnum + ML_SIDEDEFS), sidedefmd5);
 
-	Z_Free(datalines);
-	Z_Free(datasectors);
-	Z_Free(datathings);
-	Z_Free(datasides);
+	W_UnmapLumpNum(maplumpnum + ML_LINEDEFS);
+	W_UnmapLumpNum(maplumpnum + ML_SECTORS);
+	W_UnmapLumpNum(maplumpnum + ML_THINGS);
+	W_UnmapLumpNum(maplumpnum + ML_SIDEDEFS);
 
 	for (i = 0; i < 16; i++)
 		resmd5[i] = (linemd5[i] + sectormd5[i] + thingmd5[i] + sidedefmd5[i]) & 0xFF;
@@ -2750,6 +2987,10 @@ noscript:
 	// This includes PU_LEVEL(50) and PU_LEVELSPEC(51)
 	// See z_zone.h for more details on the defined memory tags
 	Z_FreeTags(PU_LEVEL, PU_PURGELEVEL - 1);
+	R_FreeTextureArena(); // last level's textures, even if this one isn't precached
+#ifdef ZDEBUG
+	Z_ProfileLevel(G_BuildMapName(map));
+#endif
 
 	// Preload graphics and textures for OpenGL
 #ifdef HWRENDER
@@ -2775,6 +3016,14 @@ noscript:
 	// internal game map
 	lastloadedmaplumpnum = W_GetNumForName(maplumpname = G_BuildMapName(map));
 
+	// read the level's lumps in the background while the rest is set up
+	{
+		lumpnum_t maplumps[ML_REJECT - ML_THINGS + 1];
+		for (i = 0; i <= ML_REJECT - ML_THINGS; i++)
+			maplumps[i] = lastloadedmaplumpnum + ML_THINGS + i;
+		W_PrefetchLumps(maplumps, sizeof maplumps / sizeof *maplumps);
+	}
+
 	R_ClearColormaps();
 
 	// Start the music!
@@ -2801,6 +3050,9 @@ noscript:
 	// If this level doesn't have a blockmap included, build a custom one
 	if (!loadedbm)
 		P_CreateBlockMap();
+#ifdef THINGGRID
+	P_InitThingGrid();
+#endif
 
 	P_LoadSideDefs2(lastloadedmaplumpnum + ML_SIDEDEFS);
 	R_MakeColormaps();
@@ -2808,7 +3060,7 @@ noscript:
 	P_LoadSubsectors(lastloadedmaplumpnum + ML_SSECTORS);
 	P_LoadNodes(lastloadedmaplumpnum + ML_NODES);
 	P_LoadSegs(lastloadedmaplumpnum + ML_SEGS);
-	rejectmatrix = W_CacheLumpNum(lastloadedmaplumpnum + ML_REJECT, PU_LEVEL);
+	P_LoadReject(lastloadedmaplumpnum + ML_REJECT);
 #ifdef EENGINEO
 	P_RemoveSlimeTrails(); // killough 10/98: remove slime trails from wad
 #endif
@@ -2847,6 +3099,7 @@ noscript:
 
 	// set up world state
 	P_SpawnSpecials();
+	P_GroupSightSectors(); // after the polyobjects are spawned
 
 	if (loadprecip) //  ugly hack for P_NetUnArchiveMisc (and P_LoadNetGame) // SRB2CBTODO: DON'T reload an entire level by default!
 		P_SpawnPrecipitation();
@@ -3007,6 +3260,7 @@ noscript:
 
 	if (precache || dedicated)
 		R_PrecacheLevel();
+	W_FinishPrefetches();
 
 	nextmapoverride = 0;
 	nextmapgametype = -1;
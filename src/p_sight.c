@@ -22,6 +22,9 @@
 #include "p_local.h"
 #include "r_main.h"
 #include "r_state.h"
+#include "m_argv.h"
+#include "w_wad.h"
+#include "z_zone.h"
 
 //
 // P_CheckSight
@@ -36,7 +39,37 @@ typedef struct {
 	fixed_t bbox[4];
 } los_t;
 
-static int sightcounts[2];
+typedef enum
+{
+	SIGHT_CHECKS,     // calls to P_CheckSight
+	SIGHT_NOTGROUPED, // sectors can never see each other
+	SIGHT_REJECTED,   // REJECT lump said no
+	SIGHT_SAMESUB,    // same subsector, visible right away
+	SIGHT_CACHED,     // same sight line as earlier, nothing moved since
+	SIGHT_TRACED,     // had to walk the BSP
+	NUMSIGHTCOUNTS
+} sightcount_t;
+
+static ULONG sightcounts[NUMSIGHTCOUNTS];
+
+// Recent BSP walks, by sight line. Entries from before the last
+// P_ClearSightCache are stale.
+#define SIGHTCACHESIZE 1024
+
+typedef struct
+{
+	fixed_t x1, y1, z1; // eyes of the looker
+	fixed_t x2, y2, bottomslope, topslope; // what it looks at
+	ULONG epoch;
+	boolean visible;
+} sightcache_t;
+
+static sightcache_t sightcache[SIGHTCACHESIZE];
+static ULONG sightepoch = 1;
+
+// Sectors that can never see each other are in different groups.
+// NULL until P_GroupSightSectors runs for the current level.
+static size_t *sightgroups = NULL;
 
 //
 // P_DivlineSide
@@ -304,6 +337,18 @@ static boolean P_CrossBSPNode(int bspnum, register los_t *los)
 		P_CrossSubsector((bspnum == -1 ? 0 : bspnum & ~NF_SUBSECTOR), los);
 }
 
+static size_t P_SightCacheHash(const los_t *los)
+{
+	UINT32 h = (UINT32)los->strace.x * 0x9E3779B1u;
+
+	h = (h ^ (UINT32)los->strace.y) * 0x85EBCA77u;
+	h = (h ^ (UINT32)los->sightzstart) * 0xC2B2AE3Du;
+	h = (h ^ (UINT32)los->t2x) * 0x27D4EB2Fu;
+	h = (h ^ (UINT32)los->t2y) * 0x165667B1u;
+	h = (h ^ (UINT32)los->bottomslope) * 0x9E3779B1u;
+	return (h ^ (h >> 16)) & (SIGHTCACHESIZE - 1);
+}
+
 //
 // P_CheckSight
 //
@@ -312,10 +357,10 @@ static boolean P_CrossBSPNode(int bspnum, register los_t *los)
 //
 boolean P_CheckSight(mobj_t *t1, mobj_t *t2) // SRB2CBTODO: Make this work when FOFs are bewtween places(add FOFs to the blockmap list?)
 {
-	const sector_t *s1 = t1->subsector->sector;
-	const sector_t *s2 = t2->subsector->sector;
-	//int pnum = (s1-sectors)*numsectors + (s2-sectors); // Crashy
+	const sector_t *s1, *s2;
+	size_t pnum;
 	los_t los;
+	sightcache_t *entry;
 
 	// First check for trivial rejection.
 	if (!t1 || !t2 || !t1->subsector || !t2->subsector
@@ -324,29 +369,49 @@ boolean P_CheckSight(mobj_t *t1, mobj_t *t2) // SRB2CBTODO: Make this work when
 		return false;
 	}
 
-	// Check in REJECT table.
-	// SRB2CBTODO: Make a dynamic reject system for optimal stuff
+	s1 = t1->subsector->sector;
+	s2 = t2->subsector->sector;
 
-	// SRB2CBTODO: Crashy and confusing!
-	//if (rejectmatrix[pnum>>3] & (1 << (pnum&7))) // can't possibly be connected
-	//	return false;
+	sightcounts[SIGHT_CHECKS]++;
+
+	// Not even connected?
+	if (sightgroups && sightgroups[s1 - sectors] != sightgroups[s2 - sectors])
+	{
+		sightcounts[SIGHT_NOTGROUPED]++;
+		return false;
+	}
+
+	// Check in REJECT table.
+	if (rejectmatrix)
+	{
+		pnum = (s1 - sectors)*numsectors + (s2 - sectors);
+		if (rejectmatrix[pnum>>3] & (1 << (pnum&7))) // can't possibly be connected
+		{
+			sightcounts[SIGHT_REJECTED]++;
+			return false;
+		}
+	}
 
 	// killough 11/98: shortcut for melee situations
 	// same subsector? obviously visible
 #ifndef POLYOBJECTS
 	if (t1->subsector == t2->subsector)
+	{
+		sightcounts[SIGHT_SAMESUB]++;
 		return true;
+	}
 #else
 	// haleyjd 02/23/06: can't do this if there are polyobjects in the subsec
 	if (!t1->subsector->polyList &&
 		t1->subsector == t2->subsector)
+	{
+		sightcounts[SIGHT_SAMESUB]++;
 		return true;
+	}
 #endif
 
 	// An unobstructed LOS is possible.
 	// Now look from eyes of t1 to any part of t2.
-	sightcounts[1]++;
-
 	validcount++;
 
 	los.topslope =
@@ -415,7 +480,224 @@ boolean P_CheckSight(mobj_t *t1, mobj_t *t2) // SRB2CBTODO: Make this work when
 		}
 	}
 
+	// Looked along this line already, since anything last moved?
+	entry = &sightcache[P_SightCacheHash(&los)];
+	if (entry->epoch == sightepoch
+		&& entry->x1 == los.strace.x && entry->y1 == los.strace.y && entry->z1 == los.sightzstart
+		&& entry->x2 == los.t2x && entry->y2 == los.t2y
+		&& entry->bottomslope == los.bottomslope && entry->topslope == los.topslope)
+	{
+		sightcounts[SIGHT_CACHED]++;
+		return entry->visible;
+	}
+
+	entry->x1 = los.strace.x;
+	entry->y1 = los.strace.y;
+	entry->z1 = los.sightzstart;
+	entry->x2 = los.t2x;
+	entry->y2 = los.t2y;
+	entry->bottomslope = los.bottomslope;
+	entry->topslope = los.topslope;
+	entry->epoch = sightepoch;
+
+	sightcounts[SIGHT_TRACED]++;
+
 	// the head node is the last node output
-	return P_CrossBSPNode((int)numnodes - 1, &los);
+	return (entry->visible = P_CrossBSPNode((int)numnodes - 1, &los));
+}
+
+//
+// P_ClearSightCache
+//
+// Forgets every remembered sight line. Call when anything that can block
+// sight may have moved: sector floors and ceilings, polyobjects and FOFs.
+//
+void P_ClearSightCache(void)
+{
+	sightepoch++;
+}
+
+
+//
+// P_LoadReject
+//
+// The REJECT lump is only used when it covers every pair of sectors and
+// actually rejects something. It's ignored on levels with polyobjects,
+// since a polyobject moving away from where it was built can open up
+// sight the nodebuilder thought was blocked. -noreject ignores it always.
+//
+void P_LoadReject(lumpnum_t lumpnum)
+{
+	const size_t needed = (numsectors*numsectors + 7)/8;
+	size_t i;
+
+	rejectmatrix = NULL;
+	sightgroups = NULL; // freed with the last level
+	P_ClearSightCache();
+
+	if (M_CheckParm("-noreject"))
+		return;
+
+	if (W_LumpLength(lumpnum) < needed)
+	{
+		if (W_LumpLength(lumpnum))
+			CONS_Printf("P_LoadReject: REJECT lump is too small, ignoring it\n");
+		return;
+	}
+
+	rejectmatrix = W_CacheLumpNum(lumpnum, PU_LEVEL);
+
+	for (i = 0; i < needed; i++)
+		if (rejectmatrix[i])
+			return;
+
+	// all zeros, it would never reject anything
+	Z_Free(rejectmatrix);
+	rejectmatrix = NULL;
 }
 
+static size_t P_SightGroupOf(size_t *parent, size_t i)
+{
+	while (parent[i] != i)
+		i = parent[i] = parent[parent[i]];
+	return i;
+}
+
+static void P_JoinSightGroups(size_t *parent, size_t a, size_t b)
+{
+	a = P_SightGroupOf(parent, a);
+	b = P_SightGroupOf(parent, b);
+	if (a < b)
+		parent[b] = a;
+	else
+		parent[a] = b;
+}
+
+//
+// P_GroupSightSectors
+//
+// Sight can only pass between sectors through two sided lines, so
+// sectors that aren't joined by any chain of them can never see each
+// other, wherever their floors, ceilings and FOFs move to. Sectors
+// touching at a single vertex are joined too, for sight lines that
+// graze the corner. Polyobjects only block sight, except where they
+// were built, so every sector next to a polyobject line is joined.
+//
+// Call after the polyobjects are spawned.
+//
+void P_GroupSightSectors(void)
+{
+	size_t *parent, *vertsector;
+	size_t i, j, s, polysector = numsectors, numgroups = 0;
+	const line_t *ld;
+	const sector_t *sec[2];
+	const vertex_t *v[2];
+
+	sightgroups = NULL;
+	P_ClearSightCache();
+
+	if (!numsectors)
+		return;
+
+	parent = malloc(numsectors * sizeof (*parent));
+	vertsector = malloc(numvertexes * sizeof (*vertsector));
+	if (!parent || !vertsector)
+		I_Error("P_GroupSightSectors: out of memory");
+
+	for (i = 0; i < numsectors; i++)
+		parent[i] = i;
+	for (i = 0; i < numvertexes; i++)
+		vertsector[i] = numsectors;
+
+	for (i = 0, ld = lines; i < numlines; i++, ld++)
+	{
+		sec[0] = ld->frontsector;
+		sec[1] = ld->backsector;
+		v[0] = ld->v1;
+		v[1] = ld->v2;
+
+		if (sec[0] && sec[1])
+			P_JoinSightGroups(parent, sec[0] - sectors, sec[1] - sectors);
+
+		for (j = 0; j < 2; j++)
+		{
+			if (!sec[j])
+				continue;
+			s = sec[j] - sectors;
+
+			if (ld->polyobj)
+			{
+				if (polysector == numsectors)
+					polysector = s;
+				else
+					P_JoinSightGroups(parent, polysector, s);
+			}
+
+			if (vertsector[v[0] - vertexes] == numsectors)
+				vertsector[v[0] - vertexes] = s;
+			else
+				P_JoinSightGroups(parent, vertsector[v[0] - vertexes], s);
+
+			if (vertsector[v[1] - vertexes] == numsectors)
+				vertsector[v[1] - vertexes] = s;
+			else
+				P_JoinSightGroups(parent, vertsector[v[1] - vertexes], s);
+		}
+	}
+
+	if (polysector != numsectors && rejectmatrix)
+	{
+		Z_Free(rejectmatrix);
+		rejectmatrix = NULL;
+	}
+
+	sightgroups = Z_Malloc(numsectors * sizeof (*sightgroups), PU_LEVEL, NULL);
+	for (i = 0; i < numsectors; i++)
+	{
+		sightgroups[i] = P_SightGroupOf(parent, i);
+		if (sightgroups[i] == i)
+			numgroups++;
+	}
+
+	free(vertsector);
+	free(parent);
+
+	// one group can't reject anything
+	if (numgroups == 1)
+	{
+		Z_Free(sightgroups);
+		sightgroups = NULL;
+	}
+
+	if (cv_devmode)
+		CONS_Printf("P_GroupSightSectors: %u sight groups, %s REJECT\n",
+			(unsigned int)numgroups, rejectmatrix ? "using" : "no");
+}
+
+//
+// Command_Sightcounts_f
+//
+// How P_CheckSight calls have been answered. "sightcounts reset"
+// starts counting again.
+//
+void Command_Sightcounts_f(void)
+{
+	ULONG checks;
+
+	if (COM_Argc() > 1 && !stricmp(COM_Argv(1), "reset"))
+	{
+		memset(sightcounts, 0, sizeof (sightcounts));
+		return;
+	}
+
+	checks = sightcounts[SIGHT_CHECKS];
+	CONS_Printf("Sight checks:       %lu\n", checks);
+	if (!checks)
+		return;
+
+	CONS_Printf("Never connected:    %lu (%lu%%)\n", sightcounts[SIGHT_NOTGROUPED], sightcounts[SIGHT_NOTGROUPED]*100/checks);
+	CONS_Printf("Rejected by lump:   %lu (%lu%%)\n", sightcounts[SIGHT_REJECTED], sightcounts[SIGHT_REJECTED]*100/checks);
+	CONS_Printf("Same subsector:     %lu (%lu%%)\n", sightcounts[SIGHT_SAMESUB], sightcounts[SIGHT_SAMESUB]*100/checks);
+	CONS_Printf("Cached:             %lu (%lu%%)\n", sightcounts[SIGHT_CACHED], sightcounts[SIGHT_CACHED]*100/checks);
+	CONS_Printf("Traced through BSP: %lu (%lu%%)\n", sightcounts[SIGHT_TRACED], sightcounts[SIGHT_TRACED]*100/checks);
+}
@@ -358,6 +358,38 @@ void P_SetupLevelFlatAnims(void)
 	}
 }
 
+/** Marks every frame of each texture animation that a level uses any
+  * frame of, so they can all be prepared when it loads.
+  *
+  * \param texturepresent One entry for each texture, nonzero if it is used.
+  * \sa R_PrecacheLevel
+  */
+void P_MarkAnimatedTextures(char *texturepresent)
+{
+	int i;
+	long pic;
+
+	if (!anims)
+		return;
+
+	for (i = 0; anims[i].istexture != (boolean)-1; i++)
+	{
+		if (!anims[i].istexture || anims[i].basepic < 0
+			|| (size_t)anims[i].picnum >= numtextures)
+			continue;
+
+		for (pic = anims[i].basepic; pic <= anims[i].picnum; pic++)
+			if (texturepresent[pic])
+				break;
+
+		if (pic > anims[i].picnum)
+			continue;
+
+		for (pic = anims[i].basepic; pic <= anims[i].picnum; pic++)
+			texturepresent[pic] = 1;
+	}
+}
+
 //
 // UTILITIES
 //
@@ -1308,7 +1340,7 @@ static void P_AddExecutorDelay(line_t *line, mobj_t *mobj, boolean usetexture)
 		e->timer = (line->backsector->ceilingheight>>FRACBITS)+(line->backsector->floorheight>>FRACBITS);
 
 	e->caller = mobj;
-	P_AddThinker(&e->thinker);
+	P_AddThinker(THINK_SPECIAL, &e->thinker);
 }
 
 static sector_t *triplinecaller;
@@ -1333,6 +1365,8 @@ void P_LinedefExecute(long tag, mobj_t *actor, sector_t *caller)
 	size_t masterline, i, linecnt;
 	short specialtype;
 
+	P_ClearSightCache(); // executors can move anything
+
 	for (masterline = 0; masterline < numlines; masterline++)
 	{
 		if (lines[masterline].tag != tag)
@@ -1665,95 +1699,10 @@ void P_SwitchWeather(int weathernum)
 	}
 
 	if (purge)
-	{
-		thinker_t *think;
-		precipmobj_t *precipmobj;
-
-		for (think = thinkercap.next; think != &thinkercap; think = think->next)
-		{
-			if ((think->function.acp1 != (actionf_p1)P_SnowThinker)
-				&& (think->function.acp1 != (actionf_p1)P_RainThinker))
-				continue; // not a precipmobj thinker
-
-			precipmobj = (precipmobj_t *)think;
-
-			P_RemovePrecipMobj(precipmobj);
-		}
-	}
+		P_ClearPrecipitation();
 	else if (swap && !((swap == PRECIP_BLANK && curWeather == PRECIP_STORM_NORAIN)
 	|| (swap == PRECIP_STORM_NORAIN && curWeather == PRECIP_BLANK))) // Rather than respawn everything, reuse it!
-	{
-		thinker_t *think;
-		precipmobj_t *precipmobj;
-		state_t *st;
-
-		for (think = thinkercap.next; think != &thinkercap; think = think->next)
-		{
-			if (swap == PRECIP_RAIN) // Snow To Rain
-			{
-				if (!(think->function.acp1 == (actionf_p1)P_SnowThinker
-					|| think->function.acp1 == (actionf_p1)P_NullPrecipThinker))
-					continue; // not a precipmobj thinker
-
-				precipmobj = (precipmobj_t *)think;
-
-				precipmobj->flags = mobjinfo[MT_RAIN].flags;
-				st = &states[mobjinfo[MT_RAIN].spawnstate];
-				precipmobj->state = st;
-				precipmobj->tics = st->tics;
-				precipmobj->sprite = st->sprite;
-				precipmobj->frame = st->frame;
-				precipmobj->momz = mobjinfo[MT_RAIN].speed/NEWTICRATERATIO;
-
-				precipmobj->invisible = 0;
-
-				think->function.acp1 = (actionf_p1)P_RainThinker;
-			}
-			else if (swap == PRECIP_SNOW) // Rain To Snow
-			{
-				int z;
-
-				if (!(think->function.acp1 == (actionf_p1)P_RainThinker
-					|| think->function.acp1 == (actionf_p1)P_NullPrecipThinker))
-					continue; // not a precipmobj thinker
-
-				precipmobj = (precipmobj_t *)think;
-
-				precipmobj->flags = mobjinfo[MT_SNOWFLAKE].flags;
-				z = M_Random();
-
-				if (z < 64)
-					z = 2;
-				else if (z < 144)
-					z = 1;
-				else
-					z = 0;
-
-				st = &states[mobjinfo[MT_SNOWFLAKE].spawnstate+z];
-				precipmobj->state = st;
-				precipmobj->tics = st->tics;
-				precipmobj->sprite = st->sprite;
-				precipmobj->frame = st->frame;
-				precipmobj->momz = mobjinfo[MT_SNOWFLAKE].speed/NEWTICRATERATIO;
-
-				precipmobj->invisible = 0;
-
-				think->function.acp1 = (actionf_p1)P_SnowThinker;
-			}
-			else if (swap == PRECIP_BLANK || swap == PRECIP_STORM_NORAIN) // Remove precip, but keep it around for reuse.
-			{
-				if (!(think->function.acp1 == (actionf_p1)P_RainThinker
-					|| think->function.acp1 == (actionf_p1)P_SnowThinker))
-					continue;
-
-				precipmobj = (precipmobj_t *)think;
-
-				think->function.acp1 = (actionf_p1)P_NullPrecipThinker;
-
-				precipmobj->invisible = 1;
-			}
-		}
-	}
+		P_SetPrecipitationKind(swap);
 
 	switch (weathernum)
 	{
@@ -2511,7 +2460,7 @@ static void P_ProcessLineSpecial(line_t *line, mobj_t *mo)
 				scroll_t *scroller;
 				thinker_t *th;
 
-				for (th = thinkercap.next; th != &thinkercap; th = th->next)
+				for (th = thlist[THINK_SPECIAL].cnext; th != &thlist[THINK_SPECIAL]; th = th->cnext)
 				{
 					if (th->function.acp1 != (actionf_p1)T_Scroll)
 						continue;
@@ -2717,7 +2666,7 @@ static boolean P_IsFlagAtBase(mobjtype_t flag)
 	mobj_t *mo;
 	int specialnum = 0;
 
-	for (think = thinkercap.next; think != &thinkercap; think = think->next)
+	for (think = thlist[THINK_MOBJ].cnext; think != &thlist[THINK_MOBJ]; think = think->cnext)
 	{
 		if (think->function.acp1 != (actionf_p1)P_MobjThinker)
 			continue; // not a mobj thinker
@@ -3477,7 +3426,7 @@ void P_ProcessSpecialSector(player_t *player, sector_t *sector, sector_t *rovers
 						player->nightsfall = true;
 
 						// Check to see if the player should be lose a life
-						for (th = thinkercap.next; th != &thinkercap; th = th->next)
+						for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 						{
 							if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 								continue;
@@ -3762,7 +3711,7 @@ void P_ProcessSpecialSector(player_t *player, sector_t *sector, sector_t *rovers
 				sector->special = 0;
 
 				// Find the center of the Eggtrap and release all the pretty animals!
-				for (th = thinkercap.next; th != &thinkercap; th = th->next)
+				for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 				{
 					if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 						continue;
@@ -4213,7 +4162,7 @@ void P_ProcessSpecialSector(player_t *player, sector_t *sector, sector_t *rovers
 
 				// scan the thinkers
 				// to find the first waypoint
-				for (th = thinkercap.next; th != &thinkercap; th = th->next)
+				for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 				{
 					if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 						continue;
@@ -4288,7 +4237,7 @@ void P_ProcessSpecialSector(player_t *player, sector_t *sector, sector_t *rovers
 
 				// scan the thinkers
 				// to find the last waypoint
-				for (th = thinkercap.next; th != &thinkercap; th = th->next)
+				for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 				{
 					if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 						continue;
@@ -4356,7 +4305,7 @@ void P_ProcessSpecialSector(player_t *player, sector_t *sector, sector_t *rovers
 						// Reset starposts (checkpoints) info
 						player->starpostangle = player->starposttime = player->starpostnum = player->starpostbit = 0;
 						player->starpostx = player->starposty = player->starpostz = 0;
-						for (th = thinkercap.next; th != &thinkercap; th = th->next)
+						for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 						{
 							if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 								continue;
@@ -4439,7 +4388,7 @@ void P_ProcessSpecialSector(player_t *player, sector_t *sector, sector_t *rovers
 
 				// scan the thinkers
 				// to find the first waypoint
-				for (th = thinkercap.next; th != &thinkercap; th = th->next)
+				for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 				{
 					if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 						continue;
@@ -4477,7 +4426,7 @@ void P_ProcessSpecialSector(player_t *player, sector_t *sector, sector_t *rovers
 				}
 
 				// Find waypoint before this one (waypointlow)
-				for (th = thinkercap.next; th != &thinkercap; th = th->next)
+				for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 				{
 					if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 						continue;
@@ -4504,7 +4453,7 @@ void P_ProcessSpecialSector(player_t *player, sector_t *sector, sector_t *rovers
 				}
 
 				// Find waypoint before this one (waypointhigh)
-				for (th = thinkercap.next; th != &thinkercap; th = th->next)
+				for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 				{
 					if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 						continue;
@@ -5334,7 +5283,7 @@ static ffloor_t *P_AddFakeFloor(sector_t *targetsec, sector_t *controlsec, line_
 
 	// scan the thinkers
 	// to see if this FOF should have spikeness
-	for (th = thinkercap.next; th != &thinkercap; th = th->next)
+	for (th = thlist[THINK_SPECIAL].cnext; th != &thlist[THINK_SPECIAL]; th = th->cnext)
 	{
 		if (th->function.acp1 != (actionf_p1)T_SpikeSector)
 			continue;
@@ -5347,7 +5296,7 @@ static ffloor_t *P_AddFakeFloor(sector_t *targetsec, sector_t *controlsec, line_
 
 	// scan the thinkers
 	// to see if this FOF should have friction
-	for (th = thinkercap.next; th != &thinkercap; th = th->next)
+	for (th = thlist[THINK_SPECIAL].cnext; th != &thlist[THINK_SPECIAL]; th = th->cnext)
 	{
 		if (th->function.acp1 != (actionf_p1)T_Friction)
 			continue;
@@ -5360,7 +5309,7 @@ static ffloor_t *P_AddFakeFloor(sector_t *targetsec, sector_t *controlsec, line_
 
 	// scan the thinkers
 	// to see if this FOF should have wind/current/pusher
-	for (th = thinkercap.next; th != &thinkercap; th = th->next)
+	for (th = thlist[THINK_SPECIAL].cnext; th != &thlist[THINK_SPECIAL]; th = th->cnext)
 	{
 		if (th->function.acp1 != (actionf_p1)T_Pusher)
 			continue;
@@ -5424,8 +5373,8 @@ static void P_AddSpikeThinker(sector_t *sec, int referrer)
 	levelspecthink_t *spikes;
 
 	// create and initialize new thinker
-	spikes = Z_Calloc(sizeof (*spikes), PU_LEVSPEC, NULL);
-	P_AddThinker(&spikes->thinker);
+	spikes = Z_PoolCalloc(levspecpool);
+	P_AddThinker(THINK_SPECIAL, &spikes->thinker);
 
 	spikes->thinker.function.acp1 = (actionf_p1)T_SpikeSector;
 
@@ -5446,8 +5395,8 @@ static void P_AddFloatThinker(sector_t *sec, int tag, line_t *sourceline)
 	levelspecthink_t *floater;
 
 	// create and initialize new thinker
-	floater = Z_Calloc(sizeof (*floater), PU_LEVSPEC, NULL);
-	P_AddThinker(&floater->thinker);
+	floater = Z_PoolCalloc(levspecpool);
+	P_AddThinker(THINK_SPECIAL, &floater->thinker);
 
 	floater->thinker.function.acp1 = (actionf_p1)T_FloatSector;
 
@@ -5469,8 +5418,8 @@ static inline void P_AddBridgeThinker(line_t *sourceline, sector_t *sec)
 	levelspecthink_t *bridge;
 
 	// create an initialize new thinker
-	bridge = Z_Calloc(sizeof (*bridge), PU_LEVSPEC, NULL);
-	P_AddThinker(&bridge->thinker);
+	bridge = Z_PoolCalloc(levspecpool);
+	P_AddThinker(THINK_SPECIAL, &bridge->thinker);
 
 	bridge->thinker.function.acp1 = (actionf_p1)T_BridgeThinker;
 
@@ -5502,8 +5451,8 @@ static void P_AddBlockThinker(sector_t *sec, line_t *sourceline)
 	levelspecthink_t *block;
 
 	// create and initialize new elevator thinker
-	block = Z_Calloc(sizeof (*block), PU_LEVSPEC, NULL);
-	P_AddThinker(&block->thinker);
+	block = Z_PoolCalloc(levspecpool);
+	P_AddThinker(THINK_SPECIAL, &block->thinker);
 
 	block->thinker.function.acp1 = (actionf_p1)T_MarioBlockChecker;
 	block->sourceline = sourceline;
@@ -5531,8 +5480,8 @@ static void P_AddRaiseThinker(sector_t *sec, line_t *sourceline)
 {
 	levelspecthink_t *raise;
 
-	raise = Z_Calloc(sizeof (*raise), PU_LEVSPEC, NULL);
-	P_AddThinker(&raise->thinker);
+	raise = Z_PoolCalloc(levspecpool);
+	P_AddThinker(THINK_SPECIAL, &raise->thinker);
 
 	raise->thinker.function.acp1 = (actionf_p1)T_RaiseSector;
 
@@ -5570,8 +5519,8 @@ static void P_AddOldAirbob(sector_t *sec, line_t *sourceline, boolean noadjust)
 {
 	levelspecthink_t *airbob;
 
-	airbob = Z_Calloc(sizeof (*airbob), PU_LEVSPEC, NULL);
-	P_AddThinker(&airbob->thinker);
+	airbob = Z_PoolCalloc(levspecpool);
+	P_AddThinker(THINK_SPECIAL, &airbob->thinker);
 
 	airbob->thinker.function.acp1 = (actionf_p1)T_RaiseSector;
 
@@ -5633,8 +5582,8 @@ static inline void P_AddThwompThinker(sector_t *sec, sector_t *actionsector, lin
 		return;
 
 	// create and initialize new elevator thinker
-	thwomp = Z_Calloc(sizeof (*thwomp), PU_LEVSPEC, NULL);
-	P_AddThinker(&thwomp->thinker);
+	thwomp = Z_PoolCalloc(levspecpool);
+	P_AddThinker(THINK_SPECIAL, &thwomp->thinker);
 
 	thwomp->thinker.function.acp1 = (actionf_p1)T_ThwompSector;
 
@@ -5669,8 +5618,8 @@ static inline void P_AddNoEnemiesThinker(sector_t *sec, line_t *sourceline)
 	levelspecthink_t *nobaddies;
 
 	// create and initialize new thinker
-	nobaddies = Z_Calloc(sizeof (*nobaddies), PU_LEVSPEC, NULL);
-	P_AddThinker(&nobaddies->thinker);
+	nobaddies = Z_PoolCalloc(levspecpool);
+	P_AddThinker(THINK_SPECIAL, &nobaddies->thinker);
 
 	nobaddies->thinker.function.acp1 = (actionf_p1)T_NoEnemiesSector;
 
@@ -5691,8 +5640,8 @@ static inline void P_AddEachTimeThinker(sector_t *sec, line_t *sourceline)
 	levelspecthink_t *eachtime;
 
 	// create and initialize new thinker
-	eachtime = Z_Calloc(sizeof (*eachtime), PU_LEVSPEC, NULL);
-	P_AddThinker(&eachtime->thinker);
+	eachtime = Z_PoolCalloc(levspecpool);
+	P_AddThinker(THINK_SPECIAL, &eachtime->thinker);
 
 	eachtime->thinker.function.acp1 = (actionf_p1)T_EachTimeThinker;
 
@@ -5713,8 +5662,8 @@ static inline void P_AddTimedThinker(sector_t *sec, line_t *sourceline) // TIMED
 	levelspecthink_t *timed;
 
 	// create and initialize new thinker
-	timed = Z_Calloc(sizeof (*timed), PU_LEVSPEC, NULL);
-	P_AddThinker(&timed->thinker);
+	timed = Z_PoolCalloc(levspecpool);
+	P_AddThinker(THINK_SPECIAL, &timed->thinker);
 
 	timed->thinker.function.acp1 = (actionf_p1)T_EachTimeThinker;
 
@@ -5736,7 +5685,7 @@ static inline void P_AddCameraScanner(sector_t *sourcesec, sector_t *actionsecto
 
 	// create and initialize new elevator thinker
 	elevator = Z_Calloc(sizeof (*elevator), PU_LEVSPEC, NULL);
-	P_AddThinker(&elevator->thinker);
+	P_AddThinker(THINK_SPECIAL, &elevator->thinker);
 
 	elevator->thinker.function.acp1 = (actionf_p1)T_CameraScanner;
 	elevator->type = elevateBounce;
@@ -5815,7 +5764,7 @@ static inline void EV_AddLaserThinker(sector_t *sec, sector_t *sec2, line_t *lin
 
 	flash = Z_Calloc(sizeof (*flash), PU_LEVSPEC, NULL);
 
-	P_AddThinker(&flash->thinker);
+	P_AddThinker(THINK_SPECIAL, &flash->thinker);
 
 	flash->thinker.function.acp1 = (actionf_p1)T_LaserFlash;
 	flash->ffloor = ffloor;
@@ -7272,7 +7221,7 @@ static void Add_Scroller(int type, fixed_t dx, fixed_t dy, int control, int affe
 	if ((s->control = control) != -1)
 		s->last_height = sectors[control].floorheight + sectors[control].ceilingheight;
 	s->affectee = affectee;
-	P_AddThinker(&s->thinker);
+	P_AddThinker(THINK_SPECIAL, &s->thinker);
 }
 
 /** Adds a wall scroller.
@@ -7429,7 +7378,7 @@ static void Add_MasterDisappearer(tic_t appeartime, tic_t disappeartime, tic_t o
 	d->exists = true;
 	d->timer = 1;
 
-	P_AddThinker(&d->thinker);
+	P_AddThinker(THINK_SPECIAL, &d->thinker);
 }
 
 /** Makes a FOF appear/disappear
@@ -7522,7 +7471,7 @@ static void Add_Friction(long friction, long movefactor, long affectee, long ref
 	else
 		f->roverfriction = false;
 
-	P_AddThinker(&f->thinker);
+	P_AddThinker(THINK_SPECIAL, &f->thinker);
 }
 
 /** Applies friction to all things in a sector.
@@ -7703,7 +7652,7 @@ void Add_Pusher(pushertype_e type, fixed_t x_mag, fixed_t y_mag, mobj_t *source,
 		p->z = p->source->z;
 	}
 	p->affectee = affectee;
-	P_AddThinker(&p->thinker);
+	P_AddThinker(THINK_SPECIAL, &p->thinker);
 }
 
 
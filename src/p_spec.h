@@ -34,6 +34,7 @@ void P_InitPicAnims(void);
 
 // at map load (sectors)
 void P_SetupLevelFlatAnims(void);
+void P_MarkAnimatedTextures(char *texturepresent);
 
 // at map load
 void P_SpawnSpecials(void);
@@ -25,6 +25,9 @@
 #include "st_stuff.h"
 #include "p_polyobj.h"
 #include "m_random.h"
+#include "i_system.h"
+#include "dehacked.h"
+#include "d_main.h"
 
 #ifdef JTEBOTS
 #include "p_bots.h"
@@ -42,6 +45,23 @@ tic_t leveltime;
 
 // Both the head and tail of the thinker list.
 thinker_t thinkercap;
+thinker_t thlist[NUM_THINKERLISTS];
+
+// Pools for the objects that come and go all through a level
+mempool_t *mobjpool;
+mempool_t *levspecpool;
+mempool_t *secnodepool;
+
+//
+// P_InitObjectPools
+// Called once at startup, the pools are emptied at every level load.
+//
+void P_InitObjectPools(void)
+{
+	mobjpool = Z_CreatePool("Mobjs", sizeof (mobj_t), PU_LEVEL);
+	levspecpool = Z_CreatePool("Level specials", sizeof (levelspecthink_t), PU_LEVSPEC);
+	secnodepool = Z_CreatePool("Sector nodes", sizeof (msecnode_t), PU_LEVEL);
+}
 
 void Command_Numthinkers_f(void)
 {
@@ -53,7 +73,7 @@ void Command_Numthinkers_f(void)
 	if (COM_Argc() < 2)
 	{
 		CONS_Printf("numthinkers <#>: Count number of thinkers\n\t1: P_MobjThinker\n"
-					"\t2: P_RainThinker\n\t3: P_SnowThinker\n\t4: P_NullPrecipThinker\n"
+					"\t2: Rain drops\n\t3: Snow drops\n\t4: Hidden drops\n"
 					"\t5: T_Friction\n\t6: T_Pusher\n\t7: P_RemoveThinkerDelayed\n");
 		return;
 	}
@@ -67,17 +87,14 @@ void Command_Numthinkers_f(void)
 			CONS_Printf("Number of P_MobjThinker: ");
 			break;
 		case 2:
-			action = (actionf_p1)P_RainThinker;
-			CONS_Printf("Number of P_RainThinker: ");
-			break;
 		case 3:
-			action = (actionf_p1)P_SnowThinker;
-			CONS_Printf("Number of P_SnowThinker: ");
-			break;
 		case 4:
-			action = (actionf_p1)P_NullPrecipThinker;
-			CONS_Printf("Number of P_NullPrecipThinker: ");
-			break;
+			// Precipitation isn't made of thinkers, but all drops are the same kind
+			if (precipdrops.block && (num == 4 ? precipdrops.hidden
+				: !precipdrops.hidden && precipdrops.kind == (num == 2 ? PRECIP_RAIN : PRECIP_SNOW)))
+				count = (int)precipdrops.num;
+			CONS_Printf("Number of %s drops: %d\n", num == 2 ? "rain" : num == 3 ? "snow" : "hidden", count);
+			return;
 		case 5:
 			action = (actionf_p1)T_Friction;
 			CONS_Printf("Number of T_Friction: ");
@@ -118,7 +135,7 @@ void Command_CountMobjs_f(void)
 	{
 		count = 0;
 
-		for (th = thinkercap.next; th != &thinkercap; th = th->next)
+		for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 		{
 			if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 				continue;
@@ -132,25 +149,317 @@ void Command_CountMobjs_f(void)
 	CONS_Printf("Done\n");
 }
 
+// ==========================================================================
+//                             THINKER PROFILER
+// ==========================================================================
+
+#define MAXPROFFUNCS 1024 // power of two, it's a hash table
+#define PROFHASH(func) (((size_t)(func) >> 4) & (MAXPROFFUNCS-1))
+
+typedef struct
+{
+	actionf_p1 func;
+	boolean action; // a state action, not a thinker
+	UINT64 micros;
+	ULONG calls;
+} thinkprof_t;
+
+typedef struct
+{
+	char name[48];
+	const char *kind;
+	UINT64 micros;
+	ULONG calls;
+} profrow_t;
+
+boolean thinkprofiling = false;
+static thinkprof_t proffuncs[MAXPROFFUNCS];
+static int numproffuncs = 0;
+static UINT64 mobjmicros[NUMMOBJTYPES];
+static ULONG mobjcalls[NUMMOBJTYPES];
+static UINT64 profthinkmicros; // all of P_RunThinkers
+static ULONG proftics;
+static boolean profbycalls;
+
+#define THINKERNAME(func) {(actionf_p1)func, #func}
+
+static const struct
+{
+	actionf_p1 func;
+	const char *name;
+} thinkernames[] =
+{
+	THINKERNAME(P_RemoveThinkerDelayed),
+	THINKERNAME(T_MoveCeiling),
+	THINKERNAME(T_CrushCeiling),
+	THINKERNAME(T_MoveFloor),
+	THINKERNAME(T_MoveElevator),
+	THINKERNAME(T_ContinuousFalling),
+	THINKERNAME(T_BounceCheese),
+	THINKERNAME(T_StartCrumble),
+	THINKERNAME(T_MarioBlock),
+	THINKERNAME(T_MarioBlockChecker),
+	THINKERNAME(T_SpikeSector),
+	THINKERNAME(T_FloatSector),
+	THINKERNAME(T_BridgeThinker),
+	THINKERNAME(T_ThwompSector),
+	THINKERNAME(T_NoEnemiesSector),
+	THINKERNAME(T_EachTimeThinker),
+	THINKERNAME(T_TimedThinker),
+	THINKERNAME(T_CameraScanner),
+	THINKERNAME(T_RaiseSector),
+	THINKERNAME(T_ExecutorDelay),
+	THINKERNAME(T_Disappear),
+	THINKERNAME(T_Scroll),
+	THINKERNAME(T_Friction),
+	THINKERNAME(T_Pusher),
+	THINKERNAME(T_FireFlicker),
+	THINKERNAME(T_LightningFlash),
+	THINKERNAME(T_StrobeFlash),
+	THINKERNAME(T_Glow),
+	THINKERNAME(T_LightFade),
+	THINKERNAME(T_LaserFlash),
+	THINKERNAME(T_PolyObjRotate),
+	THINKERNAME(T_PolyObjMove),
+	THINKERNAME(T_PolyObjWaypoint),
+	THINKERNAME(T_PolyDoorSlide),
+	THINKERNAME(T_PolyDoorSwing),
+	THINKERNAME(T_PolyObjFlag),
+	{NULL, NULL}
+};
+
+#undef THINKERNAME
+
+static void P_AddProfile(actionf_p1 func, boolean action, UINT64 micros)
+{
+	size_t i = PROFHASH(func);
+
+	while (proffuncs[i].func && (proffuncs[i].func != func || proffuncs[i].action != action))
+		i = (i + 1) & (MAXPROFFUNCS-1);
+
+	if (!proffuncs[i].func)
+	{
+		if (numproffuncs >= MAXPROFFUNCS/2) // too full to keep searching quickly
+			return;
+		proffuncs[i].func = func;
+		proffuncs[i].action = action;
+		numproffuncs++;
+	}
+
+	proffuncs[i].micros += micros;
+	proffuncs[i].calls++;
+}
+
+//
+// P_ProfileAction
+// Runs and times a state action; use P_RunStateAction.
+// Actions run by a thinker are also part of that thinker's time.
+//
+void P_ProfileAction(actionf_p1 action, void *mo)
+{
+	const UINT64 start = I_GetTimeMicros();
+
+	action(mo);
+	P_AddProfile(action, true, I_GetTimeMicros() - start);
+}
+
+static void P_ResetThinkProfile(void)
+{
+	memset(proffuncs, 0, sizeof (proffuncs));
+	memset(mobjmicros, 0, sizeof (mobjmicros));
+	memset(mobjcalls, 0, sizeof (mobjcalls));
+	numproffuncs = 0;
+	profthinkmicros = 0;
+	proftics = 0;
+}
+
+static const char *P_ThinkerName(actionf_p1 func)
+{
+	int i;
+
+	for (i = 0; thinkernames[i].func; i++)
+		if (thinkernames[i].func == func)
+			return thinkernames[i].name;
+	return "unknown thinker";
+}
+
+static int P_CompareProfRows(const void *a, const void *b)
+{
+	const profrow_t *ra = a, *rb = b;
+
+	if (profbycalls && ra->calls != rb->calls)
+		return ra->calls < rb->calls ? 1 : -1;
+	if (ra->micros != rb->micros)
+		return ra->micros < rb->micros ? 1 : -1;
+	return strcmp(ra->name, rb->name);
+}
+
+// Everything recorded, busiest first; free() the result
+static profrow_t *P_ThinkProfileRows(size_t *numrows)
+{
+	profrow_t *rows = malloc((NUMMOBJTYPES + MAXPROFFUNCS) * sizeof (*rows));
+	size_t n = 0;
+	const char *name;
+	int i;
+
+	if (!rows)
+		I_Error("P_ThinkProfileRows: Out of memory");
+
+	for (i = 0; i < NUMMOBJTYPES; i++)
+	{
+		if (!mobjcalls[i])
+			continue;
+		snprintf(rows[n].name, sizeof (rows[n].name), "MT %d %s", i,
+			sprnames[states[mobjinfo[i].spawnstate].sprite]);
+		rows[n].kind = "mobj";
+		rows[n].micros = mobjmicros[i];
+		rows[n].calls = mobjcalls[i];
+		n++;
+	}
+
+	for (i = 0; i < MAXPROFFUNCS; i++)
+	{
+		if (!proffuncs[i].func)
+			continue;
+		if (proffuncs[i].action)
+		{
+			name = DEH_ActionName(proffuncs[i].func);
+			rows[n].kind = "action";
+		}
+		else
+		{
+			name = P_ThinkerName(proffuncs[i].func);
+			rows[n].kind = "thinker";
+		}
+		strlcpy(rows[n].name, name ? name : "unknown action", sizeof (rows[n].name));
+		rows[n].micros = proffuncs[i].micros;
+		rows[n].calls = proffuncs[i].calls;
+		n++;
+	}
+
+	qsort(rows, n, sizeof (*rows), P_CompareProfRows);
+	*numrows = n;
+	return rows;
+}
+
+static void P_ThinkProfileWriteCSV(const char *filename)
+{
+	FILE *f = fopen(filename, "w");
+	profrow_t *rows;
+	size_t i, n;
+
+	if (!f)
+	{
+		CONS_Printf("Couldn't open %s for writing\n", filename);
+		return;
+	}
+
+	rows = P_ThinkProfileRows(&n);
+	fprintf(f, "kind,name,calls,microseconds\n");
+	fprintf(f, "total,P_RunThinkers,%lu,%lu\n", proftics, (ULONG)profthinkmicros);
+	for (i = 0; i < n; i++)
+		fprintf(f, "%s,%s,%lu,%lu\n", rows[i].kind, rows[i].name, rows[i].calls, (ULONG)rows[i].micros);
+	free(rows);
+
+	fclose(f);
+	CONS_Printf("Wrote %"PRIdS" rows to %s\n", n + 1, filename);
+}
+
+/** \brief Time spent in each kind of thinker and action
+
+	"thinkprofile on" (or -thinkprofile) starts timing every thinker run
+	by P_RunThinkers, with mobjs split up by type, and every state action.
+	"thinkprofile [time|calls]" lists the busiest, "thinkprofile csv <file>"
+	writes everything to srb2home and "thinkprofile reset" clears it.
+*/
+void Command_Thinkprofile_f(void)
+{
+	const char *arg = COM_Argc() > 1 ? COM_Argv(1) : "";
+	profrow_t *rows;
+	size_t i, n;
+
+	if (!stricmp(arg, "on"))
+	{
+		thinkprofiling = true;
+		CONS_Printf("Thinker profiling on\n");
+		return;
+	}
+	else if (!stricmp(arg, "off"))
+	{
+		thinkprofiling = false;
+		CONS_Printf("Thinker profiling off\n");
+		return;
+	}
+	else if (!stricmp(arg, "reset"))
+	{
+		P_ResetThinkProfile();
+		return;
+	}
+	else if (!stricmp(arg, "csv"))
+	{
+		if (COM_Argc() < 3)
+			CONS_Printf("thinkprofile csv <filename>\n");
+		else
+			P_ThinkProfileWriteCSV(va("%s"PATHSEP"%s", srb2home, COM_Argv(2)));
+		return;
+	}
+	else if (!stricmp(arg, "calls"))
+		profbycalls = true;
+	else if (!stricmp(arg, "time") || !*arg)
+		profbycalls = false;
+	else
+	{
+		CONS_Printf("thinkprofile on|off|reset|csv <file>\n"
+					"thinkprofile [time|calls]: list the busiest thinkers and actions\n");
+		return;
+	}
+
+	if (!proftics)
+	{
+		CONS_Printf("Nothing recorded, use \"thinkprofile on\"\n");
+		return;
+	}
+
+	CONS_Printf("%lu tics, %lu us per tic in thinkers\n", proftics, (ULONG)(profthinkmicros/proftics));
+
+	rows = P_ThinkProfileRows(&n);
+	CONS_Printf("\2Name                   Kind       Calls     Total ms  us/call   %%\n");
+	for (i = 0; i < n && i < 20; i++)
+		CONS_Printf("%-22.22s %-7s %8lu %12lu %8lu %3lu\n", rows[i].name, rows[i].kind,
+			rows[i].calls, (ULONG)(rows[i].micros/1000), (ULONG)(rows[i].micros/rows[i].calls),
+			profthinkmicros ? (ULONG)(rows[i].micros*100/profthinkmicros) : 0);
+	free(rows);
+}
+
 //
 // P_InitThinkers
 //
 void P_InitThinkers(void)
 {
+	int i;
+
 	thinkercap.prev = thinkercap.next = &thinkercap;
+	for (i = 0; i < NUM_THINKERLISTS; i++)
+		thlist[i].cprev = thlist[i].cnext = &thlist[i];
 }
 
 //
 // P_AddThinker
-// Adds a new thinker at the end of the list.
+// Adds a new thinker at the end of the list, and at the end of
+// the list for its class.
 //
-void P_AddThinker(thinker_t *thinker)
+void P_AddThinker(const thinklistnum_t n, thinker_t *thinker)
 {
 	thinkercap.prev->next = thinker;
 	thinker->next = &thinkercap;
 	thinker->prev = thinkercap.prev;
 	thinkercap.prev = thinker;
 
+	thlist[n].cprev->cnext = thinker;
+	thinker->cnext = &thlist[n];
+	thinker->cprev = thlist[n].cprev;
+	thlist[n].cprev = thinker;
+
 	thinker->references = 0;    // killough 11/98: init reference counter to 0
 }
 
@@ -185,6 +494,9 @@ void P_RemoveThinkerDelayed(void *pthinker)
 			 * point it to thinker->prev, so the iterator will correctly move on to
 			 * thinker->prev->next = thinker->next */
 			(next->prev = currentthinker = thinker->prev)->next = next;
+
+			/* And from the list for its class */
+			(thinker->cnext->cprev = thinker->cprev)->cnext = thinker->cnext;
 		}
 
 		Z_Free(thinker); // NEVER EVER TOUCH THIS! (otherwise lots of crashes ensue)
@@ -244,15 +556,79 @@ mobj_t *P_SetTarget(mobj_t **mop, mobj_t *targ)
 // Rewritten to delete nodes implicitly, by making currentthinker
 // external and using P_RemoveThinkerDelayed() implicitly.
 //
+static void P_RunThinkersProfiled(void)
+{
+	const UINT64 tickstart = I_GetTimeMicros();
+	UINT64 start;
+	actionf_p1 func;
+	int type;
+
+	for (currentthinker = thinkercap.next; currentthinker != &thinkercap; currentthinker = currentthinker->next)
+	{
+		func = currentthinker->function.acp1;
+
+		if (func != (actionf_p1)P_MobjThinker)
+			P_ClearSightCache();
+
+		if (!func)
+			continue;
+
+		// the mobj may be gone afterwards
+		type = func == (actionf_p1)P_MobjThinker ? (int)((mobj_t *)currentthinker)->type : -1;
+
+		start = I_GetTimeMicros();
+		func(currentthinker);
+
+		if (type >= 0)
+		{
+			mobjmicros[type] += I_GetTimeMicros() - start;
+			mobjcalls[type]++;
+		}
+		else
+			P_AddProfile(func, false, I_GetTimeMicros() - start);
+	}
+
+	profthinkmicros += I_GetTimeMicros() - tickstart;
+	proftics++;
+}
+
 static inline void P_RunThinkers(void)
 {
+	if (thinkprofiling)
+	{
+		P_RunThinkersProfiled();
+		return;
+	}
+
 	for (currentthinker = thinkercap.next; currentthinker != &thinkercap; currentthinker = currentthinker->next)
 	{
+		// Anything but a mobj might move a floor, a polyobject or an FOF,
+		// so sight lines can only be remembered across runs of mobjs.
+		if (currentthinker->function.acp1 != (actionf_p1)P_MobjThinker)
+			P_ClearSightCache();
+
 		if (currentthinker->function.acp1)
 			currentthinker->function.acp1(currentthinker);
 	}
 }
 
+boolean tickphasetiming = false;
+UINT64 tickphasemicros[NUMTICKPHASES];
+static UINT64 tickphasestart;
+
+// Charges the time since the last phase ended to this one
+static void P_EndTickPhase(tickphase_t phase)
+{
+	UINT64 now;
+
+	if (!tickphasetiming)
+		return;
+
+	now = I_GetTimeMicros();
+	tickphasemicros[phase] += now - tickphasestart;
+	tickphasestart = now;
+}
+
 //
 // P_DoAutobalanceTeams()
 //
@@ -370,8 +746,14 @@ void P_Ticker(void)
 
 	postimgtype = postimg_none;
 
+	if (tickphasetiming)
+		tickphasestart = I_GetTimeMicros();
+
 	P_MapStart();
 
+	// Sight lines are only remembered within a tic
+	P_ClearSightCache();
+
 	for (i = 0; i < MAXPLAYERS; i++)
 	{
 		if (playeringame[i] && players[i].mo)
@@ -391,6 +773,8 @@ void P_Ticker(void)
 		}
 	}
 
+	P_EndTickPhase(TICKPHASE_PLAYERS);
+
 	// Keep track of how long they've been playing!
 	totalplaytime++;
 
@@ -479,7 +863,12 @@ void P_Ticker(void)
 	if (runemeraldmanager)
 		P_EmeraldManager(); // Power stone mode
 
+	P_EndTickPhase(TICKPHASE_OTHER);
+
 	P_RunThinkers();
+	P_RunPrecipitation();
+
+	P_EndTickPhase(TICKPHASE_THINKERS);
 
 	// Run any "after all the other thinkers" stuff
 	for (i = 0; i < MAXPLAYERS; i++)
@@ -488,9 +877,16 @@ void P_Ticker(void)
 			P_PlayerAfterThink(&players[i]);
 	}
 
+	P_EndTickPhase(TICKPHASE_AFTERTHINK);
+
 	P_UpdateSpecials();
+
+	P_EndTickPhase(TICKPHASE_SPECIALS);
+
 	P_RespawnSpecials();
 
+	P_EndTickPhase(TICKPHASE_RESPAWN);
+
 	if (cv_objectplace.value)
 	{
 		objectsdrawn = 0;
@@ -590,5 +986,7 @@ void P_Ticker(void)
 	if (countdown2)
 		countdown2--;
 
+	P_EndTickPhase(TICKPHASE_OTHER);
+
 	P_MapEnd();
 }
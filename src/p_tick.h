@@ -29,6 +29,29 @@ extern tic_t leveltime;
 // Called by G_Ticker. Carries out all thinking of enemies and players.
 void Command_Numthinkers_f(void);
 void Command_CountMobjs_f(void);
+void Command_Thinkprofile_f(void);
+
+// Thinker profiler, see Command_Thinkprofile_f
+extern boolean thinkprofiling;
+void P_ProfileAction(actionf_p1 action, void *mo);
+
+// Runs a state's action, timing it while thinkprofile is on
+#define P_RunStateAction(action, mo) (thinkprofiling ? P_ProfileAction(action, mo) : (action)(mo))
+
+// Where P_Ticker spends its time, added up while tickphasetiming is set
+typedef enum
+{
+	TICKPHASE_PLAYERS,    // P_PlayerThink and bot thinking
+	TICKPHASE_THINKERS,   // P_RunThinkers and precipitation
+	TICKPHASE_AFTERTHINK, // P_PlayerAfterThink
+	TICKPHASE_SPECIALS,   // P_UpdateSpecials
+	TICKPHASE_RESPAWN,    // P_RespawnSpecials
+	TICKPHASE_OTHER,      // special stages, game modes and the rest
+	NUMTICKPHASES
+} tickphase_t;
+
+extern boolean tickphasetiming;
+extern UINT64 tickphasemicros[NUMTICKPHASES];
 
 void P_Ticker(void);
 void P_DoTeamscrambling(void);
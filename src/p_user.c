@@ -292,7 +292,7 @@ byte P_FindLowestMare(void)
 
 	// scan the thinkers
 	// to find the egg capsule with the lowest mare
-	for (th = thinkercap.next; th != &thinkercap; th = th->next)
+	for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 	{
 		if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 			continue;
@@ -341,7 +341,7 @@ boolean P_TransferToNextMare(player_t *player)
 
 	// scan the thinkers
 	// to find the closest axis point
-	for (th = thinkercap.next; th != &thinkercap; th = th->next)
+	for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 	{
 		if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 			continue;
@@ -392,7 +392,7 @@ static mobj_t *P_FindAxis(int mare, int axisnum)
 
 	// scan the thinkers
 	// to find the closest axis point
-	for (th = thinkercap.next; th != &thinkercap; th = th->next)
+	for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 	{
 		if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 			continue;
@@ -425,7 +425,7 @@ static mobj_t *P_FindAxisTransfer(int mare, int axisnum, mobjtype_t type)
 
 	// scan the thinkers
 	// to find the closest axis point
-	for (th = thinkercap.next; th != &thinkercap; th = th->next)
+	for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 	{
 		if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 			continue;
@@ -465,7 +465,7 @@ void P_TransferToAxis(player_t *player, int axisnum)
 
 	// scan the thinkers
 	// to find the closest axis point
-	for (th = thinkercap.next; th != &thinkercap; th = th->next)
+	for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 	{
 		if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 			continue;
@@ -579,7 +579,7 @@ static void P_DeNightserizePlayer(player_t *player)
 		player->exiting = TICRATE * 3;
 
 	// Check to see if the player should be killed.
-	for (th = thinkercap.next; th != &thinkercap; th = th->next)
+	for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 	{
 		if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 			continue;
@@ -3409,7 +3409,7 @@ static void P_NightsTransferPoints(player_t *player, fixed_t xspeed, fixed_t rad
 		vertex_t vertices[4];
 
 		// Find next waypoint
-		for (th = thinkercap.next; th != &thinkercap; th = th->next)
+		for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 		{
 			if (th->function.acp1 != (actionf_p1)P_MobjThinker) // Not a mobj thinker
 				continue;
@@ -3445,7 +3445,7 @@ static void P_NightsTransferPoints(player_t *player, fixed_t xspeed, fixed_t rad
 		// Look for a wrapper point.
 		if (!transfer1)
 		{
-			for (th = thinkercap.next; th != &thinkercap; th = th->next)
+			for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 			{
 				if (th->function.acp1 != (actionf_p1)P_MobjThinker) // Not a mobj thinker
 					continue;
@@ -3473,7 +3473,7 @@ static void P_NightsTransferPoints(player_t *player, fixed_t xspeed, fixed_t rad
 		}
 		if (!transfer2)
 		{
-			for (th = thinkercap.next; th != &thinkercap; th = th->next)
+			for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 			{
 				if (th->function.acp1 != (actionf_p1)P_MobjThinker) // Not a mobj thinker
 					continue;
@@ -3842,7 +3842,7 @@ static void P_NiGHTSMovement(player_t *player) // SRB2CBTODO: P_Angle2DMovement
 
 		// scan the thinkers
 		// to find the closest axis point
-		for (th = thinkercap.next; th != &thinkercap; th = th->next)
+		for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 		{
 			if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 				continue;
@@ -4087,7 +4087,7 @@ static void P_NiGHTSMovement(player_t *player) // SRB2CBTODO: P_Angle2DMovement
 			vertex_t vertices[4];
 
 			// Find next waypoint
-			for (th = thinkercap.next; th != &thinkercap; th = th->next)
+			for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 			{
 				if (th->function.acp1 != (actionf_p1)P_MobjThinker) // Not a mobj thinker
 					continue;
@@ -4123,7 +4123,7 @@ static void P_NiGHTSMovement(player_t *player) // SRB2CBTODO: P_Angle2DMovement
 			// Look for a wrapper point.
 			if (!transfer1)
 			{
-				for (th = thinkercap.next; th != &thinkercap; th = th->next)
+				for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 				{
 					if (th->function.acp1 != (actionf_p1)P_MobjThinker) // Not a mobj thinker
 						continue;
@@ -4151,7 +4151,7 @@ static void P_NiGHTSMovement(player_t *player) // SRB2CBTODO: P_Angle2DMovement
 			}
 			if (!transfer2)
 			{
-				for (th = thinkercap.next; th != &thinkercap; th = th->next)
+				for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 				{
 					if (th->function.acp1 != (actionf_p1)P_MobjThinker) // Not a mobj thinker
 						continue;
@@ -4619,7 +4619,7 @@ static void P_NiGHTSMovement(player_t *player) // Normal nights code
 
 		// scan the thinkers
 		// to find the closest axis point
-		for (th = thinkercap.next; th != &thinkercap; th = th->next)
+		for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 		{
 			if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 				continue;
@@ -6474,7 +6474,7 @@ static void P_ObjectplaceMovement(player_t *player)
 		boolean done = false;
 
 		// scan the thinkers
-		for (th = thinkercap.next; th != &thinkercap; th = th->next)
+		for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 		{
 			if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 				continue;
@@ -6660,7 +6660,7 @@ static boolean P_RingNearby(player_t *player) // Is a ring in range?
 	thinker_t *think;
 	mobj_t *closest = NULL;
 
-	for (think = thinkercap.next; think != &thinkercap; think = think->next)
+	for (think = thlist[THINK_MOBJ].cnext; think != &thlist[THINK_MOBJ]; think = think->cnext)
 	{
 		if (think->function.acp1 != (actionf_p1)P_MobjThinker) // Not a mobj thinker
 			continue;
@@ -6760,61 +6760,42 @@ static void P_LightDash(mobj_t *source, mobj_t *enemy) // Home in on your target
 
 
 
-static void P_LookForRings(player_t *player)
+static boolean P_LightDashRingCheck(mobj_t *mo, mobj_t *searcher)
 {
-	mobj_t *mo;
-	thinker_t *think;
-	boolean found = false;
-
-	player->mo->target = player->mo->tracer = NULL;
-
-	for (think = thinkercap.next; think != &thinkercap; think = think->next)
-	{
-		if (think->function.acp1 != (actionf_p1)P_MobjThinker) // Not a mobj thinker
-			continue;
-
-		mo = (mobj_t *)think;
-		if ((mo->health <= 0) || (mo->state == &states[S_DISS])) // Not a valid ring
-			continue;
-
-		if (!(mo->type == MT_RING))
-			continue;
-
-		if (player->powers[pw_flashing])
-		{
-			//player->lightdash = 0;
-			continue;
-		}
+	if ((mo->health <= 0) || (mo->state == &states[S_DISS])) // Not a valid ring
+		return false;
 
-		if (((player->mo->flags2 & MF2_TWOD) || twodlevel)
-			&& ((mo->y > player->mo->y+16*FRACUNIT) || (mo->y < player->mo->y-16*FRACUNIT)))
-			continue;
+	if (((searcher->flags2 & MF2_TWOD) || twodlevel)
+		&& ((mo->y > searcher->y+16*FRACUNIT) || (mo->y < searcher->y-16*FRACUNIT)))
+		return false;
 
-		if (P_AproxDistance(P_AproxDistance(player->mo->x-mo->x, player->mo->y-mo->y),
-							player->mo->z-mo->z) > 256*FRACUNIT) // The higher this number is, the farther the game looks for the next ring
-			continue;
+	// We don't wanna be dashing into hurt bosses repeatedly.
+	if (mo->flags2 & MF2_FRET)
+		return false;
 
-		if (!P_CheckSight(player->mo, mo)) // Out of sight
-			continue;
+	return P_CheckSight(searcher, mo); // Out of sight?
+}
 
-		if (player->mo->target && P_AproxDistance(P_AproxDistance(player->mo->x-mo->x,
-																  player->mo->y-mo->y), player->mo->z-mo->z) >
-			P_AproxDistance(P_AproxDistance(player->mo->x-player->mo->target->x,
-											player->mo->y-player->mo->target->y), player->mo->z-player->mo->target->z))
-			continue;
+static void P_LookForRings(player_t *player)
+{
+	thingsearch_t search;
+	mobj_t *mo = NULL;
 
-		// We don't wanna be dashing into hurt bosses repeatedly.
-		if (mo->flags2 & MF2_FRET)
-			continue;
+	player->mo->target = player->mo->tracer = NULL;
 
-		// Found a target
-		found = true;
-		player->mo->target = mo;
-		player->mo->tracer = mo;
+	if (!player->powers[pw_flashing])
+	{
+		P_InitThingSearch(&search, player->mo);
+		search.type = MT_RING;
+		search.check = P_LightDashRingCheck;
+		// The higher this number is, the farther the game looks for the next ring
+		mo = P_SearchNearestThing(&search, 256*FRACUNIT);
 	}
 
-	if (found)
+	if (mo)
 	{
+		// Found a target
+		player->mo->target = player->mo->tracer = mo;
 		P_ResetPlayer(player);
 		P_SetPlayerMobjState(player->mo, S_PLAY_FALL1);
 		P_ResetScore(player);
@@ -6886,7 +6867,7 @@ static void P_DrawRings(player_t *player) // SRB2CBTODO: Needed to be global?
 	fixed_t y = player->mo->y;
 	fixed_t z = player->mo->z;
 
-	for (th = thinkercap.next; th != &thinkercap; th = th->next)
+	for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 	{
 		if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 			continue;
@@ -7031,7 +7012,7 @@ static void P_CheckNiGHTsCapsule(player_t *player)
 		thinker_t *th;
 		mobj_t *mo2;
 
-		for (th = thinkercap.next; th != &thinkercap; th = th->next)
+		for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 		{
 			if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 				continue;
@@ -7663,7 +7644,7 @@ static void P_CheckPlayerClimb(player_t *player)
 				scroll_t *scroller;
 				angle_t sideangle;
 
-				for (think = thinkercap.next; think != &thinkercap; think = think->next)
+				for (think = thlist[THINK_SPECIAL].cnext; think != &thlist[THINK_SPECIAL]; think = think->cnext)
 				{
 					if (think->function.acp1 != (actionf_p1)T_Scroll)
 						continue;
@@ -9196,7 +9177,7 @@ static void P_MovePlayer(player_t *player)
 
 			S_StartSound(player->mo, sfx_shield);
 
-			for (think = thinkercap.next; think != &thinkercap; think = think->next)
+			for (think = thlist[THINK_MOBJ].cnext; think != &thlist[THINK_MOBJ]; think = think->cnext)
 			{
 				if (think->function.acp1 != (actionf_p1)P_MobjThinker) // Not a mobj thinker
 					continue;
@@ -10188,7 +10169,7 @@ static void P_DoZoomTube(player_t *player)
 			CONS_Printf("Looking for next waypoint...\n");
 
 		// Find next waypoint
-		for (th = thinkercap.next; th != &thinkercap; th = th->next)
+		for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 		{
 			if (th->function.acp1 != (actionf_p1)P_MobjThinker) // Not a mobj thinker
 				continue;
@@ -10357,7 +10338,7 @@ static void P_DoRopeHang(player_t *player, boolean minecart)
 			CONS_Printf("Looking for next waypoint...\n");
 
 		// Find next waypoint
-		for (th = thinkercap.next; th != &thinkercap; th = th->next)
+		for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 		{
 			if (th->function.acp1 != (actionf_p1)P_MobjThinker) // Not a mobj thinker
 				continue;
@@ -10383,7 +10364,7 @@ static void P_DoRopeHang(player_t *player, boolean minecart)
 				CONS_Printf("Next waypoint not found, wrapping to start...\n");
 
 			// Wrap around back to first waypoint
-			for (th = thinkercap.next; th != &thinkercap; th = th->next)
+			for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 			{
 				if (th->function.acp1 != (actionf_p1)P_MobjThinker) // Not a mobj thinker
 					continue;
@@ -10497,7 +10478,7 @@ static void P_NukeAllPlayers(player_t *player)
 	mobj_t *mo;
 	thinker_t *think;
 
-	for (think = thinkercap.next; think != &thinkercap; think = think->next)
+	for (think = thlist[THINK_MOBJ].cnext; think != &thlist[THINK_MOBJ]; think = think->cnext)
 	{
 		if (think->function.acp1 != (actionf_p1)P_MobjThinker)
 			continue; // not a mobj thinker
@@ -10541,7 +10522,7 @@ void P_NukeEnemies(player_t *player)
 		mo->momy = FixedMul(FINECOSINE(fa),ns)/NEWTICRATERATIO;
 	}
 
-	for (think = thinkercap.next; think != &thinkercap; think = think->next)
+	for (think = thlist[THINK_MOBJ].cnext; think != &thlist[THINK_MOBJ]; think = think->cnext)
 	{
 		if (think->function.acp1 != (actionf_p1)P_MobjThinker)
 			continue; // not a mobj thinker
@@ -10572,71 +10553,51 @@ void P_NukeEnemies(player_t *player)
 // Looks for something you can hit - Used for homing attack
 // Includes monitors and springs!
 //
-boolean P_LookForEnemies(player_t *player)
+static boolean P_HomingTargetCheck(mobj_t *mo, mobj_t *searcher)
 {
-	mobj_t *mo;
-	thinker_t *think;
-	mobj_t *closestmo = NULL;
 	angle_t an;
 
-	for (think = thinkercap.next; think != &thinkercap; think = think->next)
-	{
-		if (think->function.acp1 != (actionf_p1)P_MobjThinker)
-			continue; // not a mobj thinker
-
-		mo = (mobj_t *)think;
-		if (!(mo->flags & MF_ENEMY || mo->flags & MF_BOSS || mo->flags & MF_MONITOR
-			|| mo->flags & MF_SPRING))
-		{
-			continue; // not a valid enemy
-		}
-
-		if (mo->health <= 0) // dead
-			continue;
-
-		if (mo == player->mo)
-			continue;
-
-		if (mo->flags2 & MF2_FRET)
-			continue;
+	if (mo->health <= 0) // dead
+		return false;
 
-		if (mo->type == MT_DETON) // Don't be STUPID, Sonic!
-			continue;
+	if (mo->flags2 & MF2_FRET)
+		return false;
 
-		if (mo->flags & MF_MONITOR && mo->state == &states[S_MONITOREXPLOSION5])
-			continue;
+	if (mo->type == MT_DETON) // Don't be STUPID, Sonic!
+		return false;
 
-		if (mo->z > player->mo->z+MAXSTEPMOVE)
-			continue; // Don't home upwards!
+	if (mo->flags & MF_MONITOR && mo->state == &states[S_MONITOREXPLOSION5])
+		return false;
 
-		if (P_AproxDistance(P_AproxDistance(player->mo->x-mo->x, player->mo->y-mo->y),
-			player->mo->z-mo->z) > 512*FRACUNIT)
-			continue; // out of range
+	if (mo->z > searcher->z+MAXSTEPMOVE)
+		return false; // Don't home upwards!
 
-		if (mo->type == MT_PLAYER) // Don't chase after other players!
-			continue;
+	if (mo->type == MT_PLAYER) // Don't chase after other players!
+		return false;
 
-		if (closestmo && P_AproxDistance(P_AproxDistance(player->mo->x-mo->x, player->mo->y-mo->y),
-			player->mo->z-mo->z) > P_AproxDistance(P_AproxDistance(player->mo->x-closestmo->x,
-			player->mo->y-closestmo->y), player->mo->z-closestmo->z))
-			continue;
+	an = R_PointToAngle2(searcher->x, searcher->y, mo->x, mo->y) - searcher->angle;
 
-		an = R_PointToAngle2(player->mo->x, player->mo->y, mo->x, mo->y) - player->mo->angle;
+	if (an > ANG90 && an < ANG270)
+		return false; // behind back
 
-		if (an > ANG90 && an < ANG270)
-			continue; // behind back
+	return P_CheckSight(searcher, mo); // out of sight?
+}
 
-		player->mo->angle = R_PointToAngle2(player->mo->x, player->mo->y, mo->x, mo->y);
+boolean P_LookForEnemies(player_t *player)
+{
+	thingsearch_t search;
+	mobj_t *closestmo;
 
-		if (!P_CheckSight(player->mo, mo))
-			continue; // out of sight
+	P_InitThingSearch(&search, player->mo);
+	search.flags = MF_ENEMY|MF_BOSS|MF_MONITOR|MF_SPRING;
+	search.check = P_HomingTargetCheck;
 
-		closestmo = mo;
-	}
+	closestmo = P_SearchNearestThing(&search, 512*FRACUNIT);
 
 	if (closestmo)
 	{
 		// Found a target enemy
+		player->mo->angle = R_PointToAngle2(player->mo->x, player->mo->y, closestmo->x, closestmo->y);
 		P_SetTarget(&player->mo->target, P_SetTarget(&player->mo->tracer, closestmo));
 		return true;
 	}
@@ -10713,7 +10674,7 @@ void P_FindEmerald(void)
 
 	// scan the remaining thinkers
 	// to find all emeralds
-	for (th = thinkercap.next; th != &thinkercap; th = th->next)
+	for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 	{
 		if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 			continue;
@@ -11138,7 +11099,7 @@ void P_MoveChaseCamera(player_t *player, camera_t *thiscam, boolean netcalled)
 
 			// scan the remaining thinkers
 			// to find a boss
-			for (th = thinkercap.next; th != &thinkercap; th = th->next)
+			for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 			{
 				if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 					continue;
@@ -12026,241 +11987,188 @@ static inline void JB_UpdateLook(bot_t *bot)
 // SEARCH FUNCTIONS //
 //////////////////////
 
+// Rings, weapon pickups and air, anything a bot wants to run into
+static boolean JB_IsPickup(mobjtype_t type)
+{
+	switch (type)
+	{
+		case MT_RING:
+		case MT_COIN:
+		case MT_FLINGRING:
+		case MT_FLINGCOIN:
+		case MT_BOUNCERING:
+		case MT_RAILRING:
+		case MT_SCATTERRING:
+		case MT_AUTOMATICRING:
+		case MT_GRENADERING:
+		case MT_EXPLOSIONRING:
+
+		case MT_BOUNCEPICKUP:
+		case MT_RAILPICKUP:
+		case MT_SCATTERPICKUP:
+		case MT_AUTOPICKUP:
+		case MT_GRENADEPICKUP:
+		case MT_EXPLODEPICKUP:
+
+		case MT_EXTRALARGEBUBBLE: // Take bubbles too!
+			return true;
+		default:
+			return false;
+	}
+}
+
+static boolean JB_CollectCheck(mobj_t *mo, mobj_t *botmo)
+{
+	if (JB_IsPickup(mo->type))
+	{
+		// Yes! It's a ring! Score! :D
+		// Can't see it or don't think you can jump to it? Too bad...
+		return (mo->z < botmo->z + (128<<FRACBITS)
+			&& P_CheckSight(botmo,mo));
+	}
+
+	if (mo->type == MT_PLAYER)
+		return false;
+
+	// Monitor? Go for it.
+	if (mo->flags & MF_MONITOR
+	   && !(mo->flags & MF_NOCLIP)
+	   && mo->health
+	   && mo->z < botmo->z + (128<<FRACBITS)
+	   && P_CheckSight(botmo,mo))
+		return true;
+
+	// Check if a spring is the closest thing to you.
+	// Only use it if you're within stepping distance
+	// as well as closer to you then anything else
+	// that you find... Otherwise, forget it.
+	if (mo->flags & MF_SPRING
+	   && botmo->state-states != S_PLAY_PLG1
+	   && abs(botmo->z - mo->z) < 128<<FRACBITS
+	   && P_CheckSight(botmo,mo))
+		return true;
+
+	// Not anything I need to look at.
+	return false;
+}
+
 static mobj_t *JB_Look4Collect(int botnum)
 {
-	thinker_t* think;
-	mobj_t *mo, *lastmo, *botmo;
+	thingsearch_t search;
+	mobj_t *mo, *botmo;
 	botmo = players[botnum].mo;
 	//bot_t *bot = &bots[botnum]; // To identify bot by itself (left here just in case it could be useful)
-	fixed_t dist,lastdist;
+	fixed_t dist;
+	int i;
 
-	for (think = thinkercap.next, mo = lastmo = NULL, lastdist = 0;
-		think != &thinkercap; think = think->next)
+	for (i = 0; i < MAXPLAYERS; i++)
 	{
-		if (think->function.acp1 != (actionf_p1)P_MobjThinker) // Not a mobj thinker
+		if (!playeringame[i])
 			continue;
 
-		mo = (mobj_t*)think;
+		mo = players[i].mo;
 
-		if (botmo == mo)
+		if (!mo || botmo == mo)
 			continue;
-		switch(mo->type)
-		{
-			case MT_PLAYER:
-				// If it's not REALLY a player or if it's not alive
-				// just skip it... No point in worrying.
-				if (!mo->player
-				   || mo->player->playerstate != PST_LIVE
-				   || mo->player->powers[pw_flashing]
-				   || mo->player->powers[pw_invulnerability]
-					|| mo->player->spectator)
-					continue;
-				// Spectator
-				if (gametype == GT_CTF && !mo->player->ctfteam)
-					continue;
-				// Same team
-				if (gametype == GT_CTF && mo->player->ctfteam == botmo->player->ctfteam)
-					continue;
-				if (gametype == GT_MATCH && GTF_TEAMMATCH == 1
-				   && mo->player->skincolor == botmo->player->skincolor)
-					continue;
-				if (gametype == GT_MATCH && GTF_TEAMMATCH == 2
-				   && mo->player->skin == botmo->player->skin)
-					continue;
-				// If player is not close, the bot cannot see them,
-				// or the bot doesn't have the rings to do anything about it anyway...
-				// So it does not worry.
-				dist = P_AproxDistance(P_AproxDistance(botmo->x - mo->x, botmo->y - mo->y), botmo->z - mo->z);
-				if (botmo->health <= 2
-				   || mo->z > botmo->z + (128<<FRACBITS)
-				   // Don't go after them if you're not flashing...
-				   || (!botmo->player->powers[pw_flashing]
-					   // And they're farther then 1024 units from you.
-					   && dist > (1024<<FRACBITS))
-				   || !P_CheckSight(botmo,mo))
-					continue;
-				// Otherwise... I worry.
-				// I can't look for rings if I'm being watched.
-				// I must fight, ready or not!
-				return mo;
-
-			case MT_RING:
-			case MT_COIN:
-			case MT_FLINGRING:
-			case MT_FLINGCOIN:
-			case MT_BOUNCERING:
-			case MT_RAILRING:
-			case MT_SCATTERRING:
-			case MT_AUTOMATICRING:
-			case MT_GRENADERING:
-			case MT_EXPLOSIONRING:
-
-			case MT_BOUNCEPICKUP:
-			case MT_RAILPICKUP:
-			case MT_SCATTERPICKUP:
-			case MT_AUTOPICKUP:
-			case MT_GRENADEPICKUP:
-			case MT_EXPLODEPICKUP:
 
-			case MT_EXTRALARGEBUBBLE: // Take bubbles too!
-				// Yes! It's a ring! Score! :D
-				if (mo->z < botmo->z + (128<<FRACBITS)
-				   && P_CheckSight(botmo,mo))
-					break;
-				// Can't see it or don't think you can jump to it? Too bad...
-				continue;
-
-			default:
-				// Monitor? Go for it.
-				if (mo->flags & MF_MONITOR
-				   && !(mo->flags & MF_NOCLIP)
-				   && mo->health
-				   && mo->z < botmo->z + (128<<FRACBITS)
-				   && P_CheckSight(botmo,mo))
-					break;
-				// Check if a spring is the closest thing to you.
-				// Only use it if you're within stepping distance
-				// as well as closer to you then anything else
-				// that you find... Otherwise, forget it.
-				if (mo->flags & MF_SPRING
-				   && botmo->state-states != S_PLAY_PLG1
-				   && abs(botmo->z - mo->z) < 128<<FRACBITS
-				   && P_CheckSight(botmo,mo))
-					break;
-				// Not anything I need to look at.
-				continue;
-		}
+		// If it's not REALLY a player or if it's not alive
+		// just skip it... No point in worrying.
+		if (!mo->player
+		   || mo->player->playerstate != PST_LIVE
+		   || mo->player->powers[pw_flashing]
+		   || mo->player->powers[pw_invulnerability]
+			|| mo->player->spectator)
+			continue;
+		// Spectator
+		if (gametype == GT_CTF && !mo->player->ctfteam)
+			continue;
+		// Same team
+		if (gametype == GT_CTF && mo->player->ctfteam == botmo->player->ctfteam)
+			continue;
+		if (gametype == GT_MATCH && GTF_TEAMMATCH == 1
+		   && mo->player->skincolor == botmo->player->skincolor)
+			continue;
+		if (gametype == GT_MATCH && GTF_TEAMMATCH == 2
+		   && mo->player->skin == botmo->player->skin)
+			continue;
+		// If player is not close, the bot cannot see them,
+		// or the bot doesn't have the rings to do anything about it anyway...
+		// So it does not worry.
 		dist = P_AproxDistance(P_AproxDistance(botmo->x - mo->x, botmo->y - mo->y), botmo->z - mo->z);
-		if (lastmo && dist > lastdist) // Last one is closer to you?
+		if (botmo->health <= 2
+		   || mo->z > botmo->z + (128<<FRACBITS)
+		   // Don't go after them if you're not flashing...
+		   || (!botmo->player->powers[pw_flashing]
+			   // And they're farther then 1024 units from you.
+			   && dist > (1024<<FRACBITS))
+		   || !P_CheckSight(botmo,mo))
 			continue;
-
-		// Found a target
-		lastmo = mo;
-		lastdist = dist;
+		// Otherwise... I worry.
+		// I can't look for rings if I'm being watched.
+		// I must fight, ready or not!
+		return mo;
 	}
-	return lastmo;
+
+	// Otherwise the closest thing worth having
+	P_InitThingSearch(&search, botmo);
+	search.check = JB_CollectCheck;
+	return P_SearchNearestThing(&search, 0);
+}
+
+static boolean JB_PoppableCheck(mobj_t *mo, mobj_t *botmo)
+{
+	if (JB_IsPickup(mo->type))
+	{
+		// Yes! It's a ring! Score! :D
+		// Can't see it or don't think you can jump to it? Too bad...
+		return (mo->z < botmo->z + (128<<FRACBITS)
+			&& P_CheckSight(botmo,mo));
+	}
+
+	// Enemy? Boss? Monitor? Kill it!
+	// Otherwise it's not anything I need to look at.
+	return ((mo->flags & MF_ENEMY
+		|| mo->flags & MF_BOSS
+		|| (mo->flags & MF_MONITOR
+			&& !(mo->flags & MF_NOCLIP)
+			&& gametype != GT_COOP))
+	   && mo->health
+	   && mo->z < botmo->z + (128<<FRACBITS)
+	   && P_CheckSight(botmo,mo));
 }
 
 static mobj_t *JB_Look4Poppable(int botnum)
 {
-	thinker_t* think;
-	mobj_t *mo, *lastmo, *botmo = players[botnum].mo;
+	thingsearch_t search;
+	mobj_t *botmo = players[botnum].mo;
 	bot_t *bot = &bots[botnum];
-	fixed_t dist,lastdist;
 
 	// Simple co-op hack: Check things against your owner, rather then yourself.
 	if (gametype == GT_COOP)
 		botmo = players[bot->ownernum].mo;
 
-	for (think = thinkercap.next, mo = lastmo = NULL, lastdist = 0;
-		think != &thinkercap; think = think->next)
-	{
-		if (think->function.acp1 != (actionf_p1)P_MobjThinker) // Not a mobj thinker
-			continue;
-
-		mo = (mobj_t*)think;
-
-		if (botmo == mo)
-			continue;
-		switch(mo->type)
-		{
-			case MT_RING:
-			case MT_COIN:
-			case MT_FLINGRING:
-			case MT_FLINGCOIN:
-			case MT_BOUNCERING:
-			case MT_RAILRING:
-			case MT_SCATTERRING:
-			case MT_GRENADERING:
-			case MT_AUTOMATICRING:
-			case MT_EXPLOSIONRING:
+	P_InitThingSearch(&search, botmo);
+	search.check = JB_PoppableCheck;
 
-			case MT_BOUNCEPICKUP:
-			case MT_RAILPICKUP:
-			case MT_SCATTERPICKUP:
-			case MT_AUTOPICKUP:
-			case MT_GRENADEPICKUP:
-			case MT_EXPLODEPICKUP:
-
-			case MT_EXTRALARGEBUBBLE: // Take bubbles too!
-				// Yes! It's a ring! Score! :D
-				if (mo->z < botmo->z + (128<<FRACBITS)
-				   && P_CheckSight(botmo,mo))
-					break;
-				// Can't see it or don't think you can jump to it? Too bad...
-				continue;
-
-			default:
-				// Enemy? Boss? Monitor? Kill it!
-				if ((mo->flags & MF_ENEMY
-					|| mo->flags & MF_BOSS
-					|| (mo->flags & MF_MONITOR
-						&& !(mo->flags & MF_NOCLIP)
-						&& gametype != GT_COOP))
-				   && mo->health
-				   && mo->z < botmo->z + (128<<FRACBITS)
-				   && P_CheckSight(botmo,mo))
-					break;
-				// Not anything I need to look at.
-				continue;
-		}
-
-		// Ah, this makes things easier... Only calculate the distance once per mobj.
-		dist = P_AproxDistance(P_AproxDistance(botmo->x - mo->x, botmo->y - mo->y), botmo->z - mo->z);
-
-		// In co-op, never go after anything farther then 512 fracunits away.
-		if (gametype == GT_COOP && dist > 512<<FRACBITS)
-			continue;
-
-        // Last one is closer to you?
-		if (lastmo && dist > lastdist)
-			continue;
+	// In co-op, never go after anything farther then 512 fracunits away.
+	return P_SearchNearestThing(&search, gametype == GT_COOP ? 512<<FRACBITS : 0);
+}
 
-		// Found a target
-		lastmo = mo;
-		lastdist = dist;
-	}
-	return lastmo;
+static boolean JB_EnemyCheck(mobj_t *mo, mobj_t *botmo)
+{
+	return (mo->health
+		&& mo->z < botmo->z + (128<<FRACBITS)
+		&& P_CheckSight(botmo,mo));
 }
 
 static inline mobj_t *JB_Look4Enemy(int botnum)
 {
-	thinker_t* think;
-	mobj_t *mo, *lastmo, *botmo = players[botnum].mo;
-	//bot_t *bot = &bots[botnum]; // To identify bot by itself (left here just in case it could be useful)
-	fixed_t dist,lastdist;
-
-	for (think = thinkercap.next, mo = NULL, lastmo = NULL; think != &thinkercap; think = think->next)
-	{
-		if (think->function.acp1 != (actionf_p1)P_MobjThinker) // Not a mobj thinker
-			continue;
+	thingsearch_t search;
 
-		mo = (mobj_t*)think;
-
-		if (botmo == mo
-			)
-			continue;
-
-		// Not an enemy or boss? Dun need it.
-		if (!(mo->flags & MF_ENEMY
-			 || mo->flags & MF_BOSS)
-		   || !mo->health
-		   || mo->z >= botmo->z + (128<<FRACBITS)
-		   || !P_CheckSight(botmo,mo))
-			continue;
-
-		dist = P_AproxDistance(P_AproxDistance(botmo->x - mo->x, botmo->y - mo->y), botmo->z - mo->z);
-
-		// Found a target
-		lastmo = mo;
-		lastdist = dist;
-
-		if (lastmo && dist > lastdist) // Last one is closer to you?
-			continue;
-
-
-	}
-	return lastmo;
+	P_InitThingSearch(&search, players[botnum].mo);
+	search.flags = MF_ENEMY|MF_BOSS; // Not an enemy or boss? Dun need it.
+	search.check = JB_EnemyCheck;
+	return P_SearchNearestThing(&search, 0);
 }
 
 static mobj_t *JB_Look4Players(int botnum)
@@ -12270,8 +12178,8 @@ static mobj_t *JB_Look4Players(int botnum)
 	//bot_t *bot = &bots[botnum]; // To identify bot by itself (left here just in case it could be useful)
 	fixed_t dist,lastdist;
 
-	for (think = thinkercap.next, mo = lastmo = NULL, lastdist = 0;
-		think != &thinkercap; think = think->next)
+	for (think = thlist[THINK_MOBJ].cnext, mo = lastmo = NULL, lastdist = 0;
+		think != &thlist[THINK_MOBJ]; think = think->cnext)
 	{
 		if (think->function.acp1 != (actionf_p1)P_MobjThinker) // Not a mobj thinker
 			continue;
@@ -12359,7 +12267,7 @@ static inline mobj_t *JB_Look4BotOverlap(int botnum)
 	thinker_t* think;
 	mobj_t *mo, *botmo = players[botnum].mo;
 
-	for (think = thinkercap.next, mo = NULL; think != &thinkercap; think = think->next)
+	for (think = thlist[THINK_MOBJ].cnext, mo = NULL; think != &thlist[THINK_MOBJ]; think = think->cnext)
 	{
 		if (think->function.acp1 != (actionf_p1)P_MobjThinker) // Not a mobj thinker
 			continue;
@@ -12401,8 +12309,8 @@ static mobj_t *JB_Look4StarPost(int botnum)
 
 	//	if (botmo->
 
-	for (think = thinkercap.next, mo = lastmo = NULL, lastdist = 0;
-		think != &thinkercap; think = think->next)
+	for (think = thlist[THINK_MOBJ].cnext, mo = lastmo = NULL, lastdist = 0;
+		think != &thlist[THINK_MOBJ]; think = think->cnext)
 	{
 		if (think->function.acp1 != (actionf_p1)P_MobjThinker) // Not a mobj thinker
 			continue;
@@ -12436,40 +12344,16 @@ static mobj_t *JB_Look4StarPost(int botnum)
 
 static mobj_t *JB_Look4Spring(int botnum)
 {
-	thinker_t* think;
-	mobj_t *mo, *lastmo, *botmo = players[botnum].mo;
-	//bot_t *bot = &bots[botnum]; // To identify bot by itself (left here just in case it could be useful)
-	fixed_t dist,lastdist;
+	thingsearch_t search;
+	mobj_t *botmo = players[botnum].mo;
 
 	// Already springing? Don't look for another!
 	if (botmo->state-states == S_PLAY_PLG1)
 		return NULL;
 
-	for (think = thinkercap.next, mo = lastmo = NULL, lastdist = 0;
-		think != &thinkercap; think = think->next)
-	{
-		if (think->function.acp1 != (actionf_p1)P_MobjThinker) // Not a mobj thinker
-			continue;
-
-		mo = (mobj_t*)think;
-
-		if (!(mo->flags & MF_SPRING) // Not a spring...
-			)
-			continue;
-
-		dist = P_AproxDistance(P_AproxDistance(botmo->x - mo->x, botmo->y - mo->y), botmo->z - mo->z);
-		if (lastmo && dist > lastdist) // Last one is closer to you?
-			continue;
-
-		// Found a target
-		lastmo = mo;
-		lastdist = dist;
-
-		// This is probably the one they used, 'cause it's in it's bounce animation!
-		if (mo->state == &states[mo->info->seestate])
-			break;
-	}
-	return lastmo;
+	P_InitThingSearch(&search, botmo);
+	search.flags = MF_SPRING;
+	return P_SearchNearestThing(&search, 0);
 }
 
 static mobj_t *JB_Look4AirBubble(int botnum)
@@ -12478,8 +12362,8 @@ static mobj_t *JB_Look4AirBubble(int botnum)
 	mobj_t *mo, *lastmo, *botmo = players[botnum].mo;
 	fixed_t dist,lastdist;
 
-	for (think = thinkercap.next, mo = lastmo = NULL, lastdist = 0;
-		think != &thinkercap; think = think->next)
+	for (think = thlist[THINK_MOBJ].cnext, mo = lastmo = NULL, lastdist = 0;
+		think != &thlist[THINK_MOBJ]; think = think->cnext)
 	{
 		if (think->function.acp1 != (actionf_p1)P_MobjThinker) // Not a mobj thinker
 			continue;
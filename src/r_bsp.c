@@ -39,6 +39,8 @@ drawseg_t *drawsegs = NULL;
 drawseg_t *ds_p = NULL;
 drawseg_t *firstnewseg = NULL;
 
+renderusage_t drawsegusage = {"drawsegs", 0, 0, 0};
+
 // indicates doors closed wrt automap bugfix:
 boolean doorclosed;
 
@@ -48,11 +50,32 @@ boolean doorclosed;
 void R_ClearDrawSegs(void)
 {
 	ds_p = drawsegs;
+	drawsegusage.used = 0;
 }
 
 // newend is one past the last valid seg
 static cliprange_t *newend;
-static cliprange_t solidsegs[MAXSEGS];
+static cliprange_t *solidsegs = NULL;
+static size_t maxsolidsegs = 0;
+
+renderusage_t solidsegusage = {"solidsegs", 0, 0, 0};
+
+//
+// R_GrowSolidSegs
+// Doubles the room for clip posts. Anything but newend pointing into
+// the old array has to be moved by the caller.
+//
+static void R_GrowSolidSegs(void)
+{
+	size_t endpos = solidsegs ? (size_t)(newend - solidsegs) : 0;
+
+	maxsolidsegs = maxsolidsegs ? maxsolidsegs*2 : 64;
+	solidsegs = realloc(solidsegs, maxsolidsegs * sizeof (*solidsegs));
+	if (!solidsegs)
+		I_Error("R_GrowSolidSegs: out of memory for %"PRIdS" solid segs\n", maxsolidsegs);
+	solidsegusage.size = maxsolidsegs;
+	newend = solidsegs + endpos;
+}
 
 //
 // R_ClipSolidWallSegment
@@ -76,11 +99,16 @@ static void R_ClipSolidWallSegment(int first, int last)
 		{
 			// Post is entirely visible (above start), so insert a new clippost.
 			R_StoreWallRange(first, last);
+			// keep a spare post past newend, the crunch below reads one
+			if ((size_t)(newend - solidsegs) + 1 >= maxsolidsegs)
+			{
+				size_t pos = start - solidsegs;
+				R_GrowSolidSegs();
+				start = solidsegs + pos;
+			}
 			next = newend;
 			newend++;
-			// NO MORE CRASHING!
-			if (newend - solidsegs > MAXSEGS)
-				I_Error("R_ClipSolidWallSegment: Solid Segs overflow!\n");
+			R_NoteUsage(solidsegusage, (size_t)(newend - solidsegs));
 
 			while (next != start)
 			{
@@ -132,10 +160,6 @@ crunch:
 		*++start = *next; // Remove a post.
 
 	newend = start + 1;
-
-	// NO MORE CRASHING!
-	if (newend - solidsegs > MAXSEGS)
-		I_Error("R_ClipSolidWallSegment: Solid Segs overflow!\n");
 }
 
 //
@@ -189,11 +213,15 @@ static inline void R_ClipPassWallSegment(int first, int last)
 //
 void R_ClearClipSegs(void)
 {
+	if (!solidsegs)
+		R_GrowSolidSegs();
+
 	solidsegs[0].first = -0x7fffffff;
 	solidsegs[0].last = -1;
 	solidsegs[1].first = viewwidth;
 	solidsegs[1].last = 0x7fffffff;
 	newend = solidsegs + 2;
+	R_NoteUsage(solidsegusage, 2);
 }
 
 
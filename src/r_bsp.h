@@ -46,9 +46,6 @@ void R_ClearClipSegs(void);
 void R_ClearDrawSegs(void);
 void R_RenderBSPNode(int bspnum);
 
-// Fix from boom.
-#define MAXSEGS (MAXVIDWIDTH/2+1)
-
 #ifdef POLYOBJECTS
 void R_SortPolyObjects(subsector_t *sub);
 
@@ -29,6 +29,7 @@
 #include "z_zone.h"
 #include "p_setup.h" // levelflats
 #include "v_video.h" // pLocalPalette
+#include "i_threads.h"
 
 #ifdef HAVE_PNG
 #include "png.h"
@@ -102,6 +103,13 @@ size_t numtextures = 0; // total number of textures found,
 texture_t **textures = NULL;
 static ULONG **texturecolumnofs; // column offset lookup table for each texture
 static byte **texturecache; // graphics data for each generated full-size texture
+static size_t *texturetouched; // framecount when each texture was last Z_Touch'ed
+
+// Textures the level uses are composited into this one block when it
+// loads. They stay there until the next level, and are never purged.
+static byte *texturearena = NULL;
+static size_t texturearenasize = 0;
+#define R_TextureResident(data) (texturearena && (data) >= texturearena && (data) < texturearena + texturearenasize)
 
 // texture width is a power of 2, so it can easily repeat along sidedefs using a simple mask
 long *texturewidthmask;
@@ -170,6 +178,58 @@ static inline void R_DrawColumnInCache(column_t *patch, byte *cache, int originy
 	}
 }
 
+//
+// R_CopyPatchTexture
+// A single-patch texture is kept as the patch itself,
+// with the column offsets moved past each post's header.
+//
+static void R_CopyPatchTexture(size_t texnum, const patch_t *realpatch, byte *block, size_t blocksize)
+{
+	ULONG *colofs;
+	int i;
+
+	M_Memcpy(block, realpatch, blocksize);
+
+	// use the patch's column lookup
+	colofs = (ULONG *)(void *)(block + 8);
+	texturecolumnofs[texnum] = colofs;
+	for (i = 0; i < textures[texnum]->width; i++)
+		colofs[i] = LONG(LONG(colofs[i]) + 3);
+}
+
+//
+// R_DrawPatchInTexture
+// Composites the columns of one patch into a multi-patch texture,
+// filling in the column lookup at the start of the block as it goes.
+//
+static void R_DrawPatchInTexture(texture_t *texture, texpatch_t *patch, patch_t *realpatch, byte *block)
+{
+	ULONG *colofs = (ULONG *)(void *)block;
+	column_t *patchcol;
+	int x, x1, x2;
+
+	x1 = patch->originx;
+	x2 = x1 + SHORT(realpatch->width);
+
+	if (x1 < 0)
+		x = 0;
+	else
+		x = x1;
+
+	if (x2 > texture->width)
+		x2 = texture->width;
+
+	for (; x < x2; x++)
+	{
+		patchcol = (column_t *)((byte *)realpatch + LONG(realpatch->columnofs[x-x1]));
+
+		// generate column ofset lookup
+		colofs[x] = LONG((x * texture->height) + (texture->width*4));
+
+		R_DrawColumnInCache(patchcol, block + LONG(colofs[x]), patch->originy, texture->height);
+	}
+}
+
 //
 // R_GenerateTexture
 //
@@ -188,10 +248,8 @@ static byte *R_GenerateTexture(size_t texnum)
 	texture_t *texture;
 	texpatch_t *patch;
 	patch_t *realpatch;
-	int x, x1, x2, i;
+	int i;
 	size_t blocksize;
-	column_t *patchcol;
-	ULONG *colofs;
 
 	texture = textures[texnum];
 
@@ -218,15 +276,9 @@ static byte *R_GenerateTexture(size_t texnum)
 			textureheight[texnum] = realpatch->height<<FRACBITS; // Update the height
         }
 
-		M_Memcpy(block, realpatch, blocksize);
+		R_CopyPatchTexture(texnum, realpatch, block, blocksize);
 		texturememory += blocksize;
-
-		// use the patch's column lookup
-		colofs = (ULONG *)(void *)(block + 8);
-		texturecolumnofs[texnum] = colofs;
 		blocktex = block;
-		for (i = 0; i < texture->width; i++)
-			colofs[i] = LONG(LONG(colofs[i]) + 3);
 		goto done;
 	}
 
@@ -238,8 +290,7 @@ static byte *R_GenerateTexture(size_t texnum)
 	memset(block, 247, blocksize); // Transparency hack
 
 	// columns lookup table
-	colofs = (ULONG *)(void *)block;
-	texturecolumnofs[texnum] = colofs;
+	texturecolumnofs[texnum] = (ULONG *)(void *)block;
 
 	// texture data before the lookup table
 	blocktex = block + (texture->width*4);
@@ -262,27 +313,7 @@ static byte *R_GenerateTexture(size_t texnum)
 			textureheight[texnum] = realpatch->height<<FRACBITS; // Update the height
         }
 
-
-		x1 = patch->originx;
-		x2 = x1 + SHORT(realpatch->width);
-
-		if (x1 < 0)
-			x = 0;
-		else
-			x = x1;
-
-		if (x2 > texture->width)
-			x2 = texture->width;
-
-		for (; x < x2; x++)
-		{
-			patchcol = (column_t *)((byte *)realpatch + LONG(realpatch->columnofs[x-x1]));
-
-			// generate column ofset lookup
-			colofs[x] = LONG((x * texture->height) + (texture->width*4));
-
-			R_DrawColumnInCache(patchcol, block + LONG(colofs[x]), patch->originy, texture->height);
-		}
+		R_DrawPatchInTexture(texture, patch, realpatch, block);
 	}
 
 done:
@@ -304,6 +335,13 @@ byte *R_GetColumn(fixed_t tex, int col)
 
 	if (!data)
 		data = R_GenerateTexture(tex);
+	else if (texturetouched[tex] != framecount && !R_TextureResident(data))
+	{
+		// keep textures on screen from being purged,
+		// once a frame is enough for that
+		texturetouched[tex] = framecount;
+		Z_Touch(data);
+	}
 
 	return data + LONG(texturecolumnofs[tex][col]);
 }
@@ -315,6 +353,26 @@ byte *R_GetFlat(lumpnum_t flatlumpnum)
 	return W_CacheLumpNum(flatlumpnum, PU_CACHE);
 }
 
+//
+// R_FreeTextureArena
+// Forgets the textures composited at level load,
+// they get generated again when they are next used.
+//
+void R_FreeTextureArena(void)
+{
+	size_t i;
+
+	if (!texturearena)
+		return;
+
+	for (i = 0; i < numtextures; i++)
+		if (texturecache[i] && R_TextureResident(texturecache[i]))
+			texturecache[i] = NULL;
+
+	Z_Free(texturearena);
+	texturearenasize = 0;
+}
+
 //
 // Empty the texture cache (used for load wad at runtime)
 //
@@ -322,6 +380,7 @@ void R_FlushTextureCache(void)
 {
 	size_t i;
 
+	R_FreeTextureArena();
 	if (numtextures)
 		for (i = 0; i < numtextures; i++)
 			Z_Free(texturecache[i]);
@@ -350,12 +409,14 @@ void R_LoadTextures(void)
 	texture_t *texture;
 
 	// Free previous memory before numtextures change.
+	R_FreeTextureArena();
 	for (i = 0; i < numtextures; i++)
 	{
 		Z_Free(textures[i]);
 		Z_Free(texturecache[i]);
 	}
 	Z_Free(texturetranslation);
+	Z_Free(texturetouched);
 	
 	int lasttexamount = numtextures;
 
@@ -394,6 +455,7 @@ void R_LoadTextures(void)
 	textureheight    = (void *)((UINT8 *)textures + ((numtextures * sizeof(void *)) * 4));
 	// Create translation table for global animation.
 	texturetranslation = Z_Malloc((numtextures + 1) * sizeof(*texturetranslation), PU_STATIC, NULL);
+	texturetouched = Z_Calloc(numtextures * sizeof(*texturetouched), PU_STATIC, NULL);
 
 	for (i = 0; i < numtextures; i++)
 		texturetranslation[i] = i;
@@ -1154,6 +1216,165 @@ long R_TextureNumForName(const char *name, USHORT sidenum)
 	return i;
 }
 
+//
+// TEXTURE PRECOMPOSITION
+// When a level loads, every texture it can show is composited into
+// texturearena by the worker threads, so none has to be generated in
+// the middle of a frame. The zone isn't thread safe: the arena and all
+// the patches are got on the main thread, and the jobs only copy and
+// composite.
+//
+#define MAXTEXTUREJOBS 17 // the workers plus the main thread
+#define TEXTUREALIGNBITS 6 // each texture starts on its own cache line
+#define TEXTUREALIGN (1<<TEXTUREALIGNBITS)
+
+typedef struct
+{
+	size_t texnum;
+	byte *block;
+	size_t size;
+	patch_t **patches; // one for each of the texture's patches
+} precompose_t;
+
+typedef struct
+{
+	job_t job;
+	precompose_t *first, *last;
+} precomposejob_t;
+
+static void R_PrecomposeTextures(void *data)
+{
+	precomposejob_t *pj = data;
+	precompose_t *pc;
+	texture_t *texture;
+	int i;
+
+	for (pc = pj->first; pc < pj->last; pc++)
+	{
+		texture = textures[pc->texnum];
+
+		if (texture->patchcount == 1)
+		{
+			R_CopyPatchTexture(pc->texnum, pc->patches[0], pc->block, pc->size);
+			continue;
+		}
+
+		memset(pc->block, 247, pc->size); // Transparency hack
+		texturecolumnofs[pc->texnum] = (ULONG *)(void *)pc->block;
+		for (i = 0; i < texture->patchcount; i++)
+			R_DrawPatchInTexture(texture, &texture->patches[i], pc->patches[i], pc->block);
+	}
+}
+
+//
+// R_PrecomposeLevelTextures
+// Composites every texture marked in texturepresent into texturearena,
+// in runs of about the same size for each thread.
+// Returns the size of the arena.
+//
+static size_t R_PrecomposeLevelTextures(const char *texturepresent)
+{
+	precomposejob_t jobs[MAXTEXTUREJOBS];
+	precompose_t *list, *pc, *end;
+	patch_t **patchlist, **patches;
+	texture_t *texture;
+	size_t i, count = 0, numpatches = 0, total = 0, share, size;
+	int k, numjobs;
+
+	for (i = 0; i < numtextures; i++)
+	{
+		// textures loaded on the fly can change size when they are
+		// generated, they are still made one at a time
+		if (!texturepresent[i] || textures[i]->tx)
+			continue;
+		count++;
+		numpatches += textures[i]->patchcount;
+	}
+
+	if (!count)
+		return 0;
+
+	list = malloc(count * sizeof (*list));
+	patchlist = malloc((numpatches + 1) * sizeof (*patchlist));
+	if (!list || !patchlist)
+	{
+		// not fatal, R_GetColumn will generate them as they are used
+		free(list);
+		free(patchlist);
+		return 0;
+	}
+	end = list + count;
+
+	// lay the textures out in the arena
+	for (i = 0, pc = list; i < numtextures; i++)
+	{
+		if (!texturepresent[i] || textures[i]->tx)
+			continue;
+
+		texture = textures[i];
+
+		// anything generated before now is made again in the arena
+		Z_Free(texturecache[i]);
+
+		pc->texnum = i;
+		if (texture->patchcount == 1)
+			pc->size = W_LumpLength(texture->patches[0].patch);
+		else
+			pc->size = (texture->width * 4) + (texture->width * texture->height);
+		pc->block = (byte *)total; // an offset until the arena exists
+		total += (pc->size + TEXTUREALIGN - 1) & ~(size_t)(TEXTUREALIGN - 1);
+		pc++;
+	}
+
+	Z_MallocAlign(total, PU_STATIC, &texturearena, TEXTUREALIGNBITS);
+	texturearenasize = total;
+
+	// the patches have to stay where they are until the jobs are done
+	Z_HoldCache();
+	for (pc = list, patches = patchlist; pc < end; pc++)
+	{
+		texture = textures[pc->texnum];
+		pc->block = texturearena + (size_t)pc->block;
+		pc->patches = patches;
+		for (k = 0; k < texture->patchcount; k++)
+			*patches++ = W_CacheLumpNum(texture->patches[k].patch, PU_CACHE);
+	}
+
+	numjobs = I_NumWorkers() + 1;
+	if (numjobs > MAXTEXTUREJOBS)
+		numjobs = MAXTEXTUREJOBS;
+	share = total / numjobs + 1;
+
+	for (k = 0, pc = list; pc < end; k++)
+	{
+		// the last job takes whatever is left
+		jobs[k].first = pc;
+		for (size = 0; pc < end && (size < share || k == numjobs - 1); pc++)
+			size += pc->size;
+		jobs[k].last = pc;
+
+		jobs[k].job.func = R_PrecomposeTextures;
+		jobs[k].job.data = &jobs[k];
+		I_QueueJob(&jobs[k].job);
+	}
+
+	while (k--)
+		I_WaitJob(&jobs[k].job);
+	Z_ReleaseCache();
+
+	// resident until the next level
+	for (pc = list; pc < end; pc++)
+		texturecache[pc->texnum] = pc->block;
+
+	if (devparm)
+		CONS_Printf("R_PrecomposeLevelTextures: %"PRIdS" textures, %"PRIdS" k, %d threads\n",
+			count, total>>10, numjobs);
+
+	free(patchlist);
+	free(list);
+	return total;
+}
+
 //
 // R_PrecacheLevel
 //
@@ -1164,6 +1385,8 @@ void R_PrecacheLevel(void)
 	char *texturepresent, *spritepresent;
 	size_t i, j, k;
 	lumpnum_t lump;
+	lumpnum_t *prefetch;
+	size_t numprefetch = 0, maxprefetch;
 
 	thinker_t *th;
 	spriteframe_t *sf;
@@ -1175,11 +1398,8 @@ void R_PrecacheLevel(void)
 	if (rendermode != render_soft)
 		return;
 
-	// Precache flats.
-	flatmemory = P_PrecacheLevelFlats();
-
 	//
-	// Precache textures.
+	// Find the textures and sprites the level uses.
 	//
 	// no need to precache all software textures in 3D mode
 	// (note they are still used with the reference software view)
@@ -1204,12 +1424,59 @@ void R_PrecacheLevel(void)
 	// while the sky texture is stored like a wall texture, with a skynum dependent name.
 	texturepresent[skytexture] = 1;
 
-	texturememory = 0;
+	// and so are the other frames of any animation it uses
+	P_MarkAnimatedTextures(texturepresent);
+
+	spritepresent = calloc(numsprites, sizeof(*spritepresent));
+
+	for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
+		if (th->function.acp1 == (actionf_p1)P_MobjThinker)
+			spritepresent[((mobj_t *)th)->sprite] = 1;
+
+	//
+	// Start loading all of their lumps in the background,
+	// the loops below then only wait for what isn't ready yet.
+	//
+	maxprefetch = numlevelflats;
+	for (j = 0; j < numtextures; j++)
+		if (texturepresent[j] && !texturecache[j] && !textures[j]->tx)
+			maxprefetch += textures[j]->patchcount;
+	for (i = 0; i < numsprites; i++)
+		if (spritepresent[i])
+			maxprefetch += sprites[i].numframes * 8;
+
+	prefetch = malloc(maxprefetch * sizeof (*prefetch));
+	if (prefetch)
+	{
+		for (i = 0; i < numlevelflats; i++)
+			prefetch[numprefetch++] = levelflats[i].lumpnum;
+		for (j = 0; j < numtextures; j++)
+			if (texturepresent[j] && !texturecache[j] && !textures[j]->tx)
+				for (k = 0; k < (size_t)textures[j]->patchcount; k++)
+					prefetch[numprefetch++] = textures[j]->patches[k].patch;
+		for (i = 0; i < numsprites; i++)
+			if (spritepresent[i])
+				for (j = 0; j < sprites[i].numframes; j++)
+					for (k = 0; k < 8; k++)
+						prefetch[numprefetch++] = sprites[i].spriteframes[j].lumppat[k];
+
+		W_PrefetchLumps(prefetch, numprefetch);
+		free(prefetch);
+	}
+
+	// Precache flats.
+	flatmemory = P_PrecacheLevelFlats();
+
+	//
+	// Precache textures.
+	//
+	texturememory = R_PrecomposeLevelTextures(texturepresent);
 	for (j = 0; j < numtextures; j++)
 	{
 		if (!texturepresent[j])
 			continue;
 
+		// whatever couldn't be precomposed
 		if (!texturecache[j])
 			R_GenerateTexture(j);
 		// pre-caching individual patches that compose textures became obsolete,
@@ -1220,12 +1487,6 @@ void R_PrecacheLevel(void)
 	//
 	// Precache sprites.
 	//
-	spritepresent = calloc(numsprites, sizeof(*spritepresent));
-
-	for (th = thinkercap.next; th != &thinkercap; th = th->next)
-		if (th->function.acp1 == (actionf_p1)P_MobjThinker)
-			spritepresent[((mobj_t *)th)->sprite] = 1;
-
 	spritememory = 0;
 	for (i = 0; i < numsprites; i++)
 	{
@@ -68,6 +68,7 @@ extern CV_PossibleValue_t Color_cons_t[];
 void R_LoadTextures(void);
 void R_AddExtraTextures(void);
 void R_FlushTextureCache(void);
+void R_FreeTextureArena(void);
 
 // Retrieve column data for span blitting.
 byte *R_GetColumn(fixed_t tex, int col);
@@ -374,9 +374,12 @@ typedef struct sector_s
 	// Current speed of ceiling/floor. For Knuckles to hold onto stuff.
 	fixed_t floorspeed, ceilspeed;
 
-	// list of precipitation mobjs in sector
-	precipmobj_t *preciplist;
-	struct mprecipsecnode_s *touching_preciplist;
+	// precipitation drops in sector, see precipdrops_t
+	size_t firstprecip, numprecip;
+
+	// kept up to date as things move, so triggers needn't walk thing lists
+	size_t numenemies; // live enemies and bosses touching, see P_UpdateSectorEnemies
+	size_t numplayers; // player objects whose subsector is in this sector
 
 #ifdef ESLOPE
 	// Eternity engine slope
@@ -533,19 +536,9 @@ typedef struct msecnode_s
 	struct msecnode_s *m_sprev;  // prev msecnode_t for this sector
 	struct msecnode_s *m_snext;  // next msecnode_t for this sector
 	boolean visited; // used in search algorithms
+	boolean enemy; // counted in m_sector->numenemies
 } msecnode_t;
 
-typedef struct mprecipsecnode_s
-{
-	sector_t *m_sector; // a sector containing this object
-	struct precipmobj_s *m_thing;  // this object
-	struct mprecipsecnode_s *m_tprev;  // prev msecnode_t for this thing
-	struct mprecipsecnode_s *m_tnext;  // next msecnode_t for this thing
-	struct mprecipsecnode_s *m_sprev;  // prev msecnode_t for this sector
-	struct mprecipsecnode_s *m_snext;  // next msecnode_t for this sector
-	boolean visited; // used in search algorithms
-} mprecipsecnode_t;
-
 //
 // The lineseg.
 //
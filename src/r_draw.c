@@ -32,6 +32,7 @@
 #include "w_wad.h"
 #include "z_zone.h"
 #include "console.h" // Until buffering gets finished
+#include <time.h> // clock, for drawbench
 
 #ifdef HWRENDER
 #include "hardware/hw_main.h"
@@ -106,17 +107,17 @@ int dc_numlights = 0, dc_maxlights, dc_texheight;
 //                      SPAN DRAWING CODE STUFF
 // =========================================================================
 
-int ds_y, ds_x1, ds_x2;
-lighttable_t *ds_colormap;
-fixed_t ds_xfrac, ds_yfrac, ds_xstep, ds_ystep;
+RENDERTLS int ds_y, ds_x1, ds_x2;
+RENDERTLS lighttable_t *ds_colormap;
+RENDERTLS fixed_t ds_xfrac, ds_yfrac, ds_xstep, ds_ystep;
 
-byte *ds_source; // start of a 64*64 tile image
-byte *ds_transmap; // one of the translucency tables
+RENDERTLS byte *ds_source; // start of a 64*64 tile image
+RENDERTLS byte *ds_transmap; // one of the translucency tables
 
 /**	\brief Variable flat sizes
 */
 
-ULONG nflatxshift, nflatyshift, nflatshiftup, nflatmask;
+RENDERTLS ULONG nflatxshift, nflatyshift, nflatshiftup, nflatmask;
 
 // =========================================================================
 //                   TRANSLATION COLORMAP CODE
@@ -478,12 +479,486 @@ void R_VideoErase(unsigned int ofs, int count)
 void R_Throw(void);
 #endif
 
+// ==========================================================================
+//                          BUFFERED DRAWING
+// ==========================================================================
+//
+// While the solid walls, the sky and the floors and ceilings are rendered,
+// their columns and spans are written down as draw commands instead of
+// being drawn. R_FlushDrawCommands then sorts them by drawer and texture
+// and draws them all in one go. Every pixel of the solid pass is drawn
+// once, so the order they're drawn in doesn't change the picture.
+//
+
+#define MAXCMDDRAWERS 16
+
+/**	\brief	A column or span, with the drawer state it needs
+*/
+typedef struct
+{
+	byte *source;
+	lighttable_t *colormap;
+	byte *transmap;
+	fixed_t frac, step; // column: texturemid, iscale; span: xfrac, xstep
+	fixed_t yfrac, ystep; // span only
+	int texheight; // column: dc_texheight; span: nflatxshift
+	short x, y1, y2; // column: x, yl, yh; span: y, x1, x2
+	byte drawer; // index in cmddrawers
+} drawcmd_t;
+
+typedef struct
+{
+	void (*func)(void);
+	boolean span;
+	ULONG commands, pixels; // drawn last frame
+} cmddrawer_t;
+
+boolean batchingdraws = false;
+
+static drawcmd_t *drawcmds;
+static size_t numdrawcmds, maxdrawcmds;
+static cmddrawer_t cmddrawers[MAXCMDDRAWERS];
+static int numcmddrawers;
+static ULONG drawbatches; // drawer or texture changes in the last flush
+
+static boolean countoverdraw = false;
+static byte *overdraw; // times every pixel of the view was drawn
+static size_t overdrawsize;
+
+static drawcmd_t *R_NewDrawCommand(void (*func)(void), boolean span)
+{
+	int i;
+
+	for (i = 0; i < numcmddrawers; i++)
+		if (cmddrawers[i].func == func)
+			break;
+
+	if (i == numcmddrawers)
+	{
+		if (numcmddrawers == MAXCMDDRAWERS)
+			return NULL;
+		cmddrawers[i].func = func;
+		cmddrawers[i].span = span;
+		numcmddrawers++;
+	}
+
+	if (numdrawcmds >= maxdrawcmds)
+	{
+		maxdrawcmds = maxdrawcmds ? maxdrawcmds*2 : 16384;
+		drawcmds = realloc(drawcmds, maxdrawcmds * sizeof (*drawcmds));
+		if (!drawcmds)
+			I_Error("R_NewDrawCommand: out of memory");
+	}
+
+	drawcmds[numdrawcmds].drawer = (byte)i;
+	return &drawcmds[numdrawcmds++];
+}
+
+/**	\brief	Starts writing the solid pass down instead of drawing it,
+	if batchdraw is on
+*/
+void R_StartDrawCommands(void)
+{
+	if (!cv_batchdraw.value)
+		return;
+
+	// the commands point into cached textures and flats
+	Z_HoldCache();
+	numdrawcmds = 0;
+	batchingdraws = true;
+}
+
+/**	\brief	Draws the column set up in dc_*, now or when the commands are flushed
+
+	\param	func	column drawer
+*/
+void R_ColumnCommand(void (*func)(void))
+{
+	drawcmd_t *cmd = NULL;
+
+	// the shadowed drawer reads the whole light list, so it can't wait
+	if (batchingdraws && func != R_DrawColumnShadowed_8)
+		cmd = R_NewDrawCommand(func, false);
+
+	if (!cmd)
+	{
+		func();
+		return;
+	}
+
+	cmd->source = dc_source;
+	cmd->colormap = dc_colormap;
+	cmd->transmap = dc_transmap;
+	cmd->frac = dc_texturemid;
+	cmd->step = dc_iscale;
+	cmd->x = (short)dc_x;
+	cmd->y1 = (short)dc_yl;
+	cmd->y2 = (short)dc_yh;
+	cmd->texheight = dc_texheight;
+}
+
+/**	\brief	Draws the span set up in ds_*, now or when the commands are flushed
+
+	\param	func	span drawer
+*/
+void R_SpanCommand(void (*func)(void))
+{
+	drawcmd_t *cmd = NULL;
+
+	if (batchingdraws)
+		cmd = R_NewDrawCommand(func, true);
+
+	if (!cmd)
+	{
+		func();
+		return;
+	}
+
+	cmd->source = ds_source;
+	cmd->colormap = ds_colormap;
+	cmd->transmap = ds_transmap;
+	cmd->frac = ds_xfrac;
+	cmd->step = ds_xstep;
+	cmd->yfrac = ds_yfrac;
+	cmd->ystep = ds_ystep;
+	cmd->x = (short)ds_x1;
+	cmd->y1 = (short)ds_y;
+	cmd->y2 = (short)ds_x2;
+	cmd->texheight = (int)nflatxshift;
+}
+
+// Same drawer, then same texture, then left to right
+static int R_CompareDrawCommands(const void *a, const void *b)
+{
+	const drawcmd_t *c1 = a, *c2 = b;
+
+	if (c1->drawer != c2->drawer)
+		return c1->drawer - c2->drawer;
+	if (c1->source != c2->source)
+		return (size_t)c1->source < (size_t)c2->source ? -1 : 1;
+	if (c1->x != c2->x)
+		return c1->x - c2->x;
+	return c1->y1 - c2->y1;
+}
+
+// The other flat size values all follow from the x shift, see R_SetFlatSize
+static void R_SetFlatShift(ULONG xshift)
+{
+	const ULONG bits = 32 - xshift; // log2 of the flat's width
+
+	nflatxshift = xshift;
+	nflatyshift = 2*xshift - 32;
+	nflatshiftup = xshift - 16;
+	nflatmask = ((1<<bits) - 1)<<bits;
+}
+
+static void R_CountOverdraw(int x1, int x2, int y1, int y2)
+{
+	int x, y;
+	byte *pixel;
+
+	if (x1 < 0 || y1 < 0 || x2 >= viewwidth || y2 >= viewheight)
+		return;
+
+	for (y = y1; y <= y2; y++)
+	{
+		pixel = overdraw + y*viewwidth + x1;
+		for (x = x1; x <= x2; x++, pixel++)
+			if (*pixel < 255)
+				(*pixel)++;
+	}
+}
+
+/**	\brief	Draws everything written down since R_StartDrawCommands
+*/
+void R_FlushDrawCommands(void)
+{
+	const drawcmd_t *cmd, *last = NULL;
+	cmddrawer_t *drawer;
+	size_t i;
+	int d;
+
+	if (!batchingdraws)
+		return;
+	batchingdraws = false;
+
+	qsort(drawcmds, numdrawcmds, sizeof (*drawcmds), R_CompareDrawCommands);
+
+	for (d = 0; d < numcmddrawers; d++)
+		cmddrawers[d].commands = cmddrawers[d].pixels = 0;
+	drawbatches = 0;
+
+	if (countoverdraw)
+	{
+		if (overdrawsize < (size_t)(viewwidth*viewheight))
+		{
+			overdrawsize = viewwidth*viewheight;
+			overdraw = realloc(overdraw, overdrawsize);
+			if (!overdraw)
+				I_Error("R_FlushDrawCommands: out of memory");
+		}
+		memset(overdraw, 0, viewwidth*viewheight);
+	}
+
+	for (i = 0, cmd = drawcmds; i < numdrawcmds; i++, cmd++)
+	{
+		drawer = &cmddrawers[cmd->drawer];
+		if (!last || cmd->drawer != last->drawer || cmd->source != last->source)
+			drawbatches++;
+		last = cmd;
+
+		if (drawer->span)
+		{
+			ds_source = cmd->source;
+			ds_colormap = cmd->colormap;
+			ds_transmap = cmd->transmap;
+			ds_xfrac = cmd->frac;
+			ds_xstep = cmd->step;
+			ds_yfrac = cmd->yfrac;
+			ds_ystep = cmd->ystep;
+			ds_x1 = cmd->x;
+			ds_y = cmd->y1;
+			ds_x2 = cmd->y2;
+			R_SetFlatShift((ULONG)cmd->texheight);
+			drawer->pixels += cmd->y2 - cmd->x + 1;
+			if (countoverdraw)
+				R_CountOverdraw(cmd->x, cmd->y2, cmd->y1, cmd->y1);
+		}
+		else
+		{
+			dc_source = cmd->source;
+			dc_colormap = cmd->colormap;
+			dc_transmap = cmd->transmap;
+			dc_texturemid = cmd->frac;
+			dc_iscale = cmd->step;
+			dc_x = cmd->x;
+			dc_yl = cmd->y1;
+			dc_yh = cmd->y2;
+			dc_texheight = cmd->texheight;
+			if (cmd->y2 >= cmd->y1)
+				drawer->pixels += cmd->y2 - cmd->y1 + 1;
+			if (countoverdraw)
+				R_CountOverdraw(cmd->x, cmd->x, cmd->y1, cmd->y2);
+		}
+
+		drawer->func();
+		drawer->commands++;
+	}
+
+	Z_ReleaseCache();
+}
+
+/**	\brief	Shows what the last flush of draw commands drew.
+	"drawstats overdraw" toggles counting how often every pixel is drawn.
+*/
+void Command_Drawstats_f(void)
+{
+	ULONG pixels = 0, covered = 0, histogram[4] = {0, 0, 0, 0};
+	byte most = 0;
+	size_t i;
+	int d;
+
+	if (COM_Argc() > 1 && !stricmp(COM_Argv(1), "overdraw"))
+	{
+		countoverdraw = !countoverdraw;
+		CONS_Printf("Overdraw counting %s\n", countoverdraw ? "on" : "off");
+		return;
+	}
+
+	if (!cv_batchdraw.value)
+	{
+		CONS_Printf("Draw commands are only kept with batchdraw on\n");
+		return;
+	}
+
+	CONS_Printf("Commands: %"PRIdS" in %lu batches\n", numdrawcmds, drawbatches);
+	for (d = 0; d < numcmddrawers; d++)
+	{
+		CONS_Printf(" drawer %d (%s): %lu commands, %lu pixels\n", d,
+			cmddrawers[d].span ? "span" : "column", cmddrawers[d].commands, cmddrawers[d].pixels);
+		pixels += cmddrawers[d].pixels;
+	}
+
+	if (!countoverdraw || !overdraw)
+		return;
+
+	for (i = 0; i < (size_t)(viewwidth*viewheight); i++)
+	{
+		if (!overdraw[i])
+			continue;
+		covered++;
+		histogram[overdraw[i] < 4 ? overdraw[i] - 1 : 3]++;
+		if (overdraw[i] > most)
+			most = overdraw[i];
+	}
+
+	CONS_Printf("Pixels: %lu drawn, %lu of %d covered\n", pixels, covered, viewwidth*viewheight);
+	if (covered)
+		CONS_Printf("Overdraw: %lu.%02lu average, %d most\n", pixels/covered, (pixels%covered)*100/covered, most);
+	CONS_Printf(" once %lu, twice %lu, 3 times %lu, more %lu\n", histogram[0], histogram[1], histogram[2], histogram[3]);
+}
+
+// ==========================================================================
+//                          SPAN DRAWER BENCHMARK
+// ==========================================================================
+
+typedef struct
+{
+	const char *name;
+	void (*func)(void);
+	void (*reference)(void); // C drawer it has to match
+	boolean *available; // CPU flag it needs, NULL for none
+} benchdrawer_t;
+
+static benchdrawer_t benchdrawers[] =
+{
+	{"R_DrawSpan_8", R_DrawSpan_8, R_DrawSpan_8, NULL},
+#ifdef SIMDDRAWERS
+	{"R_DrawSpan_8_SSE2", R_DrawSpan_8_SSE2, R_DrawSpan_8, &R_SSE2},
+	{"R_DrawSpan_8_AVX2", R_DrawSpan_8_AVX2, R_DrawSpan_8, &R_AVX2},
+#endif
+	{"R_DrawTranslucentSpan_8", R_DrawTranslucentSpan_8, R_DrawTranslucentSpan_8, NULL},
+#ifdef SIMDDRAWERS
+	{"R_DrawTranslucentSpan_8_SSE2", R_DrawTranslucentSpan_8_SSE2, R_DrawTranslucentSpan_8, &R_SSE2},
+	{"R_DrawTranslucentSpan_8_AVX2", R_DrawTranslucentSpan_8_AVX2, R_DrawTranslucentSpan_8, &R_AVX2},
+#endif
+};
+
+static UINT32 R_BenchRandom(void)
+{
+	const int hi = rand(), lo = rand();
+	return ((UINT32)hi<<16) ^ (UINT32)lo;
+}
+
+// Random span on row 0, anywhere in the view, over a flat 2^bits wide
+static void R_RandomSpan(int bits)
+{
+	int length;
+
+	R_SetFlatShift(32 - bits);
+	ds_xfrac = (fixed_t)R_BenchRandom();
+	ds_yfrac = (fixed_t)R_BenchRandom();
+	ds_xstep = (fixed_t)(R_BenchRandom() % (8*FRACUNIT)) - 4*FRACUNIT;
+	ds_ystep = (fixed_t)(R_BenchRandom() % (8*FRACUNIT)) - 4*FRACUNIT;
+	ds_y = 0;
+	ds_x1 = rand() % viewwidth;
+	length = rand() % (viewwidth - ds_x1);
+	ds_x2 = ds_x1 + length;
+	ds_colormap = colormaps + (rand() % 32)*256;
+	ds_transmap = transtables + (rand() % NUMTRANSTABLES)*0x10000;
+}
+
+/**	\brief	drawbench [reps] checks every span drawer the CPU can run gives
+	the same pixels as its C version, on all flat sizes, then times each
+	of them on reps spans the width of the view.
+*/
+void Command_Drawbench_f(void)
+{
+	const size_t numdrawers = sizeof (benchdrawers)/sizeof (benchdrawers[0]);
+	byte *flat, *row, *start, *expect, *saverow;
+	size_t d, rowsize;
+	int bits, i, reps = 20000;
+	boolean same;
+	clock_t begin;
+	double seconds, ctime = 0;
+
+	if (rendermode != render_soft || vid.bpp != 1 || viewwidth < 8 || !colormaps || !transtables)
+	{
+		CONS_Printf("drawbench needs the 8 bit software renderer\n");
+		return;
+	}
+
+	if (COM_Argc() > 1 && atoi(COM_Argv(1)) > 0)
+		reps = atoi(COM_Argv(1));
+
+	// Flats must come from the zone, see r_draw8_simd.c
+	flat = Z_Malloc(2048*2048, PU_STATIC, NULL);
+	rowsize = columnofs[viewwidth-1] + 1;
+	row = malloc(rowsize*3);
+	if (!row)
+		I_Error("Command_Drawbench_f: out of memory");
+	start = row + rowsize;
+	expect = start + rowsize;
+
+	srand(1);
+	for (i = 0; i < 2048*2048; i++)
+		flat[i] = (byte)rand();
+	for (d = 0; d < rowsize; d++)
+		start[d] = (byte)rand();
+
+	// The drawers write through ylookup, so give them a row of our own
+	saverow = ylookup[0];
+	ylookup[0] = row;
+	ds_source = flat;
+
+	for (d = 0; d < numdrawers; d++)
+	{
+		if (benchdrawers[d].available && !*benchdrawers[d].available)
+		{
+			CONS_Printf("%-30s not supported by this CPU\n", benchdrawers[d].name);
+			continue;
+		}
+
+		same = true;
+		if (benchdrawers[d].func != benchdrawers[d].reference)
+		{
+			srand(2);
+			for (bits = 5; bits <= 11 && same; bits++)
+			{
+				for (i = 0; i < 2000; i++)
+				{
+					R_RandomSpan(bits);
+					M_Memcpy(row, start, rowsize);
+					benchdrawers[d].reference();
+					M_Memcpy(expect, row, rowsize);
+					M_Memcpy(row, start, rowsize);
+					benchdrawers[d].func();
+					if (memcmp(row, expect, rowsize))
+					{
+						same = false;
+						break;
+					}
+				}
+			}
+		}
+
+		srand(3);
+		R_RandomSpan(6);
+		ds_x1 = 0;
+		ds_x2 = viewwidth - 1;
+		begin = clock();
+		for (i = 0; i < reps; i++)
+		{
+			ds_xfrac += FRACUNIT/3;
+			benchdrawers[d].func();
+		}
+		seconds = (double)(clock() - begin) / CLOCKS_PER_SEC;
+		if (benchdrawers[d].func == benchdrawers[d].reference)
+			ctime = seconds;
+
+		CONS_Printf("%-30s %8.1f Mpixel/s %5.2fx%s\n", benchdrawers[d].name,
+			seconds > 0 ? (double)reps * viewwidth / seconds / 1000000 : 0.0,
+			seconds > 0 ? ctime / seconds : 0.0,
+			same ? "" : " (PIXELS DIFFER)");
+	}
+
+	ylookup[0] = saverow;
+	free(row);
+	Z_Free(flat);
+}
+
 // ==========================================================================
 //                   INCLUDE 8bpp DRAWING CODE HERE
 // ==========================================================================
 
 #include "r_draw8.c"
 
+// ==========================================================================
+//                   INCLUDE SIMD 8bpp DRAWING CODE HERE
+// ==========================================================================
+
+#include "r_draw8_simd.c"
+
 // ==========================================================================
 //                   INCLUDE 16bpp DRAWING CODE HERE
 // ==========================================================================
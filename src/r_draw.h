@@ -21,6 +21,17 @@
 #define __R_DRAW__
 
 #include "r_defs.h"
+#include "i_threads.h"
+
+// Floors and ceilings can be drawn by several threads at once, each with
+// its own span drawing state. The assembly drawers read the span globals
+// directly, so they keep the one shared copy.
+#if defined (HAVE_THREADS) && defined (__GNUC__) && !defined (USEASM)
+#define RENDERTHREADS
+#define RENDERTLS __thread
+#else
+#define RENDERTLS
+#endif
 
 // -------------------------------
 // COMMON STUFF FOR 8bpp AND 16bpp
@@ -63,17 +74,17 @@ extern int dc_texheight;
 // SPAN DRAWING CODE STUFF
 // -----------------------
 
-extern int ds_y, ds_x1, ds_x2;
-extern lighttable_t *ds_colormap;
-extern fixed_t ds_xfrac, ds_yfrac, ds_xstep, ds_ystep;
-extern byte *ds_source; // start of a 64*64 tile image
-extern byte *ds_transmap;
+extern RENDERTLS int ds_y, ds_x1, ds_x2;
+extern RENDERTLS lighttable_t *ds_colormap;
+extern RENDERTLS fixed_t ds_xfrac, ds_yfrac, ds_xstep, ds_ystep;
+extern RENDERTLS byte *ds_source; // start of a 64*64 tile image
+extern RENDERTLS byte *ds_transmap;
 
 // Variable flat sizes
-extern ULONG nflatxshift;
-extern ULONG nflatyshift;
-extern ULONG nflatshiftup;
-extern ULONG nflatmask;
+extern RENDERTLS ULONG nflatxshift;
+extern RENDERTLS ULONG nflatyshift;
+extern RENDERTLS ULONG nflatshiftup;
+extern RENDERTLS ULONG nflatmask;
 
 /// \brief Top border
 #define BRDR_T 0
@@ -110,6 +121,14 @@ void R_InitViewBuffer(int width, int height);
 void R_InitViewBorder(void);
 void R_VideoErase(unsigned int ofs, int count);
 
+// Buffered drawing of the solid walls, sky, floors and ceilings
+extern boolean batchingdraws;
+void R_StartDrawCommands(void);
+void R_ColumnCommand(void (*func)(void));
+void R_SpanCommand(void (*func)(void));
+void R_FlushDrawCommands(void);
+void Command_Drawstats_f(void);
+
 // -----------------
 // 8bpp DRAWING CODE
 // -----------------
@@ -149,6 +168,17 @@ void R_DrawFogSpan_8(void);
 void R_DrawFogColumn_8(void);
 void R_DrawColumnShadowed_8(void);
 
+// SSE2 and AVX2 span drawers, picked by SCR_SetMode from what the CPU has
+#if defined (__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)) \
+	&& (defined (__i386__) || defined (__x86_64__)) && !defined (NOSIMD)
+#define SIMDDRAWERS
+void R_DrawSpan_8_SSE2(void);
+void R_DrawSpan_8_AVX2(void);
+void R_DrawTranslucentSpan_8_SSE2(void);
+void R_DrawTranslucentSpan_8_AVX2(void);
+#endif
+void Command_Drawbench_f(void);
+
 // ------------------
 // 16bpp DRAWING CODE
 // ------------------
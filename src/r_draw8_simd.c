@@ -0,0 +1,315 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// Copyright (C) 1998-2000 by DooM Legacy Team.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//-----------------------------------------------------------------------------
+/// \file
+/// \brief 8bpp span drawers using SSE2 and AVX2
+///
+///	NOTE: no includes because this is included as part of r_draw.c
+///
+///	These give exactly the same pixels as R_DrawSpan_8 and
+///	R_DrawTranslucentSpan_8. The SSE2 ones work out the texture offsets
+///	of 8 pixels at once, look them up one by one and write the 8 pixels
+///	together. The AVX2 ones look them up with gathers too. A gather reads
+///	a whole int, so the table is read through a pointer 3 bytes early and
+///	the byte wanted ends up on top. Flats, colormaps and translucency tables
+///	all come from the zone, so there's always a block header to read there.
+///
+///	Columns keep the C drawers: their pixels are a screen width apart, so
+///	nothing can be written at once, and the C loop is as fast as its loads.
+
+#ifdef SIMDDRAWERS
+#include <immintrin.h>
+
+// ==========================================================================
+// SSE2
+// ==========================================================================
+
+// Texture offsets of the next 4 pixels
+#define SSE2_SPOTS(x, y) _mm_or_si128(_mm_and_si128(_mm_srl_epi32(y, yshift), mask), _mm_srl_epi32(x, xshift))
+
+/**	\brief The R_DrawSpan_8_SSE2 function
+	R_DrawSpan_8, 8 texture offsets at a time
+*/
+__attribute__((target("sse2")))
+void R_DrawSpan_8_SSE2(void)
+{
+	unsigned int xposition;
+	unsigned int yposition;
+	unsigned int xstep, ystep;
+
+	byte *source;
+	byte *colormap;
+	byte *dest;
+
+	unsigned int count;
+	unsigned int spot[8] __attribute__((aligned(16)));
+	__m128i x, y, xstep4, ystep4, mask, xshift, yshift;
+
+	xposition = ds_xfrac << nflatshiftup; yposition = ds_yfrac << nflatshiftup;
+	xstep = ds_xstep << nflatshiftup; ystep = ds_ystep << nflatshiftup;
+
+	source = ds_source;
+	colormap = ds_colormap;
+	dest = ylookup[ds_y] + columnofs[ds_x1];
+	count = ds_x2 - ds_x1 + 1;
+
+	x = _mm_setr_epi32((int)xposition, (int)(xposition + xstep), (int)(xposition + 2*xstep), (int)(xposition + 3*xstep));
+	y = _mm_setr_epi32((int)yposition, (int)(yposition + ystep), (int)(yposition + 2*ystep), (int)(yposition + 3*ystep));
+	xstep4 = _mm_set1_epi32((int)(4*xstep));
+	ystep4 = _mm_set1_epi32((int)(4*ystep));
+	mask = _mm_set1_epi32((int)nflatmask);
+	xshift = _mm_cvtsi32_si128((int)nflatxshift);
+	yshift = _mm_cvtsi32_si128((int)nflatyshift);
+
+	while (count >= 8)
+	{
+		_mm_store_si128((__m128i *)(void *)spot, SSE2_SPOTS(x, y));
+		x = _mm_add_epi32(x, xstep4);
+		y = _mm_add_epi32(y, ystep4);
+		_mm_store_si128((__m128i *)(void *)(spot + 4), SSE2_SPOTS(x, y));
+		x = _mm_add_epi32(x, xstep4);
+		y = _mm_add_epi32(y, ystep4);
+
+		dest[0] = colormap[source[spot[0]]];
+		dest[1] = colormap[source[spot[1]]];
+		dest[2] = colormap[source[spot[2]]];
+		dest[3] = colormap[source[spot[3]]];
+		dest[4] = colormap[source[spot[4]]];
+		dest[5] = colormap[source[spot[5]]];
+		dest[6] = colormap[source[spot[6]]];
+		dest[7] = colormap[source[spot[7]]];
+
+		dest += 8;
+		count -= 8;
+	}
+
+	xposition = (unsigned int)_mm_cvtsi128_si32(x);
+	yposition = (unsigned int)_mm_cvtsi128_si32(y);
+	while (count--)
+	{
+		*dest++ = colormap[source[((yposition >> nflatyshift) & nflatmask) | (xposition >> nflatxshift)]];
+		xposition += xstep;
+		yposition += ystep;
+	}
+}
+
+/**	\brief The R_DrawTranslucentSpan_8_SSE2 function
+	R_DrawTranslucentSpan_8, 8 texture offsets at a time
+*/
+__attribute__((target("sse2")))
+void R_DrawTranslucentSpan_8_SSE2(void)
+{
+	unsigned int xposition;
+	unsigned int yposition;
+	unsigned int xstep, ystep;
+
+	byte *source;
+	byte *colormap;
+	byte *transmap;
+	byte *dest;
+
+	unsigned int count, i;
+	unsigned int spot[8] __attribute__((aligned(16)));
+	__m128i x, y, xstep4, ystep4, mask, xshift, yshift;
+
+	xposition = ds_xfrac << nflatshiftup; yposition = ds_yfrac << nflatshiftup;
+	xstep = ds_xstep << nflatshiftup; ystep = ds_ystep << nflatshiftup;
+
+	source = ds_source;
+	colormap = ds_colormap;
+	transmap = ds_transmap;
+	dest = ylookup[ds_y] + columnofs[ds_x1];
+	count = ds_x2 - ds_x1 + 1;
+
+	x = _mm_setr_epi32((int)xposition, (int)(xposition + xstep), (int)(xposition + 2*xstep), (int)(xposition + 3*xstep));
+	y = _mm_setr_epi32((int)yposition, (int)(yposition + ystep), (int)(yposition + 2*ystep), (int)(yposition + 3*ystep));
+	xstep4 = _mm_set1_epi32((int)(4*xstep));
+	ystep4 = _mm_set1_epi32((int)(4*ystep));
+	mask = _mm_set1_epi32((int)nflatmask);
+	xshift = _mm_cvtsi32_si128((int)nflatxshift);
+	yshift = _mm_cvtsi32_si128((int)nflatyshift);
+
+	while (count >= 8)
+	{
+		_mm_store_si128((__m128i *)(void *)spot, SSE2_SPOTS(x, y));
+		x = _mm_add_epi32(x, xstep4);
+		y = _mm_add_epi32(y, ystep4);
+		_mm_store_si128((__m128i *)(void *)(spot + 4), SSE2_SPOTS(x, y));
+		x = _mm_add_epi32(x, xstep4);
+		y = _mm_add_epi32(y, ystep4);
+
+		for (i = 0; i < 8; i++)
+			dest[i] = colormap[*(transmap + (source[spot[i]] << 8) + dest[i])];
+
+		dest += 8;
+		count -= 8;
+	}
+
+	xposition = (unsigned int)_mm_cvtsi128_si32(x);
+	yposition = (unsigned int)_mm_cvtsi128_si32(y);
+	while (count--)
+	{
+		*dest = colormap[*(transmap + (source[((yposition >> nflatyshift) & nflatmask) | (xposition >> nflatxshift)] << 8) + *dest)];
+		dest++;
+		xposition += xstep;
+		yposition += ystep;
+	}
+}
+
+#undef SSE2_SPOTS
+
+// ==========================================================================
+// AVX2
+// ==========================================================================
+
+// Texture offsets of the next 8 pixels
+#define AVX2_SPOTS(x, y) _mm256_or_si256(_mm256_and_si256(_mm256_srl_epi32(y, yshift), mask), _mm256_srl_epi32(x, xshift))
+
+// The bytes table[index] of every lane, see the top of the file
+#define AVX2_LOOKUP(table, index) _mm256_srli_epi32(_mm256_i32gather_epi32((const int *)(const void *)((table) - 3), index, 1), 24)
+
+// Writes the low byte of the 8 lanes to dest
+__attribute__((target("avx2")))
+static void R_StoreLanes_AVX2(byte *dest, __m256i lanes)
+{
+	const __m256i pack = _mm256_setr_epi8(
+		0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+
+	lanes = _mm256_shuffle_epi8(lanes, pack);
+	_mm_storel_epi64((__m128i *)(void *)dest,
+		_mm_unpacklo_epi32(_mm256_castsi256_si128(lanes), _mm256_extracti128_si256(lanes, 1)));
+}
+
+/**	\brief The R_DrawSpan_8_AVX2 function
+	R_DrawSpan_8, 8 pixels at a time
+*/
+__attribute__((target("avx2")))
+void R_DrawSpan_8_AVX2(void)
+{
+	unsigned int xposition;
+	unsigned int yposition;
+	unsigned int xstep, ystep;
+
+	byte *source;
+	byte *colormap;
+	byte *dest;
+
+	unsigned int count;
+	__m256i x, y, xstep8, ystep8, mask, lanes;
+	__m128i xshift, yshift;
+
+	xposition = ds_xfrac << nflatshiftup; yposition = ds_yfrac << nflatshiftup;
+	xstep = ds_xstep << nflatshiftup; ystep = ds_ystep << nflatshiftup;
+
+	source = ds_source;
+	colormap = ds_colormap;
+	dest = ylookup[ds_y] + columnofs[ds_x1];
+	count = ds_x2 - ds_x1 + 1;
+
+	lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	x = _mm256_add_epi32(_mm256_set1_epi32((int)xposition), _mm256_mullo_epi32(lanes, _mm256_set1_epi32((int)xstep)));
+	y = _mm256_add_epi32(_mm256_set1_epi32((int)yposition), _mm256_mullo_epi32(lanes, _mm256_set1_epi32((int)ystep)));
+	xstep8 = _mm256_set1_epi32((int)(8*xstep));
+	ystep8 = _mm256_set1_epi32((int)(8*ystep));
+	mask = _mm256_set1_epi32((int)nflatmask);
+	xshift = _mm_cvtsi32_si128((int)nflatxshift);
+	yshift = _mm_cvtsi32_si128((int)nflatyshift);
+
+	while (count >= 8)
+	{
+		lanes = AVX2_LOOKUP(source, AVX2_SPOTS(x, y));
+		R_StoreLanes_AVX2(dest, AVX2_LOOKUP(colormap, lanes));
+		x = _mm256_add_epi32(x, xstep8);
+		y = _mm256_add_epi32(y, ystep8);
+
+		dest += 8;
+		count -= 8;
+	}
+
+	xposition = (unsigned int)_mm256_extract_epi32(x, 0);
+	yposition = (unsigned int)_mm256_extract_epi32(y, 0);
+	while (count--)
+	{
+		*dest++ = colormap[source[((yposition >> nflatyshift) & nflatmask) | (xposition >> nflatxshift)]];
+		xposition += xstep;
+		yposition += ystep;
+	}
+}
+
+/**	\brief The R_DrawTranslucentSpan_8_AVX2 function
+	R_DrawTranslucentSpan_8, 8 pixels at a time
+*/
+__attribute__((target("avx2")))
+void R_DrawTranslucentSpan_8_AVX2(void)
+{
+	unsigned int xposition;
+	unsigned int yposition;
+	unsigned int xstep, ystep;
+
+	byte *source;
+	byte *colormap;
+	byte *transmap;
+	byte *dest;
+
+	unsigned int count;
+	__m256i x, y, xstep8, ystep8, mask, lanes;
+	__m128i xshift, yshift;
+
+	xposition = ds_xfrac << nflatshiftup; yposition = ds_yfrac << nflatshiftup;
+	xstep = ds_xstep << nflatshiftup; ystep = ds_ystep << nflatshiftup;
+
+	source = ds_source;
+	colormap = ds_colormap;
+	transmap = ds_transmap;
+	dest = ylookup[ds_y] + columnofs[ds_x1];
+	count = ds_x2 - ds_x1 + 1;
+
+	lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	x = _mm256_add_epi32(_mm256_set1_epi32((int)xposition), _mm256_mullo_epi32(lanes, _mm256_set1_epi32((int)xstep)));
+	y = _mm256_add_epi32(_mm256_set1_epi32((int)yposition), _mm256_mullo_epi32(lanes, _mm256_set1_epi32((int)ystep)));
+	xstep8 = _mm256_set1_epi32((int)(8*xstep));
+	ystep8 = _mm256_set1_epi32((int)(8*ystep));
+	mask = _mm256_set1_epi32((int)nflatmask);
+	xshift = _mm_cvtsi32_si128((int)nflatxshift);
+	yshift = _mm_cvtsi32_si128((int)nflatyshift);
+
+	while (count >= 8)
+	{
+		// transmap + (source pixel << 8) + dest pixel
+		lanes = _mm256_slli_epi32(AVX2_LOOKUP(source, AVX2_SPOTS(x, y)), 8);
+		lanes = _mm256_or_si256(lanes, _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(const void *)dest)));
+		R_StoreLanes_AVX2(dest, AVX2_LOOKUP(colormap, AVX2_LOOKUP(transmap, lanes)));
+		x = _mm256_add_epi32(x, xstep8);
+		y = _mm256_add_epi32(y, ystep8);
+
+		dest += 8;
+		count -= 8;
+	}
+
+	xposition = (unsigned int)_mm256_extract_epi32(x, 0);
+	yposition = (unsigned int)_mm256_extract_epi32(y, 0);
+	while (count--)
+	{
+		*dest = colormap[*(transmap + (source[((yposition >> nflatyshift) & nflatmask) | (xposition >> nflatxshift)] << 8) + *dest)];
+		dest++;
+		xposition += xstep;
+		yposition += ystep;
+	}
+}
+
+#undef AVX2_SPOTS
+#undef AVX2_LOOKUP
+#endif
@@ -91,6 +91,7 @@ lighttable_t *scalelight[LIGHTLEVELS][MAXLIGHTSCALE];
 lighttable_t *scalelightfixed[MAXLIGHTSCALE];
 lighttable_t *zlight[LIGHTLEVELS][MAXLIGHTZ];
 
+static CV_PossibleValue_t renderthreads_cons_t[] = {{0, "MIN"}, {16, "MAX"}, {0, NULL}};
 static CV_PossibleValue_t fadestyle_cons_t[] = {{0, "None"}, {1, "Cross-Fade"}, {2, "Black-Fade"}, {0, NULL}};
 
 static void ChaseCam_OnChange(void);
@@ -110,6 +111,10 @@ consvar_t cv_showhud = {"showhud", "Yes", CV_CALL,  CV_YesNo, R_SetViewSize, 0,
 consvar_t cv_homremoval = {"homremoval", "Off", CV_SAVE, CV_OnOff, NULL, 0, NULL, NULL, 0, 0, NULL};
 consvar_t cv_fadestyle = {"fade", "Cross-Fade", CV_SAVE, fadestyle_cons_t, NULL, 0, NULL, NULL, 0, 0, NULL};
 consvar_t cv_con_trans = {"con_trans", "128", CV_SAVE, CV_Byte, NULL, 0, NULL, NULL, 0, 0, NULL};
+// 0 is one strip for every thread, 1 draws everything on the main thread
+consvar_t cv_renderthreads = {"renderthreads", "0", CV_SAVE, renderthreads_cons_t, NULL, 0, NULL, NULL, 0, 0, NULL};
+// Draw the solid pass as sorted batches of draw commands, see R_FlushDrawCommands
+consvar_t cv_batchdraw = {"batchdraw", "Off", 0, CV_OnOff, NULL, 0, NULL, NULL, 0, 0, NULL};
 #ifdef SEENAMES
 consvar_t cv_shownames = {"shownames", "On", CV_SAVE, CV_OnOff, NULL, 0, NULL, NULL, 0, 0, NULL};
 #endif
@@ -971,6 +976,8 @@ static void R_RenderSkyBoxView(mobj_t *skyboxview, mobj_t *skycentermobj, player
 	// check for new console commands.
 	NetUpdate();
 
+	R_StartDrawCommands();
+
 	// The head node is the last node output.
 	R_RenderBSPNode((int)numnodes - 1);
 
@@ -979,6 +986,8 @@ static void R_RenderSkyBoxView(mobj_t *skyboxview, mobj_t *skycentermobj, player
 
 	R_DrawPlanes();
 
+	R_FlushDrawCommands();
+
 	// Check for new console commands.
 	NetUpdate();
 
@@ -1044,6 +1053,8 @@ void R_RenderPlayerView(player_t *player)
 	// check for new console commands.
 	NetUpdate();
 
+	R_StartDrawCommands();
+
 	// The head node is the last node output.
 	R_RenderBSPNode((int)numnodes - 1);
 
@@ -1052,6 +1063,8 @@ void R_RenderPlayerView(player_t *player)
 
 	R_DrawPlanes();
 
+	R_FlushDrawCommands();
+
 	// Check for new console commands.
 	NetUpdate();
 
@@ -1075,6 +1088,74 @@ void R_RenderPlayerView(player_t *player)
 //                    ENGINE COMMANDS & VARS
 // =========================================================================
 
+//
+// Command_Renderlimits_f
+//
+// How much of each render array the last frame used, the most any frame
+// has used, and how much is allocated. "renderlimits reset" forgets the
+// peaks.
+//
+void Command_Renderlimits_f(void)
+{
+	renderusage_t *usage[] =
+	{
+		&visspriteusage, &visplaneusage, &drawsegusage, &openingusage, &solidsegusage,
+#ifdef HWRENDER
+		&grvisspriteusage,
+#endif
+	};
+	size_t i;
+
+	if (COM_Argc() > 1 && !stricmp(COM_Argv(1), "reset"))
+	{
+		for (i = 0; i < sizeof (usage)/sizeof (usage[0]); i++)
+			usage[i]->peak = usage[i]->used;
+		return;
+	}
+
+	CONS_Printf("               last     peak allocated\n");
+	for (i = 0; i < sizeof (usage)/sizeof (usage[0]); i++)
+		CONS_Printf("%-12s %8"PRIdS" %8"PRIdS" %8"PRIdS"\n", usage[i]->name,
+			usage[i]->used, usage[i]->peak, usage[i]->size);
+}
+
+//
+// R_NewChunkElem
+//
+// Hands out the next element, adding a chunk when the last one is full.
+//
+void *R_NewChunkElem(renderchunks_t *a)
+{
+	if (a->count == a->numchunks*RENDERCHUNKSIZE)
+	{
+		byte **newchunks = realloc(a->chunks, (a->numchunks+1) * sizeof (*a->chunks));
+		if (!newchunks)
+			I_Error("R_NewChunkElem: out of memory for %"PRIdS" %s\n", a->count + RENDERCHUNKSIZE, a->name);
+		a->chunks = newchunks;
+
+		a->chunks[a->numchunks] = malloc(RENDERCHUNKSIZE * a->elemsize);
+		if (!a->chunks[a->numchunks])
+			I_Error("R_NewChunkElem: out of memory for %"PRIdS" %s\n", a->count + RENDERCHUNKSIZE, a->name);
+		a->numchunks++;
+		a->usage->size = a->numchunks*RENDERCHUNKSIZE;
+	}
+
+	a->count++;
+	R_NoteUsage(*a->usage, a->count);
+	return R_ChunkElem(a, a->count-1);
+}
+
+//
+// R_ClearChunkArray
+//
+// Takes back every element; the chunks stay for the next frame.
+//
+void R_ClearChunkArray(renderchunks_t *a)
+{
+	a->count = 0;
+	a->usage->used = 0;
+}
+
 void R_RegisterEngineStuff(void)
 {
 	CV_RegisterVar(&cv_gravity);
@@ -1096,6 +1177,8 @@ void R_RegisterEngineStuff(void)
 	CV_RegisterVar(&cv_shadow);
 	CV_RegisterVar(&cv_fadestyle);
 	CV_RegisterVar(&cv_con_trans);
+	CV_RegisterVar(&cv_renderthreads);
+	CV_RegisterVar(&cv_batchdraw);
 #ifdef SEENAMES
 	CV_RegisterVar(&cv_shownames);
 #endif
@@ -96,10 +96,58 @@ extern consvar_t cv_shadow;
 extern consvar_t cv_fadestyle;
 extern consvar_t cv_tailspickup;
 extern consvar_t cv_con_trans;
+extern consvar_t cv_renderthreads;
+extern consvar_t cv_batchdraw;
 #ifdef SEENAMES
 extern consvar_t cv_shownames;
 #endif
 
+//
+// How much of each growable render array is in use. These never shrink;
+// each frame starts again at the bottom of what is already allocated.
+//
+typedef struct
+{
+	const char *name;
+	size_t used; // this frame
+	size_t peak; // most used in any frame since the last reset
+	size_t size; // allocated
+} renderusage_t;
+
+#define R_NoteUsage(u, n) \
+	do { (u).used = (n); if ((u).used > (u).peak) (u).peak = (u).used; } while (0)
+
+extern renderusage_t visspriteusage, visplaneusage, drawsegusage, openingusage, solidsegusage;
+#ifdef HWRENDER
+extern renderusage_t grvisspriteusage;
+#endif
+
+void Command_Renderlimits_f(void);
+
+//
+// Growable array whose elements never move: they are handed out from
+// fixed size chunks kept from frame to frame, so a caller can hold on to
+// one element while it asks for more (R_SplitSprite does).
+//
+#define RENDERCHUNKBITS 8
+#define RENDERCHUNKSIZE (1<<RENDERCHUNKBITS)
+
+typedef struct
+{
+	const char *name; // for the out of memory message
+	size_t elemsize;
+	renderusage_t *usage;
+	byte **chunks;
+	size_t numchunks;
+	size_t count; // handed out since the last R_ClearChunkArray
+} renderchunks_t;
+
+#define R_ChunkElem(a, i) \
+	((void *)((a)->chunks[(i)>>RENDERCHUNKBITS] + ((i)&(RENDERCHUNKSIZE-1))*(a)->elemsize))
+
+void *R_NewChunkElem(renderchunks_t *a);
+void R_ClearChunkArray(renderchunks_t *a);
+
 // Called by startup code.
 void R_Init(void);
 
@@ -35,6 +35,7 @@
 #include "w_wad.h"
 #include "z_zone.h"
 #include "p_tick.h"
+#include "i_system.h"
 
 #include "p_setup.h" // levelflats
 
@@ -60,7 +61,7 @@ static visplane_t **freehead = &freetail;
 
 visplane_t *floorplane;
 visplane_t *ceilingplane;
-static visplane_t *currentplane;
+static RENDERTLS visplane_t *currentplane;
 
 planemgr_t ffloor[MAXFFLOORS];
 int numffloors;
@@ -71,6 +72,10 @@ int numffloors;
 
 //SoM: 3/23/2000: Use boom opening limit removal
 size_t maxopenings;
+
+renderusage_t openingusage = {"openings", 0, 0, 0};
+renderusage_t visplaneusage = {"visplanes", 0, 0, 0};
+static size_t numvisplanes = 0; // in the hash this frame
 short *openings, *lastopening; /// \todo free leak
 
 //
@@ -85,13 +90,13 @@ fixed_t frontscale[MAXVIDWIDTH];
 // spanstart holds the start of a plane span
 // initialized to 0 at start
 //
-static int spanstart[MAXVIDHEIGHT];
+static RENDERTLS int spanstart[MAXVIDHEIGHT];
 
 //
 // texture mapping
 //
-static lighttable_t **planezlight;
-static fixed_t planeheight;
+static RENDERTLS lighttable_t **planezlight;
+static RENDERTLS fixed_t planeheight;
 
 //added : 10-02-98: yslopetab is what yslope used to be,
 //                yslope points somewhere into yslopetab,
@@ -104,14 +109,14 @@ fixed_t yslopetab[MAXVIDHEIGHT*4];
 fixed_t *yslope;
 
 fixed_t distscale[MAXVIDWIDTH];
-fixed_t basexscale, baseyscale;
+RENDERTLS fixed_t basexscale, baseyscale;
 
-fixed_t cachedheight[MAXVIDHEIGHT];
-fixed_t cacheddistance[MAXVIDHEIGHT];
-fixed_t cachedxstep[MAXVIDHEIGHT];
-fixed_t cachedystep[MAXVIDHEIGHT];
+RENDERTLS fixed_t cachedheight[MAXVIDHEIGHT];
+RENDERTLS fixed_t cacheddistance[MAXVIDHEIGHT];
+RENDERTLS fixed_t cachedxstep[MAXVIDHEIGHT];
+RENDERTLS fixed_t cachedystep[MAXVIDHEIGHT];
 
-static fixed_t xoffs, yoffs;
+static RENDERTLS fixed_t xoffs, yoffs;
 
 
 #ifdef SESLOPE
@@ -134,10 +139,10 @@ static fixed_t xoffs, yoffs;
 //
 // BASIC PRIMITIVE
 //
-static int bgofs;
+static RENDERTLS int bgofs;
 static int wtofs=0;
 static int waterofs;
-static boolean itswater;
+static RENDERTLS boolean itswater;
 
 #ifdef __mips__
 //#define NOWATER
@@ -1001,7 +1006,7 @@ void R_MapPlane(int y, int x1, int x2)
 	ds_x1 = x1;
 	ds_x2 = x2;
 
-	spanfunc();
+	R_SpanCommand(spanfunc);
 }
 
 //
@@ -1038,6 +1043,8 @@ void R_ClearPlanes(void)
 	}
 
 	lastopening = openings;
+	openingusage.used = 0;
+	numvisplanes = visplaneusage.used = 0;
 
 	// texture calculation
 	memset(cachedheight, 0, sizeof (cachedheight));
@@ -1050,22 +1057,39 @@ void R_ClearPlanes(void)
 	baseyscale = -FixedDiv (FINESINE(angle),centerxfrac);
 }
 
+//
+// new_visplane
+// Visplanes are never freed; R_ClearPlanes hands them all back to the
+// free list. When that runs dry a block of them is allocated at once.
+//
+#define VISPLANEBLOCK 32
+
 static visplane_t *new_visplane(unsigned int hash)
 {
-	visplane_t *check = freetail;
-	if (!check)
-	{
-		check = calloc(1, sizeof (*check));
-		if (check == NULL) I_Error("out of memory"); // FIXME: ugly
-	}
-	else
+	visplane_t *check;
+	size_t i;
+
+	if (!freetail)
 	{
-		freetail = freetail->next;
-		if (!freetail)
-			freehead = &freetail;
+		check = calloc(VISPLANEBLOCK, sizeof (*check));
+		if (check == NULL)
+			I_Error("new_visplane: out of memory for %"PRIdS" visplanes\n", visplaneusage.size + VISPLANEBLOCK);
+		for (i = 0; i < VISPLANEBLOCK-1; i++)
+			check[i].next = &check[i+1];
+		freetail = check;
+		freehead = &check[VISPLANEBLOCK-1].next;
+		visplaneusage.size += VISPLANEBLOCK;
 	}
+
+	check = freetail;
+	freetail = freetail->next;
+	if (!freetail)
+		freehead = &freetail;
+
 	check->next = visplanes[hash];
 	visplanes[hash] = check;
+	numvisplanes++;
+	R_NoteUsage(visplaneusage, numvisplanes);
 	return check;
 }
 
@@ -1366,12 +1390,248 @@ void R_MakeSlopeSpans(int x, int t1, int b1, int t2, int b2)
 }
 #endif
 
-void R_DrawPlanes(void)
+// Sky is always drawn full bright, i.e. colormaps[0] is used.
+// Because of this hack, sky is not affected by INVUL inverse mapping.
+static void R_DrawSkyPlane(visplane_t *pl) // SKWALL : this also draws the sky clipping walls
 {
-	visplane_t *pl;
 	int x;
 	int angle;
+
+	// use correct aspect ratio scale
+	dc_iscale = skyscale;
+
+	dc_colormap = colormaps;
+	dc_texturemid = skytexturemid;
+	dc_texheight = textureheight[skytexture]
+		>>FRACBITS;
+	for (x = pl->minx; x <= pl->maxx; x++)
+	{
+		dc_yl = pl->top[x];
+		dc_yh = pl->bottom[x];
+
+		if (dc_yl <= dc_yh)
+		{
+			angle = (viewangle + xtoviewangle[x])>>ANGLETOSKYSHIFT;
+			dc_x = x;
+			dc_source =
+				R_GetColumn(skytexture,
+					angle);
+			R_ColumnCommand(wallcolfunc);
+		}
+	}
+}
+
+// Sets the nflat* shifts for a flat lump of the given size
+static void R_SetFlatSize(size_t size)
+{
+	switch (size)
+	{
+		case 4194304: // 2048x2048 lump
+			nflatmask = 0x3FF800;
+			nflatxshift = 21;
+			nflatyshift = 10;
+			nflatshiftup = 5;
+			break;
+		case 1048576: // 1024x1024 lump
+			nflatmask = 0xFFC00;
+			nflatxshift = 22;
+			nflatyshift = 12;
+			nflatshiftup = 6;
+			break;
+		case 262144:// 512x512 lump'
+			nflatmask = 0x3FE00;
+			nflatxshift = 23;
+			nflatyshift = 14;
+			nflatshiftup = 7;
+			break;
+		case 65536: // 256x256 lump
+			nflatmask = 0xFF00;
+			nflatxshift = 24;
+			nflatyshift = 16;
+			nflatshiftup = 8;
+			break;
+		case 16384: // 128x128 lump
+			nflatmask = 0x3F80;
+			nflatxshift = 25;
+			nflatyshift = 18;
+			nflatshiftup = 9;
+			break;
+		case 1024: // 32x32 lump
+			nflatmask = 0x3E0;
+			nflatxshift = 27;
+			nflatyshift = 22;
+			nflatshiftup = 11;
+			break;
+		default: // 64x64 lump
+			nflatmask = 0xFC0;
+			nflatxshift = 26;
+			nflatyshift = 20;
+			nflatshiftup = 10;
+			break;
+	}
+}
+
+#ifdef RENDERTHREADS
+//
+// Strip drawing: the view is cut into vertical strips and every strip
+// draws its own part of each floor and ceiling on a worker thread.
+// Visplanes never share pixels, so the strips don't need to wait on
+// each other, and the span drawing state is kept per thread.
+//
+#define MAXPLANESTRIPS 16
+
+typedef struct
+{
+	visplane_t *pl;
+	byte *source; // flat, cached on the main thread since the zone isn't thread safe
+	size_t size;
+} stripplane_t;
+
+typedef struct
+{
+	job_t job;
+	int x1, x2; // columns of the view this strip covers
+} planestrip_t;
+
+static stripplane_t *stripplanes;
+static size_t numstripplanes, maxstripplanes;
+static planestrip_t planestrips[MAXPLANESTRIPS];
+
+static void R_DrawPlaneStrip(void *data)
+{
+	const planestrip_t *strip = data;
+	visplane_t *pl;
+	angle_t planeangle = 0, angle;
+	boolean scaled = false;
+	int light, x, x1, x2;
+	size_t i;
+
+	itswater = false;
+
+	for (i = 0; i < numstripplanes; i++)
+	{
+		pl = stripplanes[i].pl;
+		x1 = pl->minx > strip->x1 ? pl->minx : strip->x1;
+		x2 = pl->maxx < strip->x2 ? pl->maxx : strip->x2;
+		if (x1 > x2)
+			continue;
+
+		// R_ClearPlanes only resets the main thread's span cache
+		if (!scaled || pl->viewangle != planeangle)
+		{
+			memset(cachedheight, 0, sizeof (cachedheight));
+			angle = (pl->viewangle-ANG90)>>ANGLETOFINESHIFT;
+			basexscale = FixedDiv(FINECOSINE(angle),centerxfrac);
+			baseyscale = -FixedDiv(FINESINE(angle),centerxfrac);
+			planeangle = pl->viewangle;
+			scaled = true;
+		}
+
+		currentplane = pl;
+		ds_source = stripplanes[i].source;
+		R_SetFlatSize(stripplanes[i].size);
+
+		xoffs = pl->xoffs;
+		yoffs = pl->yoffs;
+		planeheight = abs(pl->height - pl->viewz);
+
+		light = (pl->lightlevel >> LIGHTSEGSHIFT);
+		if (light >= LIGHTLEVELS)
+			light = LIGHTLEVELS-1;
+		if (light < 0)
+			light = 0;
+		planezlight = zlight[light];
+
+		// Columns outside the strip count as empty, so the spans end at its edges
+		R_MakeSpans(x1, 0xffff, 0x0000, pl->top[x1], pl->bottom[x1]);
+		for (x = x1 + 1; x <= x2; x++)
+			R_MakeSpans(x, pl->top[x-1], pl->bottom[x-1], pl->top[x], pl->bottom[x]);
+		R_MakeSpans(x2 + 1, pl->top[x2], pl->bottom[x2], 0xffff, 0x0000);
+	}
+}
+
+// How many strips to draw the planes in, 1 to draw them the old way
+static int R_PlaneStrips(void)
+{
+	int strips = cv_renderthreads.value;
+
+	// the draw commands are written down on this thread only
+	if (!I_NumWorkers() || batchingdraws)
+		return 1;
+
+	if (!strips) // automatic, one for every thread
+		strips = I_NumWorkers() + 1;
+
+	if (strips > MAXPLANESTRIPS)
+		strips = MAXPLANESTRIPS;
+	if (strips > viewwidth)
+		strips = viewwidth;
+
+	return strips;
+}
+
+static void R_DrawPlanesInStrips(int strips)
+{
+	visplane_t *pl;
+	stripplane_t *sp;
 	int i;
+	size_t p;
+
+	// Gather the planes the strips will draw and get their flats ready
+	numstripplanes = 0;
+	for (i = 0; i < MAXVISPLANES; i++)
+	{
+		for (pl = visplanes[i]; pl; pl = pl->next)
+		{
+			if (pl->picnum == skyflatnum || pl->ffloor != NULL || pl->minx > pl->maxx)
+				continue;
+
+			if (numstripplanes >= maxstripplanes)
+			{
+				maxstripplanes = maxstripplanes ? maxstripplanes*2 : 128;
+				stripplanes = realloc(stripplanes, maxstripplanes * sizeof (*stripplanes));
+				if (!stripplanes)
+					I_Error("R_DrawPlanes: out of memory");
+			}
+
+			sp = &stripplanes[numstripplanes++];
+			sp->pl = pl;
+			sp->source = W_CacheLumpNum(levelflats[pl->picnum].lumpnum, PU_STATIC);
+			sp->size = W_LumpLength(levelflats[pl->picnum].lumpnum);
+		}
+	}
+
+	for (i = 0; i < strips; i++)
+	{
+		planestrips[i].x1 = viewwidth*i/strips;
+		planestrips[i].x2 = viewwidth*(i+1)/strips - 1;
+		planestrips[i].job.func = R_DrawPlaneStrip;
+		planestrips[i].job.data = &planestrips[i];
+		I_QueueJob(&planestrips[i].job);
+	}
+
+	// The sky may have to build its texture, so it stays on this thread
+	// and is drawn while the strips are busy
+	for (i = 0; i < MAXVISPLANES; i++)
+		for (pl = visplanes[i]; pl; pl = pl->next)
+			if (pl->picnum == skyflatnum)
+				R_DrawSkyPlane(pl);
+
+	for (i = 0; i < strips; i++)
+		I_WaitJob(&planestrips[i].job);
+
+	for (p = 0; p < numstripplanes; p++)
+		Z_ChangeTag(stripplanes[p].source, PU_CACHE);
+}
+#endif
+
+void R_DrawPlanes(void)
+{
+	visplane_t *pl;
+	int i;
+#ifdef RENDERTHREADS
+	int strips;
+#endif
 
 	spanfunc = basespanfunc;
 	wallcolfunc = walldrawerfunc;
@@ -1379,39 +1639,20 @@ void R_DrawPlanes(void)
 	slopefunc = R_DrawSlope_8_64;
 #endif
 
-	for (i = 0; i < MAXVISPLANES; i++, pl++)
+#ifdef RENDERTHREADS
+	strips = R_PlaneStrips();
+	if (strips > 1)
+		R_DrawPlanesInStrips(strips);
+	else
+#endif
+	for (i = 0; i < MAXVISPLANES; i++)
 	{
 		for (pl = visplanes[i]; pl; pl = pl->next)
 		{
-			// sky flat, // SKWALL : this also draws the sky clipping walls
+			// sky flat
 			if (pl->picnum == skyflatnum)
 			{
-				// use correct aspect ratio scale
-				dc_iscale = skyscale;
-
-				// Sky is always drawn full bright,
-				//  i.e. colormaps[0] is used.
-				// Because of this hack, sky is not affected
-				//  by INVUL inverse mapping.
-				dc_colormap = colormaps;
-				dc_texturemid = skytexturemid;
-				dc_texheight = textureheight[skytexture]
-					>>FRACBITS;
-				for (x = pl->minx; x <= pl->maxx; x++)
-				{
-					dc_yl = pl->top[x];
-					dc_yh = pl->bottom[x];
-
-					if (dc_yl <= dc_yh)
-					{
-						angle = (viewangle + xtoviewangle[x])>>ANGLETOSKYSHIFT;
-						dc_x = x;
-						dc_source =
-							R_GetColumn(skytexture,
-								angle);
-						wallcolfunc();
-					}
-				}
+				R_DrawSkyPlane(pl);
 				continue;
 			}
 
@@ -1430,7 +1671,6 @@ void R_DrawSinglePlane(visplane_t *pl) // this is do_draw_plane in Eternity
 	int light = 0;
 	int x;
 	int stop, angle;
-	size_t size;
 
 	if (!(pl->minx <= pl->maxx))
 		return;
@@ -1441,7 +1681,7 @@ void R_DrawSinglePlane(visplane_t *pl) // this is do_draw_plane in Eternity
 	{
 		if (pl->ffloor->flags & FF_TRANSLUCENT)
 		{
-			spanfunc = R_DrawTranslucentSpan_8;
+			spanfunc = transspanfunc;
 
 			// Hacked up support for alpha value in software mode
 			if (pl->ffloor->alpha < 12)
@@ -1485,7 +1725,7 @@ void R_DrawSinglePlane(visplane_t *pl) // this is do_draw_plane in Eternity
 			int top, bottom;
 
 			itswater = true;
-			if (spanfunc == R_DrawTranslucentSpan_8)
+			if (spanfunc == transspanfunc)
 			{
 				spanfunc = R_DrawTranslucentWaterSpan_8;
 
@@ -1523,53 +1763,7 @@ void R_DrawSinglePlane(visplane_t *pl) // this is do_draw_plane in Eternity
 		W_CacheLumpNum(levelflats[pl->picnum].lumpnum,
 			PU_STATIC); // Stay here until Z_ChangeTag
 
-	size = W_LumpLength(levelflats[pl->picnum].lumpnum);
-
-	switch (size)
-	{
-		case 4194304: // 2048x2048 lump
-			nflatmask = 0x3FF800;
-			nflatxshift = 21;
-			nflatyshift = 10;
-			nflatshiftup = 5;
-			break;
-		case 1048576: // 1024x1024 lump
-			nflatmask = 0xFFC00;
-			nflatxshift = 22;
-			nflatyshift = 12;
-			nflatshiftup = 6;
-			break;
-		case 262144:// 512x512 lump'
-			nflatmask = 0x3FE00;
-			nflatxshift = 23;
-			nflatyshift = 14;
-			nflatshiftup = 7;
-			break;
-		case 65536: // 256x256 lump
-			nflatmask = 0xFF00;
-			nflatxshift = 24;
-			nflatyshift = 16;
-			nflatshiftup = 8;
-			break;
-		case 16384: // 128x128 lump
-			nflatmask = 0x3F80;
-			nflatxshift = 25;
-			nflatyshift = 18;
-			nflatshiftup = 9;
-			break;
-		case 1024: // 32x32 lump
-			nflatmask = 0x3E0;
-			nflatxshift = 27;
-			nflatyshift = 22;
-			nflatshiftup = 11;
-			break;
-		default: // 64x64 lump
-			nflatmask = 0xFC0;
-			nflatxshift = 26;
-			nflatyshift = 20;
-			nflatshiftup = 10;
-			break;
-	}
+	R_SetFlatSize(W_LumpLength(levelflats[pl->picnum].lumpnum));
 
 	xoffs = pl->xoffs;
 	yoffs = pl->yoffs;
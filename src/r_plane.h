@@ -24,6 +24,7 @@
 #include "r_data.h"
 #include "p_polyobj.h"
 #include "p_slopes.h"
+#include "r_draw.h" // RENDERTLS
 
 //
 // Now what is a visplane, anyway?
@@ -164,11 +165,11 @@ typedef void (*planefunction_t)(int top, int bottom);
 
 extern short floorclip[MAXVIDWIDTH], ceilingclip[MAXVIDWIDTH];
 extern fixed_t frontscale[MAXVIDWIDTH], yslopetab[MAXVIDHEIGHT*4];
-extern fixed_t cachedheight[MAXVIDHEIGHT];
-extern fixed_t cacheddistance[MAXVIDHEIGHT];
-extern fixed_t cachedxstep[MAXVIDHEIGHT];
-extern fixed_t cachedystep[MAXVIDHEIGHT];
-extern fixed_t basexscale, baseyscale;
+extern RENDERTLS fixed_t cachedheight[MAXVIDHEIGHT];
+extern RENDERTLS fixed_t cacheddistance[MAXVIDHEIGHT];
+extern RENDERTLS fixed_t cachedxstep[MAXVIDHEIGHT];
+extern RENDERTLS fixed_t cachedystep[MAXVIDHEIGHT];
+extern RENDERTLS fixed_t basexscale, baseyscale;
 
 extern fixed_t *yslope;
 extern fixed_t distscale[MAXVIDWIDTH];
@@ -1212,7 +1212,7 @@ static void R_RenderSegLoop(void)
 		dc_source = R_GetColumn(midtexture,texturecolumn);
 		dc_texheight = textureheight[midtexture]>>FRACBITS;
 
-		colfunc();
+		R_ColumnCommand(colfunc);
 
 		// dont draw anything more for this column, since
 		// a midtexture blocks the view
@@ -1238,7 +1238,7 @@ static void R_RenderSegLoop(void)
 				dc_texturemid = rw_toptexturemid;
 				dc_source = R_GetColumn(toptexture,texturecolumn);
 				dc_texheight = textureheight[toptexture]>>FRACBITS;
-				colfunc();
+				R_ColumnCommand(colfunc);
 				ceilingclip[rw_x] = (short)mid;
 			}
 			else
@@ -1265,7 +1265,7 @@ static void R_RenderSegLoop(void)
 					dc_source = R_GetColumn(bottomtexture,
 						texturecolumn);
 					dc_texheight = textureheight[bottomtexture]>>FRACBITS;
-					colfunc();
+					R_ColumnCommand(colfunc);
 					floorclip[rw_x] = (short)mid;
 				}
 				else
@@ -1342,12 +1342,16 @@ void R_StoreWallRange(const int start, const int stop)
 		if (firstseg)
 			firstseg = (drawseg_t *)(firstseg - drawsegs);
 		drawsegs = realloc(drawsegs, newmax*sizeof (*drawsegs));
+		if (!drawsegs)
+			I_Error("R_StoreWallRange: out of memory for %"PRIdS" drawsegs\n", newmax);
 		ds_p = drawsegs + pos;
 		firstnewseg = drawsegs + pos2;
 		maxdrawsegs = newmax;
+		drawsegusage.size = maxdrawsegs;
 		if (firstseg)
 			firstseg = drawsegs + (size_t)firstseg;
 	}
+	R_NoteUsage(drawsegusage, (size_t)(ds_p - drawsegs) + 1);
 
 	sidedef = curline->sidedef;
 	linedef = curline->linedef;
@@ -1422,13 +1426,19 @@ void R_StoreWallRange(const int start, const int stop)
 		{
 			drawseg_t *ds;  // needed for fix from *cough* ZDoom *cough*
 			short *oldopenings = openings;
-			short *oldlast = lastopening;
 
 			do
 				maxopenings = maxopenings ? maxopenings*2 : 16384;
 			while (need > maxopenings);
-				openings = realloc(openings, maxopenings * sizeof (*openings));
-			
+			// not realloc: the old block has to stay valid until the
+			// drawsegs pointing into it have been moved over
+			openings = malloc(maxopenings * sizeof (*openings));
+			if (!openings)
+				I_Error("R_StoreWallRange: out of memory for %"PRIdS" openings\n", maxopenings);
+			if (oldopenings)
+				memcpy(openings, oldopenings, pos * sizeof (*openings));
+			openingusage.size = maxopenings;
+
 			lastopening = openings + pos;
 
 			// borrowed fix from *cough* ZDoom *cough*
@@ -1436,14 +1446,16 @@ void R_StoreWallRange(const int start, const int stop)
 			//    were already stored in drawsegs.
 			for (ds = drawsegs; ds < ds_p; ds++)
 			{
-#define ADJUST(p) if (ds->p + ds->x1 >= oldopenings && ds->p + ds->x1 <= oldlast) ds->p = ds->p - oldopenings + openings;
+#define ADJUST(p) if (ds->p + ds->x1 >= oldopenings && ds->p + ds->x1 <= oldopenings + pos) ds->p = openings + (ds->p - oldopenings);
 				ADJUST(maskedtexturecol);
 				ADJUST(sprtopclip);
 				ADJUST(sprbottomclip);
 				ADJUST(thicksidecol);
 #undef ADJUST
 			}
+			free(oldopenings);
 		}
+		R_NoteUsage(openingusage, need);
 	}  // end of code to remove limits on openings
 
 	// calculate scale at both ends and step
@@ -35,6 +35,8 @@
 #include "d_netfil.h"
 #include "hardware/hw_md2.h"
 
+#include <time.h> // clock, for sortbench
+
 static void R_InitSkins(void);
 
 #define MINZ (FRACUNIT*4)
@@ -470,8 +472,12 @@ void R_DelSpriteDefs(USHORT wadnum)
 //
 // GAME FUNCTIONS
 //
-static vissprite_t vissprites[MAXVISSPRITES];
-static vissprite_t *vissprite_p;
+// Vissprites are handed out from chunks that are kept from frame to
+// frame, see renderchunks_t.
+#define VISSPRITE(i) ((vissprite_t *)R_ChunkElem(&visspritechunks, i))
+
+renderusage_t visspriteusage = {"vissprites", 0, 0, 0};
+static renderchunks_t visspritechunks = {"vissprites", sizeof (vissprite_t), &visspriteusage, NULL, 0, 0};
 
 //
 // R_InitSprites
@@ -527,21 +533,15 @@ void R_InitSprites(void)
 //
 void R_ClearSprites(void)
 {
-	vissprite_p = vissprites;
+	R_ClearChunkArray(&visspritechunks);
 }
 
 //
 // R_NewVisSprite
 //
-static vissprite_t overflowsprite;
-
 static vissprite_t *R_NewVisSprite(void)
 {
-	if (vissprite_p == &vissprites[MAXVISSPRITES])
-		return &overflowsprite;
-
-	vissprite_p++;
-	return vissprite_p-1;
+	return R_NewChunkElem(&visspritechunks);
 }
 
 //
@@ -1372,8 +1372,10 @@ static void R_ProjectSprite(mobj_t *thing)
 		R_SplitSprite(vis, thing);
 }
 
-static void R_ProjectPrecipitationSprite(precipmobj_t *thing)
+static void R_ProjectPrecipitationSprite(sector_t *sector, size_t drop)
 {
+	const fixed_t dropx = precipdrops.x[drop], dropy = precipdrops.y[drop], dropz = precipdrops.z[drop];
+	const state_t *st = &states[precipdrops.state[drop]];
 	fixed_t tr_x, tr_y;
 	fixed_t gxt, gyt;
 	fixed_t tx, tz;
@@ -1392,8 +1394,8 @@ static void R_ProjectPrecipitationSprite(precipmobj_t *thing)
 	fixed_t gzt;
 
 	// Transform the origin point
-	tr_x = thing->x - viewx;
-	tr_y = thing->y - viewy;
+	tr_x = dropx - viewx;
+	tr_y = dropy - viewy;
 
 	gxt = FixedMul(tr_x, viewcos);
 	gyt = -FixedMul(tr_y, viewsin);
@@ -1417,28 +1419,28 @@ static void R_ProjectPrecipitationSprite(precipmobj_t *thing)
 	yscale = FixedDiv(projectiony, tz);
 
 	// Decide which patch to use for sprite relative to player
-	if ((unsigned int)thing->sprite >= numsprites)
+	if ((unsigned int)st->sprite >= numsprites)
 #ifdef RANGECHECK
 		I_Error("R_ProjectSprite: invalid sprite number %d ",
-				thing->sprite);
+				st->sprite);
 #else
 	return;
 #endif
 
-	sprdef = &sprites[thing->sprite];
+	sprdef = &sprites[st->sprite];
 
-	if ((byte)(thing->frame&FF_FRAMEMASK) >= sprdef->numframes)
+	if ((byte)(st->frame&FF_FRAMEMASK) >= sprdef->numframes)
 #ifdef RANGECHECK
 		I_Error("R_ProjectSprite: invalid sprite frame %d : %d for %s",
-				thing->sprite, thing->frame, sprnames[thing->sprite]);
+				st->sprite, st->frame, sprnames[st->sprite]);
 #else
 	return;
 #endif
 
-	sprframe = &sprdef->spriteframes[thing->frame & FF_FRAMEMASK];
+	sprframe = &sprdef->spriteframes[st->frame & FF_FRAMEMASK];
 
 	if (!sprframe)
-		I_Error("R_ProjectPrecipitationSprite: sprframes NULL for sprite %d\n", thing->sprite);
+		I_Error("R_ProjectPrecipitationSprite: sprframes NULL for sprite %d\n", st->sprite);
 
 	// use single rotation for all views
 	lump = sprframe->lumpid[0];     //Fab: see note above
@@ -1459,30 +1461,30 @@ static void R_ProjectPrecipitationSprite(precipmobj_t *thing)
 		return;
 
 	// Disregard sprites that are out of view..
-	gzt = thing->z + spritecachedinfo[lump].topoffset;
+	gzt = dropz + spritecachedinfo[lump].topoffset;
 
-	if (thing->subsector->sector->cullheight)
+	if (sector->cullheight)
 	{
-		if (thing->subsector->sector->cullheight->flags & ML_NOCLIMB) // Group culling
+		if (sector->cullheight->flags & ML_NOCLIMB) // Group culling
 		{
 			// Make sure this is part of the same group
 			if (viewsector->cullheight && viewsector->cullheight->frontsector
-				== thing->subsector->sector->cullheight->frontsector)
+				== sector->cullheight->frontsector)
 			{
 				// OK, we can cull
-				if (viewz > thing->subsector->sector->cullheight->frontsector->floorheight
-					&& gzt < thing->subsector->sector->cullheight->frontsector->floorheight) // Cull if below plane
+				if (viewz > sector->cullheight->frontsector->floorheight
+					&& gzt < sector->cullheight->frontsector->floorheight) // Cull if below plane
 					return;
-				else if (gzt - spritecachedinfo[lump].height > thing->subsector->sector->cullheight->frontsector->floorheight) // Cull if above plane
+				else if (gzt - spritecachedinfo[lump].height > sector->cullheight->frontsector->floorheight) // Cull if above plane
 					return;
 			}
 		}
 		else // Quick culling
 		{
-			if (viewz > thing->subsector->sector->cullheight->frontsector->floorheight
-				&& gzt < thing->subsector->sector->cullheight->frontsector->floorheight) // Cull if below plane
+			if (viewz > sector->cullheight->frontsector->floorheight
+				&& gzt < sector->cullheight->frontsector->floorheight) // Cull if below plane
 				return;
-			else if (gzt - spritecachedinfo[lump].height > thing->subsector->sector->cullheight->frontsector->floorheight) // Cull if above plane
+			else if (gzt - spritecachedinfo[lump].height > sector->cullheight->frontsector->floorheight) // Cull if above plane
 				return;
 		}
 	}
@@ -1490,19 +1492,19 @@ static void R_ProjectPrecipitationSprite(precipmobj_t *thing)
 	// store information in a vissprite
 	vis = R_NewVisSprite();
 	vis->scale = yscale; //<<detailshift;
-	vis->gx = thing->x;
-	vis->gy = thing->y;
+	vis->gx = dropx;
+	vis->gy = dropy;
 	vis->gz = gzt - spritecachedinfo[lump].height;
 	vis->gzt = gzt;
 	vis->thingheight = 4*FRACUNIT;
-	vis->pz = thing->z;
+	vis->pz = dropz;
 	vis->pzt = vis->pz + vis->thingheight;
 	vis->texturemid = vis->gzt - viewz;
 
 	vis->x1 = x1 < 0 ? 0 : x1;
 	vis->x2 = x2 >= viewwidth ? viewwidth-1 : x2;
 	vis->xscale = xscale;
-	vis->sector = thing->subsector->sector;
+	vis->sector = sector;
 	vis->szt = (short)((centeryfrac - FixedMul(vis->gzt - viewz, yscale))>>FRACBITS);
 	vis->sz = (short)((centeryfrac - FixedMul(vis->gz - viewz, yscale))>>FRACBITS);
 
@@ -1519,15 +1521,15 @@ static void R_ProjectPrecipitationSprite(precipmobj_t *thing)
 	vis->patch = sprframe->lumppat[0];
 
 	// specific translucency
-	if (thing->frame & FF_TRANSMASK)
-		vis->transmap = (thing->frame & FF_TRANSMASK) - 0x10000 + transtables;
+	if (st->frame & FF_TRANSMASK)
+		vis->transmap = (st->frame & FF_TRANSMASK) - 0x10000 + transtables;
 	else
 		vis->transmap = NULL;
 
 	vis->mobjflags = 0;
 	vis->cut = false;
-	vis->extra_colormap = thing->subsector->sector->extra_colormap;
-	vis->heightsec = thing->subsector->sector->heightsec;
+	vis->extra_colormap = sector->extra_colormap;
+	vis->heightsec = sector->heightsec;
 
 	// Fullbright
 	vis->colormap = colormaps;
@@ -1535,13 +1537,49 @@ static void R_ProjectPrecipitationSprite(precipmobj_t *thing)
 	vis->vflip = false;
 }
 
+// Projects every drop in a sector near enough to the player to be seen
+static void R_ProjectPrecipitation(sector_t *sec)
+{
+	const mobj_t *mo = players[displayplayer].mo;
+	const mobj_t *mo2 = (splitscreen && rendersplit) ? players[secondarydisplayplayer].mo : NULL;
+	const size_t end = sec->firstprecip + sec->numprecip;
+	fixed_t adx, ady, approx_dist;
+	size_t i;
+
+	if (!sec->numprecip || !precipdrops.block || precipdrops.hidden)
+		return;
+
+	for (i = sec->firstprecip; i < end; i++)
+	{
+		adx = abs(mo->x - precipdrops.x[i]);
+		ady = abs(mo->y - precipdrops.y[i]);
+
+		// From _GG1_ p.428. Approx. eucledian distance fast.
+		approx_dist = adx + ady - ((adx < ady ? adx : ady)>>1);
+
+		// Only draw the precipitation oh-so-far from the player.
+		if (approx_dist < (2320 << FRACBITS))
+			R_ProjectPrecipitationSprite(sec, i);
+		else if (mo2)
+		{
+			adx = abs(mo2->x - precipdrops.x[i]);
+			ady = abs(mo2->y - precipdrops.y[i]);
+
+			// From _GG1_ p.428. Approx. eucledian distance fast.
+			approx_dist = adx + ady - ((adx < ady ? adx : ady)>>1);
+
+			if (approx_dist < (2320 << FRACBITS))
+				R_ProjectPrecipitationSprite(sec, i);
+		}
+	}
+}
+
 // R_AddSprites
 // During BSP traversal, this adds sprites by sector.
 //
 void R_AddSprites(sector_t *sec, int lightlevel)
 {
 	mobj_t *thing;
-	precipmobj_t *precipthing;
 	int lightnum;
 	fixed_t adx, ady, approx_dist;
 
@@ -1624,45 +1662,97 @@ void R_AddSprites(sector_t *sec, int lightlevel)
 
 	// Special function for precipitation
 	if (playeringame[displayplayer] && players[displayplayer].mo)
-	{
-		for (precipthing = sec->preciplist; precipthing; precipthing = precipthing->snext)
-		{
-			if (!precipthing)
-				continue;
+		R_ProjectPrecipitation(sec);
+}
 
-			if (precipthing->invisible)
-				continue;
+//
+// R_SortVisSprites
+// Orders the vissprites from farthest to nearest. Sprites of the same
+// scale stay in the order they were added, so this is a radix sort on
+// the scale a byte at a time, which keeps equal keys in place.
+//
+static vissprite_t vsprsortedhead;
+static UINT32 *vsprorder[2] = {NULL, NULL};
+static UINT32 *vsprkey = NULL;
+static size_t maxvsprorder = 0;
 
-			adx = abs(players[displayplayer].mo->x - precipthing->x);
-			ady = abs(players[displayplayer].mo->y - precipthing->y);
+void R_SortVisSprites(void)
+{
+	size_t       i, count, sum, n;
+	size_t       counts[256];
+	unsigned int shift;
+	UINT32      *src, *dst, *swap;
+	vissprite_t *ds, *prev;
 
-			// From _GG1_ p.428. Approx. eucledian distance fast.
-			approx_dist = adx + ady - ((adx < ady ? adx : ady)>>1);
+	count = visspritechunks.count;
 
-			// Only draw the precipitation oh-so-far from the player.
-			if (approx_dist < (2320 << FRACBITS))
-				R_ProjectPrecipitationSprite(precipthing);
-			else if ((splitscreen && rendersplit) && players[secondarydisplayplayer].mo)
-			{
-				adx = abs(players[secondarydisplayplayer].mo->x - precipthing->x);
-				ady = abs(players[secondarydisplayplayer].mo->y - precipthing->y);
+	vsprsortedhead.next = vsprsortedhead.prev = &vsprsortedhead;
 
-				// From _GG1_ p.428. Approx. eucledian distance fast.
-				approx_dist = adx + ady - ((adx < ady ? adx : ady)>>1);
+	if (!count)
+		return;
 
-				if (approx_dist < (2320 << FRACBITS))
-					R_ProjectPrecipitationSprite (precipthing);
-			}
+	// the sort arrays follow the sprite chunks up
+	if (count > maxvsprorder)
+	{
+		maxvsprorder = visspritechunks.numchunks*RENDERCHUNKSIZE;
+		vsprorder[0] = realloc(vsprorder[0], maxvsprorder * sizeof (*vsprorder[0]));
+		vsprorder[1] = realloc(vsprorder[1], maxvsprorder * sizeof (*vsprorder[1]));
+		vsprkey = realloc(vsprkey, maxvsprorder * sizeof (*vsprkey));
+		if (!vsprorder[0] || !vsprorder[1] || !vsprkey)
+			I_Error("R_SortVisSprites: out of memory for %"PRIdS" vissprites\n", maxvsprorder);
+	}
+	src = vsprorder[0];
+	dst = vsprorder[1];
+
+	for (i = 0; i < count; i++)
+	{
+		// flip the sign bit so the scales sort as unsigned numbers
+		vsprkey[i] = (UINT32)VISSPRITE(i)->scale ^ 0x80000000;
+		src[i] = (UINT32)i;
+	}
+
+	for (shift = 0; shift < 32; shift += 8)
+	{
+		memset(counts, 0, sizeof (counts));
+		for (i = 0; i < count; i++)
+			counts[(vsprkey[i] >> shift) & 0xff]++;
+
+		// all the sprites share this byte, nothing would move
+		if (counts[(vsprkey[0] >> shift) & 0xff] == count)
+			continue;
+
+		for (i = sum = 0; i < 256; i++)
+		{
+			n = counts[i];
+			counts[i] = sum;
+			sum += n;
 		}
+
+		for (i = 0; i < count; i++)
+			dst[counts[(vsprkey[src[i]] >> shift) & 0xff]++] = src[i];
+
+		swap = src;
+		src = dst;
+		dst = swap;
 	}
+
+	prev = &vsprsortedhead;
+	for (i = 0; i < count; i++)
+	{
+		ds = VISSPRITE(src[i]);
+		ds->prev = prev;
+		prev->next = ds;
+		prev = ds;
+	}
+	prev->next = &vsprsortedhead;
+	vsprsortedhead.prev = prev;
 }
 
 //
-// R_SortVisSprites
+// R_SelectionSortVisSprites
+// The old quadratic sort, kept for sortbench to check against
 //
-static vissprite_t vsprsortedhead;
-
-void R_SortVisSprites(void)
+static void R_SelectionSortVisSprites(void)
 {
 	size_t       i, count;
 	vissprite_t *ds;
@@ -1670,23 +1760,23 @@ void R_SortVisSprites(void)
 	vissprite_t  unsorted;
 	fixed_t      bestscale;
 
-	count = vissprite_p - vissprites;
+	count = visspritechunks.count;
 
 	unsorted.next = unsorted.prev = &unsorted;
 
 	if (!count)
 		return;
 
-	for (ds = vissprites; ds < vissprite_p; ds++)
+	// the sprites aren't all in one array any more, so link them by index
+	for (i = 0; i < count; i++)
 	{
-		ds->next = ds+1;
-		ds->prev = ds-1;
+		ds = VISSPRITE(i);
+		ds->next = i+1 < count ? VISSPRITE(i+1) : &unsorted;
+		ds->prev = i ? VISSPRITE(i-1) : &unsorted;
 	}
 
-	vissprites[0].prev = &unsorted;
-	unsorted.next = &vissprites[0];
-	(vissprite_p-1)->next = &unsorted;
-	unsorted.prev = vissprite_p-1;
+	unsorted.next = VISSPRITE(0);
+	unsorted.prev = VISSPRITE(count-1);
 
 	// pull the vissprites out by scale
 	vsprsortedhead.next = vsprsortedhead.prev = &vsprsortedhead;
@@ -1710,6 +1800,63 @@ void R_SortVisSprites(void)
 	}
 }
 
+/** \brief Times R_SortVisSprites against the old selection sort
+
+	sortbench [reps] sorts 100, 1000 and 2048 sprites of random
+	scale, with plenty of ties, and checks both sorts give the same order.
+	Don't use it in the middle of a frame; the next frame clears the
+	sprites it leaves behind.
+*/
+void Command_SortBench_f(void)
+{
+	const size_t sizes[] = {100, 1000, 2048};
+	vissprite_t *order[2048];
+	vissprite_t *ds;
+	size_t s, i, rep, reps = 200;
+	clock_t start;
+	double oldtime, newtime;
+	boolean same;
+
+	if (COM_Argc() > 1 && atoi(COM_Argv(1)) > 0)
+		reps = atoi(COM_Argv(1));
+
+	srand(1);
+	for (s = 0; s < sizeof (sizes)/sizeof (sizes[0]); s++)
+	{
+		R_ClearSprites();
+		for (i = 0; i < sizes[s]; i++)
+		{
+			ds = memset(R_NewVisSprite(), 0, sizeof (*ds));
+			ds->scale = FRACUNIT/16 + (rand() % 1024) * (FRACUNIT/64);
+		}
+
+		start = clock();
+		for (rep = 0; rep < reps; rep++)
+			R_SelectionSortVisSprites();
+		oldtime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+		for (i = 0, ds = vsprsortedhead.next; ds != &vsprsortedhead; ds = ds->next)
+			order[i++] = ds;
+
+		start = clock();
+		for (rep = 0; rep < reps; rep++)
+			R_SortVisSprites();
+		newtime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+		same = true;
+		for (i = 0, ds = vsprsortedhead.next; ds != &vsprsortedhead; ds = ds->next)
+			if (order[i++] != ds)
+				same = false;
+
+		CONS_Printf("%4d sprites: selection %8.1f us, radix %6.1f us%s\n", (int)sizes[s],
+			oldtime * 1000000 / reps, newtime * 1000000 / reps,
+			same ? "" : " (ORDER DIFFERS)");
+	}
+
+	R_ClearSprites();
+	vsprsortedhead.next = vsprsortedhead.prev = &vsprsortedhead;
+}
+
 //
 // R_CreateDrawNodes
 // Creates and sorts a list of drawnodes for the scene being rendered.
@@ -1787,7 +1934,7 @@ static void R_CreateDrawNodes(void)
 		}
 	}
 
-	if (vissprite_p == vissprites)
+	if (!visspritechunks.count)
 		return;
 
 	R_SortVisSprites();
@@ -27,8 +27,6 @@
 // Fab: this is a hack : should allocate the lookup tables per sprite
 #define	MAXSPRITELUMPS 8192 // Increase maxspritelumps Graue 11-06-2003
 
-#define MAXVISSPRITES 2048 // added 2-2-98 was 128
-
 // Constant arrays used for psprite clipping
 //  and initializing clipping.
 extern short negonearray[MAXVIDWIDTH];
@@ -45,6 +43,7 @@ extern fixed_t windowbottom;
 
 void R_DrawMaskedColumn(column_t *column);
 void R_SortVisSprites(void);
+void Command_SortBench_f(void);
 
 // Find sprites in wadfile, replace existing, add new ones
 // (only sprites from namelist are added or replaced)
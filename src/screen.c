@@ -54,6 +54,7 @@ void (*spanfunc)(void); // span drawer, use a 64x64 tile
 void (*splatfunc)(void); // span drawer w/ transparency
 void (*basespanfunc)(void); // default span func for color mode
 void (*transtransfunc)(void); // translucent translated column drawer
+void (*transspanfunc)(void); // translucent span drawer
 
 // ------------------
 // global video state
@@ -95,6 +96,7 @@ boolean R_MMX = false; //R_DrawColumn8_K6_MMX
 boolean R_3DNow = false;
 boolean R_MMXExt = false;
 boolean R_SSE2 = false;
+boolean R_AVX2 = false;
 
 
 void SCR_SetMode(void)
@@ -115,6 +117,19 @@ void SCR_SetMode(void)
 	if (vid.bpp == 1)
 	{
 		basespanfunc = R_DrawSpan_8;
+		transspanfunc = R_DrawTranslucentSpan_8;
+#ifdef SIMDDRAWERS
+		if (R_AVX2)
+		{
+			basespanfunc = R_DrawSpan_8_AVX2;
+			transspanfunc = R_DrawTranslucentSpan_8_AVX2;
+		}
+		else if (R_SSE2)
+		{
+			basespanfunc = R_DrawSpan_8_SSE2;
+			transspanfunc = R_DrawTranslucentSpan_8_SSE2;
+		}
+#endif
 		spanfunc = basespanfunc;
 		splatfunc = R_DrawSplat_8;
 		transcolfunc = R_DrawTranslatedColumn_8;
@@ -153,6 +168,7 @@ void SCR_SetMode(void)
 	{
 		CONS_Printf("using highcolor mode\n");
 		spanfunc = basespanfunc = R_DrawSpan_16;
+		transspanfunc = R_DrawTranslucentSpan_8;
 #ifdef SESLOPE
 		slopefunc = R_DrawSlope_8_64;
 #endif
@@ -199,6 +215,19 @@ void SCR_Startup(void)
 		            R_486, R_586, R_MMX, R_3DNow, R_MMXExt, R_SSE2);
 	}
 
+#ifdef SIMDDRAWERS
+	// I_CPUInfo doesn't know about AVX2, and gives nothing at all on some systems
+	if (!M_CheckParm("-NOCPUID"))
+	{
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("sse2"))
+			R_SSE2 = true;
+		if (__builtin_cpu_supports("avx2"))
+			R_AVX2 = true;
+		CONS_Printf("CPU Info: SSE2: %i, AVX2: %i\n", R_SSE2, R_AVX2);
+	}
+#endif
+
 	if (M_CheckParm("-noASM"))
 		R_ASM = false;
 	if (M_CheckParm("-486"))
@@ -213,6 +242,8 @@ void SCR_Startup(void)
 		R_MMXExt = true;
 	if (M_CheckParm("-SSE2"))
 		R_SSE2 = true;
+	if (M_CheckParm("-AVX2"))
+		R_AVX2 = true;
 
 #if defined (_WIN32) && !defined (_WIN32_WCE) && !defined (_XBOX)
 	if (!RCpuInfo || !RCpuInfo->CPUs) // bad CPU ID code?
@@ -149,6 +149,7 @@ extern void (*slopefunc)(void);
 #endif
 extern void (*splatfunc)(void);
 extern void (*transtransfunc)(void);
+extern void (*transspanfunc)(void);
 
 // -----
 // CPUID
@@ -160,6 +161,7 @@ extern boolean R_MMX;
 extern boolean R_3DNow;
 extern boolean R_MMXExt;
 extern boolean R_SSE2;
+extern boolean R_AVX2;
 
 // ----------------
 // screen variables
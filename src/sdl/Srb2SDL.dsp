@@ -647,10 +647,18 @@ SOURCE=..\i_system.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\i_threads.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\i_tcp.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\i_threads.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\i_tcp.h
 # End Source File
 # Begin Source File
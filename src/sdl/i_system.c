@@ -130,7 +130,10 @@ void __set_fpscr(long); // in libgcc / kernel's startup.s?
 #if defined (__linux__) || (defined (UNIXLIKE) && !defined (_arch_dreamcast) && !defined (_PSP))
 #include <termios.h>
 #include <sys/ioctl.h> // ioctl
+#include <sys/time.h>
+#include <time.h> // clock_gettime
 #define HAVE_TERMIOS
+#define HAVE_GETTIMEOFDAY
 #endif
 
 #if defined (__linux__) // need -lrt
@@ -1960,6 +1963,37 @@ void I_StartupTimer(void)
 
 
 
+//
+// I_GetTimeMicros
+//
+UINT64 I_GetTimeMicros(void)
+{
+#if (defined (_WIN32) && !defined (_WIN32_WCE)) && !defined (_XBOX)
+	static LARGE_INTEGER frequency = {{0, 0}};
+	LARGE_INTEGER now;
+
+	if (!frequency.QuadPart && !QueryPerformanceFrequency(&frequency))
+		frequency.QuadPart = -1;
+
+	if (frequency.QuadPart > 0 && QueryPerformanceCounter(&now))
+		return (UINT64)(now.QuadPart / frequency.QuadPart) * 1000000
+			+ (UINT64)(now.QuadPart % frequency.QuadPart) * 1000000 / frequency.QuadPart;
+#elif defined (HAVE_GETTIMEOFDAY)
+	struct timeval now;
+#ifdef CLOCK_MONOTONIC
+	struct timespec ts;
+
+	// doesn't jump when the system clock is set, unlike gettimeofday
+	if (!clock_gettime(CLOCK_MONOTONIC, &ts))
+		return (UINT64)ts.tv_sec * 1000000 + (UINT64)ts.tv_nsec / 1000;
+#endif
+
+	if (!gettimeofday(&now, NULL))
+		return (UINT64)now.tv_sec * 1000000 + now.tv_usec;
+#endif
+	return (UINT64)SDL_GetTicks() * 1000;
+}
+
 void I_Sleep(void)
 {
 #if !(defined (_arch_dreamcast) || defined (_XBOX))
@@ -2247,7 +2247,7 @@ static void ST_overlayDrawer(void)
 
 		// scan the remaining thinkers
 		// to find toad
-		for (th = thinkercap.next; th != &thinkercap; th = th->next)
+		for (th = thlist[THINK_MOBJ].cnext; th != &thlist[THINK_MOBJ]; th = th->cnext)
 		{
 			if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 				continue;
@@ -20,6 +20,9 @@
 #ifdef __GNUC__
 #include <unistd.h>
 #endif
+#ifndef _WIN32_WCE
+#include <sys/stat.h>
+#endif
 
 #define ZWAD
 
@@ -32,6 +35,12 @@
 #include "lzf.h"
 #endif
 
+// Map whole wad files into memory instead of reading lumps through stdio
+#if defined (__linux__) && !defined (NOMMAP)
+#define MAPWADS
+#include <sys/mman.h>
+#endif
+
 #include "doomdef.h"
 #include "doomtype.h"
 #include "w_wad.h"
@@ -44,6 +53,9 @@
 #include "r_defs.h"
 #include "i_system.h"
 #include "md5.h"
+#include "m_argv.h"
+#include "i_threads.h"
+#include "d_main.h" // srb2home
 
 #ifdef HWRENDER
 #include "r_data.h"
@@ -80,6 +92,47 @@ typedef struct
 USHORT numwadfiles; // number of active wadfiles
 wadfile_t *wadfiles[MAX_WADFILES]; // 0 to numwadfiles-1 are valid
 
+/** Maps a wad file into memory, so lumps can be read without going through
+  * stdio and uncompressed lumps can be used in place. The file is left
+  * unmapped if this is not supported or -nommap was given.
+  *
+  * \param wadfile The wad, with its handle and filesize set.
+  */
+static void W_MapWadFile(wadfile_t *wadfile)
+{
+	wadfile->mapped = NULL;
+#ifdef MAPWADS
+	if (wadfile->filesize && !M_CheckParm("-nommap"))
+	{
+		void *addr = mmap(NULL, wadfile->filesize, PROT_READ, MAP_PRIVATE, fileno(wadfile->handle), 0);
+		if (addr != MAP_FAILED)
+			wadfile->mapped = addr;
+	}
+#endif
+}
+
+static void W_UnmapWadFile(wadfile_t *wadfile)
+{
+#ifdef MAPWADS
+	if (wadfile->mapped)
+		munmap((void *)(size_t)wadfile->mapped, wadfile->filesize);
+#endif
+	wadfile->mapped = NULL;
+}
+
+// Returns where a lump's bytes start in the mapping, or NULL if they
+// can't be taken from it.
+static const byte *W_MappedLump(USHORT wad, USHORT lump)
+{
+	const wadfile_t *wadfile = wadfiles[wad];
+	const lumpinfo_t *l = wadfile->lumpinfo + lump;
+
+	if (!wadfile->mapped || l->position > wadfile->filesize
+		|| l->disksize > wadfile->filesize - l->position)
+		return NULL;
+	return wadfile->mapped + l->position;
+}
+
 // W_Shutdown
 // Closes all of the WAD files before quitting
 // If not done on a Mac then open wad files
@@ -87,8 +140,12 @@ wadfile_t *wadfiles[MAX_WADFILES]; // 0 to numwadfiles-1 are valid
 // being ejected
 void W_Shutdown(void)
 {
+	W_FinishPrefetches();
 	while (numwadfiles--)
+	{
+		W_UnmapWadFile(wadfiles[numwadfiles]);
 		fclose(wadfiles[numwadfiles]->handle);
+	}
 }
 
 //===========================================================================
@@ -105,6 +162,134 @@ void W_Shutdown(void)
 
 static char filenamebuf[MAX_WADPATH];
 
+//===========================================================================
+//                                                         LUMP NAME HASHING
+//===========================================================================
+
+// Lump names are looked up by hash instead of scanning every directory.
+// Each wad keeps bucket chains in directory order, so searching from a
+// start lump finds the next lump with the same name, and one global table
+// remembers which wad overrides each name. The global table is rebuilt the
+// first time it is needed after a wad has been added or removed.
+
+typedef struct
+{
+	UINT64 key;
+	lumpnum_t lumpnum; // LUMPERROR if the slot is empty
+} lumphashentry_t;
+
+#define LUMPHASHEND 0xFFFF // ends a bucket chain, lump numbers never reach it
+
+static lumphashentry_t *globalhash = NULL;
+static size_t globalhashmask = 0;
+
+/** Packs an eight character lump name into one integer, so names can
+  * be compared in a single step.
+  *
+  * \param name Lump name, padded with zeros to eight bytes.
+  * \return The name as a 64-bit key.
+  */
+static UINT64 W_LumpNameKey(const char *name)
+{
+	UINT64 key;
+	memcpy(&key, name, sizeof key);
+	return key;
+}
+
+static size_t W_HashLumpKey(UINT64 key, size_t mask)
+{
+	key ^= key >> 29;
+	key *= (UINT64)0xBF58476D1CE4E5B9ULL;
+	key ^= key >> 32;
+	return (size_t)key & mask;
+}
+
+/** Builds the name buckets of a freshly loaded wad.
+  *
+  * \param wadfile The wad, with its lumpinfo filled in.
+  */
+static void W_HashWadLumps(wadfile_t *wadfile)
+{
+	size_t buckets = 1, i;
+	USHORT *bucket;
+
+	while (buckets < wadfile->numlumps)
+		buckets <<= 1;
+
+	wadfile->hashmask = (USHORT)(buckets - 1);
+	wadfile->lumphash = Z_Malloc(buckets * sizeof (*wadfile->lumphash), PU_STATIC, NULL);
+	wadfile->lumpnext = Z_Malloc((wadfile->numlumps + 1) * sizeof (*wadfile->lumpnext), PU_STATIC, NULL);
+	memset(wadfile->lumphash, 0xff, buckets * sizeof (*wadfile->lumphash));
+
+	// insert from the end so each chain comes out in directory order
+	for (i = wadfile->numlumps; i-- > 0;)
+	{
+		bucket = &wadfile->lumphash[W_HashLumpKey(W_LumpNameKey(wadfile->lumpinfo[i].name), wadfile->hashmask)];
+		wadfile->lumpnext[i] = *bucket;
+		*bucket = (USHORT)i;
+	}
+}
+
+// Called whenever the set of loaded wads changes
+static void W_InvalidateLumpHash(void)
+{
+	if (globalhash)
+		Z_Free(globalhash);
+	globalhash = NULL;
+	globalhashmask = 0;
+}
+
+static void W_BuildGlobalLumpHash(void)
+{
+	size_t total = 0, slots = 1, i, slot;
+	int wad;
+	UINT64 key;
+
+	for (wad = 0; wad < numwadfiles; wad++)
+		if (wadfiles[wad])
+			total += wadfiles[wad]->numlumps;
+
+	// keep the table at most half full
+	while (slots < total * 2)
+		slots <<= 1;
+
+	globalhashmask = slots - 1;
+	globalhash = Z_Malloc(slots * sizeof (*globalhash), PU_STATIC, NULL);
+	for (slot = 0; slot < slots; slot++)
+		globalhash[slot].lumpnum = LUMPERROR;
+
+	// the last wad wins, and inside a wad the first lump with the name
+	for (wad = numwadfiles - 1; wad >= 0; wad--)
+	{
+		if (!wadfiles[wad])
+			continue;
+		for (i = 0; i < wadfiles[wad]->numlumps; i++)
+		{
+			key = W_LumpNameKey(wadfiles[wad]->lumpinfo[i].name);
+			for (slot = W_HashLumpKey(key, globalhashmask);
+				globalhash[slot].lumpnum != LUMPERROR && globalhash[slot].key != key;
+				slot = (slot + 1) & globalhashmask);
+			if (globalhash[slot].lumpnum == LUMPERROR)
+			{
+				globalhash[slot].key = key;
+				globalhash[slot].lumpnum = (wad<<16) + (lumpnum_t)i;
+			}
+		}
+	}
+}
+
+// Uppercases and pads a name the way lump names are stored
+static UINT64 W_MakeLumpKey(const char *name)
+{
+	char uname[8];
+	size_t i;
+
+	memset(uname, 0x00, sizeof uname);
+	for (i = 0; i < sizeof uname && name[i]; i++)
+		uname[i] = (char)toupper((int)name[i]);
+	return W_LumpNameKey(uname);
+}
+
 // search for all DEHACKED lump in all wads and load it
 static inline void W_LoadDehackedLumps(USHORT wadnum)
 {
@@ -131,6 +316,254 @@ static inline void W_LoadDehackedLumps(USHORT wadnum)
 	}
 }
 
+//===========================================================================
+//                                                          MD5 DIGEST CACHE
+//===========================================================================
+
+// Hashing every wad on every launch takes seconds for large addon sets, so
+// digests are remembered in srb2home, keyed by path, size and modification
+// time. Files missing from the cache are hashed on the worker threads.
+
+#if !defined (NOMD5) && !defined (_WIN32_WCE)
+#define MD5CACHE
+#define MD5CACHEFILE "md5cache.txt"
+
+#define MD5CACHESTR2(x) #x
+#define MD5CACHESTR(x) MD5CACHESTR2(x)
+
+#ifndef S_ISREG
+#define S_ISREG(m) (((m) & S_IFMT) == S_IFREG)
+#endif
+
+typedef struct
+{
+	char *path;
+	ULONG size;
+	time_t mtime;
+	unsigned char md5[16];
+} md5cacheentry_t;
+
+static md5cacheentry_t *md5cache = NULL;
+static size_t nummd5cache = 0, maxmd5cache = 0;
+static boolean md5cacheloaded = false;
+static boolean md5cachedirty = false; // new digests that aren't saved yet
+
+static void PrintMD5String(const unsigned char *md5, char *buf);
+
+static md5cacheentry_t *W_FindMD5Cache(const char *path)
+{
+	size_t i;
+
+	for (i = 0; i < nummd5cache; i++)
+		if (!strcmp(md5cache[i].path, path))
+			return &md5cache[i];
+	return NULL;
+}
+
+static void W_StoreMD5Cache(const char *path, ULONG size, time_t mtime, const unsigned char *md5)
+{
+	md5cacheentry_t *entry = W_FindMD5Cache(path);
+
+	if (!entry)
+	{
+		if (nummd5cache == maxmd5cache)
+		{
+			maxmd5cache = maxmd5cache ? maxmd5cache*2 : 16;
+			md5cache = realloc(md5cache, maxmd5cache * sizeof (*md5cache));
+			if (!md5cache)
+				I_Error("W_StoreMD5Cache: out of memory");
+		}
+		entry = &md5cache[nummd5cache++];
+		entry->path = strdup(path);
+	}
+	entry->size = size;
+	entry->mtime = mtime;
+	memcpy(entry->md5, md5, 16);
+	md5cachedirty = true;
+}
+
+static void W_SaveMD5Cache(void);
+
+static void W_LoadMD5Cache(void)
+{
+	FILE *f;
+	char line[MAX_WADPATH + 80], hex[33], path[MAX_WADPATH + 1];
+	unsigned char md5[16];
+	unsigned long size;
+	long mtime;
+	unsigned int val;
+	size_t i;
+
+	md5cacheloaded = true;
+	I_AddExitFunc(W_SaveMD5Cache); // for files added later on
+	f = fopen(va("%s"PATHSEP"%s", srb2home, MD5CACHEFILE), "r");
+	if (!f)
+		return;
+
+	// <md5> <size> <mtime> <path>
+	while (fgets(line, sizeof line, f))
+	{
+		// one character more than W_CachedFileMD5 allows, to catch long paths
+		if (sscanf(line, "%32s %lu %ld %" MD5CACHESTR(MAX_WADPATH) "[^\n]", hex, &size, &mtime, path) != 4
+			|| strlen(hex) != 32 || strlen(path) >= MAX_WADPATH)
+			continue;
+		for (i = 0; i < 16; i++)
+		{
+			if (sscanf(&hex[i*2], "%2x", &val) != 1)
+				break;
+			md5[i] = (unsigned char)val;
+		}
+		if (i == 16)
+			W_StoreMD5Cache(path, (ULONG)size, (time_t)mtime, md5);
+	}
+	fclose(f);
+	md5cachedirty = false;
+}
+
+// Writes the cache back only if something new was hashed
+static void W_SaveMD5Cache(void)
+{
+	FILE *f;
+	char hex[33];
+	size_t i;
+
+	if (!md5cachedirty)
+		return;
+	md5cachedirty = false;
+
+	f = fopen(va("%s"PATHSEP"%s", srb2home, MD5CACHEFILE), "w");
+	if (!f)
+		return;
+
+	for (i = 0; i < nummd5cache; i++)
+	{
+		PrintMD5String(md5cache[i].md5, hex);
+		fprintf(f, "%s %lu %ld %s\n", hex, (unsigned long)md5cache[i].size, (long)md5cache[i].mtime, md5cache[i].path);
+	}
+	fclose(f);
+}
+
+/** Looks up a file's digest in the cache.
+  *
+  * \param filename Path of the file.
+  * \param st       Filled in with the file's status, or zeroed if the
+  *                 file can't be cached.
+  * \param resblock Where to put the digest if it's cached.
+  * \return true if the cached digest is still good.
+  */
+static boolean W_CachedFileMD5(const char *filename, struct stat *st, void *resblock)
+{
+	md5cacheentry_t *entry;
+
+	if (!md5cacheloaded)
+		W_LoadMD5Cache();
+
+	if (strlen(filename) >= MAX_WADPATH || strchr(filename, '\n') || stat(filename, st) < 0)
+	{
+		memset(st, 0, sizeof (*st)); // not S_ISREG, so never stored
+		return false;
+	}
+
+	entry = W_FindMD5Cache(filename);
+	if (!entry || entry->size != (ULONG)st->st_size || entry->mtime != st->st_mtime)
+		return false;
+
+	memcpy(resblock, entry->md5, 16);
+	return true;
+}
+
+/** Finds a file the way W_LoadWadFile does: as it is given, or else
+  * by its name alone in the search path.
+  *
+  * \param path Name of the file, replaced by the path it was found at.
+  *             Must hold MAX_WADPATH characters.
+  * \return true if the file was found.
+  */
+static boolean W_FindWadFile(char *path)
+{
+	FILE *handle = fopen(path, "rb");
+
+	if (handle)
+	{
+		fclose(handle);
+		return true;
+	}
+
+	nameonly(path);
+	return findfile(path, NULL, true) ? true : false;
+}
+
+typedef struct
+{
+	job_t job;
+	char filename[MAX_WADPATH]; // where W_LoadWadFile will find it
+	struct stat st;
+	unsigned char md5[16];
+	boolean ok;
+} md5job_t;
+
+// Runs on a worker thread
+static void W_MD5Job(void *data)
+{
+	md5job_t *mj = data;
+	FILE *fhandle = fopen(mj->filename, "rb");
+
+	mj->ok = false;
+	if (fhandle)
+	{
+		mj->ok = (md5_stream(fhandle, mj->md5) == 0);
+		fclose(fhandle);
+	}
+}
+#endif
+
+/** Hashes a list of files at once, on the worker threads, so that loading
+  * them afterwards finds their digests in the cache.
+  *
+  * \param filenames A null-terminated list of files.
+  */
+void W_MakeFileMD5s(char **filenames)
+{
+#ifdef MD5CACHE
+	md5job_t *jobs;
+	size_t i, numfiles, numjobs = 0;
+	unsigned char md5[16];
+
+	for (numfiles = 0; filenames[numfiles]; numfiles++)
+		;
+	jobs = calloc(numfiles, sizeof (*jobs));
+	if (!jobs)
+		return;
+
+	for (i = 0; i < numfiles; i++)
+	{
+		strncpy(jobs[numjobs].filename, filenames[i], MAX_WADPATH);
+		jobs[numjobs].filename[MAX_WADPATH - 1] = '\0';
+		if (!W_FindWadFile(jobs[numjobs].filename)
+			|| W_CachedFileMD5(jobs[numjobs].filename, &jobs[numjobs].st, md5)
+			|| !S_ISREG(jobs[numjobs].st.st_mode)) // missing, or already known
+			continue;
+		jobs[numjobs].job.func = W_MD5Job;
+		jobs[numjobs].job.data = &jobs[numjobs];
+		numjobs++;
+	}
+
+	// queue them only once the array won't move anymore
+	for (i = 0; i < numjobs; i++)
+		I_QueueJob(&jobs[i].job);
+
+	for (i = 0; i < numjobs; i++)
+	{
+		I_WaitJob(&jobs[i].job);
+		if (jobs[i].ok)
+			W_StoreMD5Cache(jobs[i].filename, (ULONG)jobs[i].st.st_size, jobs[i].st.st_mtime, jobs[i].md5);
+	}
+	free(jobs);
+#else
+	(void)filenames;
+#endif
+}
+
 /** Compute MD5 message digest for bytes read from STREAM of this filname.
   *
   * The resulting message digest number will be written into the 16 bytes
@@ -140,13 +573,19 @@ static inline void W_LoadDehackedLumps(USHORT wadnum)
   * \param resblock resulting MD5 checksum
   * \return 0 if MD5 checksum was made, and is at resblock, 1 if error was found
   */
-static inline int W_MakeFileMD5(const char *filename, void *resblock)
+int W_MakeFileMD5(const char *filename, void *resblock)
 {
 #ifdef NOMD5
 	(void)filename;
 	memset(resblock, 0x00, 16);
 #else
 	FILE *fhandle;
+#ifdef MD5CACHE
+	struct stat st;
+
+	if (W_CachedFileMD5(filename, &st, resblock))
+		return 0;
+#endif
 
 	if ((fhandle = fopen(filename, "rb")) != NULL)
 	{
@@ -156,13 +595,20 @@ static inline int W_MakeFileMD5(const char *filename, void *resblock)
 #endif
 		CONS_Printf("Making MD5 for %s\n",filename);
 		if (md5_stream(fhandle, resblock) == 1)
+		{
+			fclose(fhandle);
 			return 1;
+		}
 #ifndef _arch_dreamcast
 		if (devparm)
 #endif
 		CONS_Printf("MD5 calc for %s took %f second\n",
 			filename, (float)(I_GetTime() - t)/TICRATE);
 		fclose(fhandle);
+#ifdef MD5CACHE
+		if (S_ISREG(st.st_mode))
+			W_StoreMD5Cache(filename, (ULONG)st.st_size, st.st_mtime, resblock);
+#endif
 		return 0;
 	}
 #endif
@@ -264,7 +710,7 @@ USHORT W_LoadWadFile(const char *filename)
 		lumpinfo = Z_Calloc(sizeof (*lumpinfo), PU_STATIC, NULL);
 		lumpinfo->position = 0;
 		fseek(handle, 0, SEEK_END);
-		lumpinfo->size = ftell(handle);
+		lumpinfo->size = lumpinfo->disksize = ftell(handle);
 		fseek(handle, 0, SEEK_SET);
 		strcpy(lumpinfo->name, "OBJCTCFG");
 	}
@@ -354,8 +800,11 @@ USHORT W_LoadWadFile(const char *filename)
 	wadfile->handle = handle;
 	wadfile->numlumps = (USHORT)numlumps;
 	wadfile->lumpinfo = lumpinfo;
+	wadfile->prefetch = NULL;
+	W_HashWadLumps(wadfile);
 	fseek(handle, 0, SEEK_END);
 	wadfile->filesize = ftell(handle);
+	W_MapWadFile(wadfile);
 
 	//
 	// generate md5sum
@@ -388,6 +837,7 @@ USHORT W_LoadWadFile(const char *filename)
 	W_LoadDehackedLumps(numwadfiles);
 
 	numwadfiles++;
+	W_InvalidateLumpHash();
 	return wadfile->numlumps;
 }
 
@@ -402,21 +852,24 @@ void W_UnloadWadFile(USHORT num)
 		CONS_Printf("Removing WAD %s...\n", wadfiles[num]->filename);
 
 	DEH_UnloadDehackedWad(num);
+	W_FinishPrefetches();
 	wadfiles[num] = NULL;
 	lumpcache = delwad->lumpcache;
 	numwadfiles--;
+	W_InvalidateLumpHash();
 #ifdef HWRENDER
 	if (rendermode == render_opengl)
 		HWR_FreeTextureCache();
 	Z_Free(delwad->hwrcache);
 #endif
-	if (*lumpcache)
-	{
-		for (i = 0;i < delwad->numlumps;i++)
-			Z_ChangeTag(lumpcache[i], PU_PURGELEVEL);
-	}
+	// the lumps' user pointers are in lumpcache, so they have to go first
+	for (i = 0; i < delwad->numlumps; i++)
+		Z_Free(lumpcache[i]);
 	Z_Free(lumpcache);
+	W_UnmapWadFile(delwad);
 	fclose(delwad->handle);
+	Z_Free(delwad->lumphash);
+	Z_Free(delwad->lumpnext);
 	Z_Free(delwad->filename);
 	Z_Free(delwad);
 	CONS_Printf("WAD file Removed\n");
@@ -440,6 +893,9 @@ int W_InitMultipleFiles(char **filenames)
 	// open all the files, load headers, and count lumps
 	numwadfiles = 0;
 
+	// hash whatever isn't in the digest cache all at once
+	W_MakeFileMD5s(filenames);
+
 	// will be realloced as lumps are added
 	for (; *filenames; filenames++)
 	{
@@ -450,6 +906,10 @@ int W_InitMultipleFiles(char **filenames)
 	if (!numwadfiles)
 		I_Error("W_InitMultipleFiles: no files found");
 
+#ifdef MD5CACHE
+	W_SaveMD5Cache(); // once for all the startup files
+#endif
+
 	return rc;
 }
 
@@ -496,29 +956,26 @@ const char *W_CheckNameForNum(lumpnum_t lumpnum)
 USHORT W_CheckNumForNamePwad(const char *name, USHORT wad, USHORT startlump)
 {
 	USHORT i;
-	static char uname[9];
-
-	memset(uname, 0x00, sizeof uname);
-	strncpy(uname, name, 8);
-	uname[8] = 0;
-	strupr(uname);
+	UINT64 key;
+	wadfile_t *wadfile;
 
 	if (!TestValidLump(wad,0))
 		return MAXSHORT;
 
+	if (startlump >= wadfiles[wad]->numlumps)
+		return MAXSHORT;
+
 	//
-	// scan forward
+	// walk the name's bucket
 	// start at 'startlump', useful parameter when there are multiple
 	//                       resources with the same name
 	//
-	if (startlump < wadfiles[wad]->numlumps)
+	wadfile = wadfiles[wad];
+	key = W_MakeLumpKey(name);
+	for (i = wadfile->lumphash[W_HashLumpKey(key, wadfile->hashmask)]; i != LUMPHASHEND; i = wadfile->lumpnext[i])
 	{
-		lumpinfo_t *lump_p = wadfiles[wad]->lumpinfo + startlump;
-		for (i = startlump; i < wadfiles[wad]->numlumps; i++, lump_p++)
-		{
-			if (memcmp(lump_p->name,uname,8) == 0)
-				return i;
-		}
+		if (i >= startlump && W_LumpNameKey(wadfile->lumpinfo[i].name) == key)
+			return i;
 	}
 
 	// not found.
@@ -531,18 +988,20 @@ USHORT W_CheckNumForNamePwad(const char *name, USHORT wad, USHORT startlump)
 //
 lumpnum_t W_CheckNumForName(const char *name)
 {
-	int i;
-	lumpnum_t check = MAXSHORT;
+	UINT64 key;
+	size_t slot;
+
+	if (!globalhash)
+		W_BuildGlobalLumpHash();
 
-	// scan wad files backwards so patch lump files take precedence
-	for (i = numwadfiles - 1; i >= 0; i--)
+	// later wad files take precedence, see W_BuildGlobalLumpHash
+	key = W_MakeLumpKey(name);
+	for (slot = W_HashLumpKey(key, globalhashmask); globalhash[slot].lumpnum != LUMPERROR; slot = (slot + 1) & globalhashmask)
 	{
-		check = W_CheckNumForNamePwad(name,(USHORT)i,0);
-		if (check != MAXSHORT)
-			break; // found it
+		if (globalhash[slot].key == key)
+			return globalhash[slot].lumpnum;
 	}
-	if (check == MAXSHORT) return LUMPERROR;
-	else return (i<<16)+check;
+	return LUMPERROR;
 }
 
 //
@@ -621,9 +1080,20 @@ static size_t W_RawReadLumpHeader(USHORT wad, USHORT lump, void *dest, size_t si
 	size_t bytesread;
 	lumpinfo_t *l;
 	FILE *handle;
+	const byte *mapped = W_MappedLump(wad, lump);
 
 	l = wadfiles[wad]->lumpinfo + lump;
 
+	if (mapped)
+	{
+		if (offset >= l->disksize)
+			return 0;
+		if (size > l->disksize - offset)
+			size = l->disksize - offset;
+		memcpy(dest, mapped + offset, size);
+		return size;
+	}
+
 	handle = wadfiles[wad]->handle;
 
 	fseek(handle, l->position + offset, SEEK_SET);
@@ -639,18 +1109,25 @@ static void *W_ReadCompressedLump(USHORT wad, USHORT lump)
 #ifdef ZWAD
 	char *compressed, *data;
 	const lumpinfo_t *l = &wadfiles[wad]->lumpinfo[lump];
+	const byte *mapped = W_MappedLump(wad, lump);
 	unsigned int retval;
 
-	compressed = Z_Malloc(l->disksize, PU_STATIC, NULL);
 	data = Z_Malloc(l->size, PU_STATIC, NULL);
-	if (W_RawReadLumpHeader(wad, lump, compressed, l->disksize, 0)
-		< l->disksize)
+	if (mapped) // decompress straight out of the mapping
+		compressed = NULL;
+	else
 	{
-		I_Error("wad %d, lump %d: cannot read compressed data",
-			wad, lump);
+		compressed = Z_Malloc(l->disksize, PU_STATIC, NULL);
+		if (W_RawReadLumpHeader(wad, lump, compressed, l->disksize, 0)
+			< l->disksize)
+		{
+			I_Error("wad %d, lump %d: cannot read compressed data",
+				wad, lump);
+		}
+		mapped = (byte *)compressed;
 	}
 
-	retval = lzf_decompress(compressed, l->disksize, data, l->size);
+	retval = lzf_decompress(mapped, l->disksize, data, l->size);
 #ifndef AVOID_ERRNO
 	if (retval == 0 && errno == E2BIG)
 	{
@@ -667,7 +1144,8 @@ static void *W_ReadCompressedLump(USHORT wad, USHORT lump)
 			"bytes (expected %u, got %u)", wad, lump,
 			(int)l->size, retval);
 	}
-	Z_Free(compressed);
+	if (compressed)
+		Z_Free(compressed);
 	return data;
 #else
 	(void)wad;
@@ -738,6 +1216,194 @@ void W_ReadLumpPwad(USHORT wad, USHORT lump, void *dest)
 	W_ReadLumpHeaderPwad(wad, lump, dest, 0, 0);
 }
 
+// ==========================================================================
+// W_PrefetchLumps
+// ==========================================================================
+
+// A lump being read into its cache block by a worker thread. The block
+// is allocated up front and kept PU_STATIC until the main thread finishes
+// the prefetch, so nothing can purge it while it's being filled.
+typedef struct lumpprefetch_s
+{
+	job_t job;
+	USHORT wad, lump;
+	void *dest;
+	const char *error; // set by the job if the lump couldn't be read
+	boolean finished; // handed back to the cache
+	struct lumpprefetch_s *next;
+} lumpprefetch_t;
+
+static lumpprefetch_t *prefetches = NULL; // every prefetch since the last W_FinishPrefetches
+
+// Reads raw lump bytes without disturbing the stdio position the main
+// thread uses
+static boolean W_ReadLumpBytes(const wadfile_t *wadfile, ULONG position, void *dest, size_t size)
+{
+#ifdef HAVE_THREADS
+	int fd = fileno(wadfile->handle);
+	byte *p = dest;
+	ssize_t got;
+
+	while (size)
+	{
+		got = pread(fd, p, size, position);
+		if (got <= 0)
+			return false;
+		p += got;
+		position += (ULONG)got;
+		size -= (size_t)got;
+	}
+	return true;
+#else
+	// jobs run on the main thread here
+	return fseek(wadfile->handle, position, SEEK_SET) != -1
+		&& fread(dest, 1, size, wadfile->handle) == size;
+#endif
+}
+
+// Runs on a worker thread: no zone, no I_Error
+static void W_PrefetchJob(void *data)
+{
+	lumpprefetch_t *pf = data;
+	const wadfile_t *wadfile = wadfiles[pf->wad];
+	const lumpinfo_t *l = wadfile->lumpinfo + pf->lump;
+	const byte *mapped = W_MappedLump(pf->wad, pf->lump);
+
+	if (!l->compressed)
+	{
+		if (mapped)
+			memcpy(pf->dest, mapped, l->size);
+		else if (!W_ReadLumpBytes(wadfile, l->position, pf->dest, l->size))
+			pf->error = "cannot read lump";
+		return;
+	}
+
+#ifdef ZWAD
+	{
+		byte *compressed = NULL;
+
+		if (!mapped)
+		{
+			mapped = compressed = malloc(l->disksize);
+			if (!compressed)
+			{
+				pf->error = "out of memory reading compressed data";
+				return;
+			}
+			if (!W_ReadLumpBytes(wadfile, l->position, compressed, l->disksize))
+			{
+				pf->error = "cannot read compressed data";
+				free(compressed);
+				return;
+			}
+		}
+
+		if (lzf_decompress(mapped, l->disksize, pf->dest, l->size) != l->size)
+			pf->error = "invalid compressed data";
+		free(compressed);
+	}
+#else
+	pf->error = "ZWAD files not supported on this platform";
+#endif
+}
+
+// Waits for one lump and hands it to the cache
+static void W_FinishPrefetch(lumpprefetch_t *pf)
+{
+	if (pf->finished)
+		return;
+
+	I_WaitJob(&pf->job);
+	pf->finished = true;
+	wadfiles[pf->wad]->prefetch[pf->lump] = NULL;
+
+	if (pf->error)
+		I_Error("wad %d, lump %d: %s", pf->wad, pf->lump, pf->error);
+
+	// the lump is in the cache now, but nobody asked for it yet
+	Z_ChangeTag(pf->dest, PU_CACHE);
+}
+
+/** Starts loading lumps in the background, so the cache already has them
+  * when they're asked for. Lumps that are cached already are skipped, and
+  * uncompressed lumps of memory mapped wads are only read ahead by the
+  * system, since they're copied straight out of the mapping anyway.
+  *
+  * \param lumps Lumps to load, LUMPERROR entries are ignored.
+  * \param count Number of entries in lumps.
+  */
+void W_PrefetchLumps(const lumpnum_t *lumps, size_t count)
+{
+	size_t i;
+	USHORT wad, lump;
+	wadfile_t *wadfile;
+	const lumpinfo_t *l;
+	lumpprefetch_t *pf;
+
+	for (i = 0; i < count; i++)
+	{
+		if (lumps[i] == LUMPERROR)
+			continue;
+
+		wad = WADFILENUM(lumps[i]);
+		lump = LUMPNUM(lumps[i]);
+		if (wad >= numwadfiles || !wadfiles[wad] || lump >= wadfiles[wad]->numlumps)
+			continue;
+
+		wadfile = wadfiles[wad];
+		l = wadfile->lumpinfo + lump;
+		if (!l->size || wadfile->lumpcache[lump]
+			|| (wadfile->prefetch && wadfile->prefetch[lump]))
+			continue;
+
+		if (W_MappedLump(wad, lump) && !l->compressed)
+		{
+#ifdef MAPWADS
+			// let the kernel page it in while we do other things
+			size_t pagemask = (size_t)sysconf(_SC_PAGESIZE) - 1;
+			size_t start = l->position & ~pagemask;
+			madvise((void *)(size_t)(wadfile->mapped + start), l->position + l->disksize - start, MADV_WILLNEED);
+#endif
+			continue;
+		}
+
+		if (!wadfile->prefetch)
+			wadfile->prefetch = Z_Calloc(wadfile->numlumps * sizeof (*wadfile->prefetch), PU_STATIC, NULL);
+
+		pf = malloc(sizeof (*pf));
+		if (!pf)
+			break; // the lumps will just be loaded when they're used
+		pf->wad = wad;
+		pf->lump = lump;
+		pf->error = NULL;
+		pf->finished = false;
+		pf->dest = Z_Malloc(l->size, PU_STATIC, &wadfile->lumpcache[lump]);
+		pf->job.func = W_PrefetchJob;
+		pf->job.data = pf;
+		pf->next = prefetches;
+		prefetches = pf;
+		wadfile->prefetch[lump] = pf;
+
+		I_QueueJob(&pf->job);
+	}
+}
+
+/** Waits for every lump given to W_PrefetchLumps. The ones that haven't
+  * been used yet stay in the cache as PU_CACHE.
+  */
+void W_FinishPrefetches(void)
+{
+	lumpprefetch_t *pf, *next;
+
+	for (pf = prefetches; pf; pf = next)
+	{
+		next = pf->next;
+		W_FinishPrefetch(pf);
+		free(pf);
+	}
+	prefetches = NULL;
+}
+
 // ==========================================================================
 // W_CacheLumpNum
 // ==========================================================================
@@ -748,6 +1414,9 @@ void *W_CacheLumpNumPwad(USHORT wad, USHORT lump, int tag)
 	if (!TestValidLump(wad,lump))
 		return NULL;
 
+	if (wadfiles[wad]->prefetch && wadfiles[wad]->prefetch[lump])
+		W_FinishPrefetch(wadfiles[wad]->prefetch[lump]);
+
 	lumpcache = wadfiles[wad]->lumpcache;
 	if (!lumpcache[lump])
 	{
@@ -755,11 +1424,53 @@ void *W_CacheLumpNumPwad(USHORT wad, USHORT lump, int tag)
 		W_ReadLumpHeaderPwad(wad, lump, ptr, 0, 0);  // read the lump in full
 	}
 	else
+	{
 		Z_ChangeTag(lumpcache[lump], tag);
+		Z_Touch(lumpcache[lump]);
+	}
 
 	return lumpcache[lump];
 }
 
+// ==========================================================================
+// W_MapLumpNum
+// ==========================================================================
+const void *W_MapLumpNumPwad(USHORT wad, USHORT lump)
+{
+	const byte *mapped;
+
+	if (!TestValidLump(wad,lump))
+		return NULL;
+
+	mapped = W_MappedLump(wad, lump);
+	if (mapped && !wadfiles[wad]->lumpinfo[lump].compressed)
+		return mapped;
+
+	return W_CacheLumpNumPwad(wad, lump, PU_STATIC);
+}
+
+const void *W_MapLumpNum(lumpnum_t lumpnum)
+{
+	return W_MapLumpNumPwad(WADFILENUM(lumpnum),LUMPNUM(lumpnum));
+}
+
+void W_UnmapLumpNum(lumpnum_t lumpnum)
+{
+	USHORT wad = WADFILENUM(lumpnum), lump = LUMPNUM(lumpnum);
+	lumpcache_t *lumpcache;
+
+	if (!TestValidLump(wad,lump))
+		return;
+
+	if (W_MappedLump(wad, lump) && !wadfiles[wad]->lumpinfo[lump].compressed)
+		return;
+
+	// a copy was made; free it now rather than leave it to a cache
+	// purge that may never come (cachelimit 0)
+	lumpcache = wadfiles[wad]->lumpcache;
+	Z_Free(lumpcache[lump]);
+}
+
 void *W_CacheLumpNum(lumpnum_t lumpnum, int tag)
 {
 
@@ -857,6 +1568,7 @@ static inline void *W_CachePatchNumPwad(USHORT wad, USHORT lump, int tag)
 		if (tag == PU_CACHE)
 			tag = PU_HWRCACHE;
 		Z_ChangeTag(grPatch->mipmap.glInfo.data, tag);
+		Z_Touch(grPatch->mipmap.glInfo.data);
 	}
 	else
 	{
@@ -69,7 +69,12 @@ typedef struct wadfile_s
 	GLPatch_t *hwrcache; // patches are cached in renderer's native format
 #endif
 	USHORT numlumps; // this wad's number of resources
+	USHORT *lumphash; // first lump of each name bucket, 0xFFFF if empty
+	USHORT *lumpnext; // next lump in the same bucket, in directory order
+	USHORT hashmask; // number of buckets - 1
 	FILE *handle;
+	const byte *mapped; // the whole file when it is memory mapped, else NULL
+	struct lumpprefetch_s **prefetch; // lumps still being read in the background
 	ULONG filesize; // for network
 	unsigned char md5sum[16];
 } wadfile_t;
@@ -92,6 +97,10 @@ void W_UnloadWadFile(USHORT num);
 // so that it stops with a message if a file was not found, but not if all is okay.
 int W_InitMultipleFiles(char **filenames);
 
+// MD5 of a whole file, remembered across runs while the file doesn't change
+int W_MakeFileMD5(const char *filename, void *resblock);
+void W_MakeFileMD5s(char **filenames);
+
 const char *W_CheckNameForNumPwad(USHORT wad, USHORT lump);
 const char *W_CheckNameForNum(lumpnum_t lumpnum);
 
@@ -115,6 +124,20 @@ size_t W_ReadLumpHeader(lumpnum_t lump, void *dest, size_t size, size_t offest);
 void W_ReadLumpPwad(USHORT wad, USHORT lump, void *dest);
 void W_ReadLump(lumpnum_t lump, void *dest);
 
+// Read-only access to a lump without copying it, when its wad is memory mapped.
+// Compressed lumps and unmapped wads fall back to the lump cache.
+// Every W_MapLumpNum must be matched by a W_UnmapLumpNum, which frees the
+// cached copy, so nothing else may hold on to that lump meanwhile.
+const void *W_MapLumpNumPwad(USHORT wad, USHORT lump);
+const void *W_MapLumpNum(lumpnum_t lumpnum);
+void W_UnmapLumpNum(lumpnum_t lumpnum);
+
+// Starts reading lumps into the cache on the worker threads. Caching one
+// of them waits only for that lump; W_FinishPrefetches waits for them all
+// and leaves them purgable.
+void W_PrefetchLumps(const lumpnum_t *lumps, size_t count);
+void W_FinishPrefetches(void);
+
 void *W_CacheLumpNumPwad(USHORT wad, USHORT lump, int tag);
 void *W_CacheLumpNum(lumpnum_t lump, int tag);
 void *W_CacheLumpNumForce(lumpnum_t lumpnum, int tag);
@@ -262,6 +262,25 @@ tic_t I_GetTime(void)
 	return newtics;
 }
 
+//
+// I_GetTimeMicros
+// The high resolution timer when there is one, otherwise the tick count
+//
+UINT64 I_GetTimeMicros(void)
+{
+	static LARGE_INTEGER frequency = {{0, 0}};
+	LARGE_INTEGER now;
+
+	if (!frequency.QuadPart && !QueryPerformanceFrequency(&frequency))
+		frequency.QuadPart = -1;
+
+	if (frequency.QuadPart > 0 && QueryPerformanceCounter(&now))
+		return (UINT64)(now.QuadPart / frequency.QuadPart) * 1000000
+			+ (UINT64)(now.QuadPart % frequency.QuadPart) * 1000000 / frequency.QuadPart;
+
+	return (UINT64)GetTickCount() * 1000;
+}
+
 
 void I_Sleep(void)
 {
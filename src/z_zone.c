@@ -20,6 +20,18 @@
 // allocator was fragmenting badly. Finally, this version is a bit
 // simpler (about half the lines of code).
 //
+// Every block keeps its bookkeeping (memblock_t) in the same allocation
+// as its data, and blocks are kept in one list per tag, so freeing a tag
+// never has to look at blocks of other tags.
+//
+// Small blocks with a per-level tag (PU_LEVEL, PU_LEVSPEC) don't come
+// from malloc() at all: they are carved out of large chunks owned by
+// that tag's arena, and freed blocks go on a free list per size class
+// for reuse during the level. Z_FreeTags() then gives back the whole
+// arena chunk by chunk, only visiting the blocks that have a user to
+// clear. A block changed to another tag while in an arena "escapes" it:
+// its chunk is kept around until that block is freed too.
+//
 //-----------------------------------------------------------------------------
 /// \file
 /// \brief Zone memory allocation.
@@ -30,6 +42,9 @@
 #include "i_video.h" // rendermode
 #include "z_zone.h"
 #include "m_misc.h" // M_Memcpy
+#include "m_argv.h"
+#include "command.h"
+#include "d_main.h" // srb2home
 
 #ifdef HWRENDER
 #include "hardware/hw_main.h" // For hardware memory info
@@ -37,7 +52,30 @@
 
 #define ZONEID 0xa441d13d
 
+// Tags are used as indexes into the per-tag block lists,
+// so every tag must be below this
+#define ZONETAGS 128
+
+// Arena tuning: blocks are rounded up to ARENAGRAIN bytes (header included),
+// anything bigger than ARENAMAXBLOCK goes straight to malloc()
+#define ARENAGRAIN 16
+#define ARENAMAXBLOCK 2048
+#define ARENACLASSES (ARENAMAXBLOCK/ARENAGRAIN)
+#define ARENACHUNKSIZE (256*1024)
+
+// Block flags
+#define ZB_LINKED 1 // In its tag's block list
+#define ZB_POOLED 2 // Belongs to a mempool_t
+
+// Pools get chunks of at least this many bytes, or POOLMINOBJECTS objects
+#define POOLCHUNKSIZE (64*1024)
+#define POOLMINOBJECTS 16
+#define MAXPOOLS 16
+
 struct memblock_s;
+struct memarena_s;
+struct mempool_s;
+struct zsite_s;
 
 typedef struct
 {
@@ -45,31 +83,72 @@ typedef struct
 	ULONG id; // Should be ZONEID
 } ATTRPACK memhdr_t;
 
+// A chunk of arena memory; blocks are bump allocated after the header.
+// Once its arena is released, a chunk that still holds escaped blocks
+// is orphaned (arena == NULL) and freed along with the last of them.
+typedef struct memchunk_s
+{
+	struct memchunk_s *next;
+	struct memarena_s *arena;
+	size_t used; // bytes handed out so far, header included
+	int escaped; // blocks in this chunk that changed tag
+} memchunk_t;
+
+typedef struct memarena_s
+{
+	int tag;
+	memchunk_t *chunks; // newest first, only the first one is bumped
+	struct memblock_s *freelists[ARENACLASSES];
+	size_t numchunks;
+} memarena_t;
+
+struct mempool_s
+{
+	const char *name;
+	int tag;
+	size_t blocksize; // header included
+	size_t chunksize;
+
+	memchunk_t *chunks; // only used for their link, the rest is bumped
+	byte *bump, *bumpend;
+	struct memblock_s *freelist;
+
+	// Statistics
+	size_t live, peak, numchunks;
+	ULONG allocs;
+};
+
+// The block header sits at the start of the allocation it describes.
 // Some code might want aligned memory. Assume it wants memory n bytes
 // aligned -- then we allocate n-1 extra bytes and return a pointer to
-// the first byte aligned as requested.
-// Thus, "real" is the pointer we get from malloc() and will free()
-// later, but "hdr" is where the memhdr_t starts.
-// For non-aligned allocations they will be the same.
+// the first byte after the header that is aligned as requested.
+// The memhdr_t always sits right before that pointer.
 typedef struct memblock_s
 {
-	void *real;
-	memhdr_t *hdr;
-
 	void **user;
 	int tag; // purgelevel
+	int flags;
 
 	size_t size; // including the header and blocks
 	size_t realsize; // size of real data only
 
+	memchunk_t *chunk; // arena chunk this block was carved from, or NULL
+	struct mempool_s *pool; // pool this block belongs to, if ZB_POOLED
+	ULONG lastuse; // cacheclock when it was last linked or touched
+
 #ifdef ZDEBUG
 	const char *ownerfile;
 	int ownerline;
+	struct zsite_s *site; // profiling record, if allocated while profiling
 #endif
 
 	struct memblock_s *next, *prev;
 } ATTRPACK memblock_t;
 
+// Space taken in front of unaligned data. Keeps the data 8 byte aligned
+// as long as the block itself is.
+#define BLOCKHEADSIZE ((sizeof (memblock_t) + sizeof (memhdr_t) + 7) & ~(size_t)7)
+#define CHUNKHEADSIZE ((sizeof (memchunk_t) + ARENAGRAIN - 1) & ~(size_t)(ARENAGRAIN - 1))
 
 #ifdef ZDEBUG
 #define Ptr2Memblock(s, f) Ptr2Memblock2(s, f, __FILE__, __LINE__)
@@ -100,21 +179,731 @@ static memblock_t *Ptr2Memblock(void *ptr, const char* func)
 
 }
 
-static memblock_t head;
+static memblock_t tagheads[ZONETAGS]; // one circular list per tag
+static size_t tagusage[ZONETAGS]; // bytes allocated per tag
+
+static memarena_t levelarena, levspecarena;
+static memarena_t *tagarenas[ZONETAGS];
+
+static mempool_t pools[MAXPOOLS];
+static int numpools;
+
+// Purgable cache tier
+static ULONG cacheclock;
+static ULONG cachehits, cachemisses, cacheevictions;
+
+static memblock_t *reallocblock; // being copied by Z_Realloc, don't purge it
+static int cacheholds; // see Z_HoldCache
 
 static void Command_Memfree_f(void);
+#ifdef ZDEBUG
+static void Command_Zoneprofile_f(void);
+static boolean zprofiling = false;
+#endif
+static size_t Z_TagsUsage(int lowtag, int hightag);
+static void CacheLimit_OnChange(void);
+
+static consvar_t cv_cachelimit = {"cachelimit", "0", CV_CALL|CV_NOINIT, CV_Unsigned, CacheLimit_OnChange, 0, NULL, NULL, 0, 0, NULL};
 
 void Z_Init(void)
 {
 	ULONG total, memfree;
+	int i;
+
+	for (i = 0; i < ZONETAGS; i++)
+		tagheads[i].next = tagheads[i].prev = &tagheads[i];
 
-	head.next = head.prev = &head;
+	levelarena.tag = PU_LEVEL;
+	levspecarena.tag = PU_LEVSPEC;
+	tagarenas[PU_LEVEL] = &levelarena;
+	tagarenas[PU_LEVSPEC] = &levspecarena;
 
 	memfree = I_GetFreeMem(&total)>>20;
 	CONS_Printf("system memory %luMB free %luMB\n", total>>20, memfree);
 
 	// Note: This allocates memory. Watch out.
 	COM_AddCommand("memfree", Command_Memfree_f);
+
+#ifdef ZDEBUG
+	COM_AddCommand("zoneprofile", Command_Zoneprofile_f);
+	if (M_CheckParm("-zoneprofile"))
+		zprofiling = true;
+#endif
+
+	// Megabytes of purgable memory to keep at most, 0 for no limit
+	CV_RegisterVar(&cv_cachelimit);
+	if (M_CheckParm("-cachelimit") && M_IsNextParm())
+		CV_SetValue(&cv_cachelimit, atoi(M_GetNextParm()));
+}
+
+// malloc() that gives the game a memory error if it fails
+static void *zmalloc(size_t size)
+{
+	void *p;
+	p = malloc(size);
+	if (p == NULL)
+		I_Error("Out of memory allocating %lu bytes", (ULONG)size);
+	return p;
+}
+
+static void Z_LinkBlock(memblock_t *block)
+{
+	memblock_t *head = &tagheads[block->tag];
+
+	block->next = head->next;
+	block->prev = head;
+	block->next->prev = head->next = block;
+	block->flags |= ZB_LINKED;
+	block->lastuse = ++cacheclock;
+}
+
+static void Z_UnlinkBlock(memblock_t *block)
+{
+	block->prev->next = block->next;
+	block->next->prev = block->prev;
+	block->flags &= ~ZB_LINKED;
+}
+
+// A block in an arena has escaped it when its tag no longer matches the arena's
+static boolean Z_BlockEscaped(const memblock_t *block, int tag)
+{
+	return !block->chunk->arena || block->chunk->arena->tag != tag;
+}
+
+#ifdef ZDEBUG
+// ==========================================================================
+//                          ALLOCATION PROFILER
+// ==========================================================================
+
+#define MAXZSITES 4096 // power of two, it's a hash table
+#define MAXZLEVELS 32
+
+typedef struct zsite_s
+{
+	const char *file;
+	int line;
+	int tag; // tag of the latest allocation
+
+	size_t livebytes, peakbytes, totalbytes;
+	ULONG livecount, allocs, frees;
+} zsite_t;
+
+// Peak memory use while a level was being played
+typedef struct
+{
+	char name[16];
+	size_t startbytes; // in use right after it was loaded
+	size_t peakbytes;
+	size_t peaktag[ZONETAGS];
+	ULONG allocs;
+} zlevelmark_t;
+
+static zsite_t zsites[MAXZSITES];
+static int numzsites;
+static size_t ztagpeak[ZONETAGS];
+static zlevelmark_t zlevels[MAXZLEVELS];
+static int numzlevels; // total ever recorded, zlevels is a ring buffer
+
+static zsite_t *Z_FindSite(const char *file, int line)
+{
+	size_t i = (((size_t)file >> 3) ^ ((size_t)line * 31)) & (MAXZSITES - 1);
+
+	while (zsites[i].file)
+	{
+		if (zsites[i].file == file && zsites[i].line == line)
+			return &zsites[i];
+		i = (i + 1) & (MAXZSITES - 1);
+	}
+
+	// Keep a slot free so the search always ends
+	if (numzsites >= MAXZSITES - 1)
+		return NULL;
+
+	numzsites++;
+	zsites[i].file = file;
+	zsites[i].line = line;
+	return &zsites[i];
+}
+
+// End of the blocks handed out from a pool chunk
+static byte *Z_PoolChunkEnd(mempool_t *pool, memchunk_t *chunk)
+{
+	if (chunk == pool->chunks)
+		return pool->bump;
+	return (byte *)chunk + CHUNKHEADSIZE
+		+ ((pool->chunksize - CHUNKHEADSIZE)/pool->blocksize)*pool->blocksize;
+}
+
+static void Z_ProfileAlloc(memblock_t *block)
+{
+	zsite_t *site = Z_FindSite(block->ownerfile, block->ownerline);
+	size_t used;
+
+	block->site = site;
+	if (!site)
+		return;
+
+	site->tag = block->tag;
+	site->allocs++;
+	site->livecount++;
+	site->totalbytes += block->realsize;
+	site->livebytes += block->realsize;
+	if (site->livebytes > site->peakbytes)
+		site->peakbytes = site->livebytes;
+
+	if (tagusage[block->tag] > ztagpeak[block->tag])
+		ztagpeak[block->tag] = tagusage[block->tag];
+
+	if (numzlevels)
+	{
+		zlevelmark_t *level = &zlevels[(numzlevels - 1) % MAXZLEVELS];
+
+		level->allocs++;
+		if (tagusage[block->tag] > level->peaktag[block->tag])
+			level->peaktag[block->tag] = tagusage[block->tag];
+		used = Z_TagsUsage(0, ZONETAGS - 1);
+		if (used > level->peakbytes)
+			level->peakbytes = used;
+	}
+}
+
+static void Z_ProfileFree(memblock_t *block)
+{
+	zsite_t *site = block->site;
+
+	site->frees++;
+	site->livecount--;
+	site->livebytes -= block->realsize;
+	block->site = NULL;
+}
+
+// Blocks that go away with their whole arena chunk or pool
+// still have to leave the statistics one by one
+static void Z_ProfileDropChunk(memchunk_t *chunk, byte *end, memarena_t *arena)
+{
+	byte *p = (byte *)chunk + CHUNKHEADSIZE;
+
+	while (p < end)
+	{
+		memblock_t *block = (memblock_t *)p;
+
+		p += block->size;
+		if (block->site && (!arena || block->tag == arena->tag))
+			Z_ProfileFree(block);
+	}
+}
+
+/** Starts the statistics of a new level; called by P_SetupLevel
+  * once the previous level's memory is gone.
+  *
+  * \param name Name of the level.
+  */
+void Z_ProfileLevel(const char *name)
+{
+	zlevelmark_t *level;
+
+	if (!zprofiling)
+		return;
+
+	level = &zlevels[numzlevels++ % MAXZLEVELS];
+	memset(level, 0, sizeof (*level));
+	strlcpy(level->name, name, sizeof (level->name));
+	level->startbytes = level->peakbytes = Z_TagsUsage(0, ZONETAGS - 1);
+}
+
+static void Z_ProfileReset(void)
+{
+	int i;
+
+	// Blocks still pointing at the old records just stop being counted
+	for (i = 0; i < ZONETAGS; i++)
+	{
+		memblock_t *block;
+		for (block = tagheads[i].next; block != &tagheads[i]; block = block->next)
+			block->site = NULL;
+	}
+	for (i = 0; i < numpools; i++)
+	{
+		memchunk_t *chunk;
+		for (chunk = pools[i].chunks; chunk; chunk = chunk->next)
+			Z_ProfileDropChunk(chunk, Z_PoolChunkEnd(&pools[i], chunk), NULL);
+	}
+	{
+		memchunk_t *chunk;
+		for (chunk = levelarena.chunks; chunk; chunk = chunk->next)
+			Z_ProfileDropChunk(chunk, (byte *)chunk + chunk->used, NULL);
+		for (chunk = levspecarena.chunks; chunk; chunk = chunk->next)
+			Z_ProfileDropChunk(chunk, (byte *)chunk + chunk->used, NULL);
+	}
+
+	memset(zsites, 0, sizeof (zsites));
+	numzsites = 0;
+	memset(ztagpeak, 0, sizeof (ztagpeak));
+	numzlevels = 0;
+}
+
+static int zsortkey;
+
+static int Z_CompareSites(const void *a, const void *b)
+{
+	const zsite_t *sa = *(const zsite_t * const *)a;
+	const zsite_t *sb = *(const zsite_t * const *)b;
+	size_t ka, kb;
+
+	switch (zsortkey)
+	{
+		case 1: ka = sa->peakbytes; kb = sb->peakbytes; break;
+		case 2: ka = sa->allocs; kb = sb->allocs; break;
+		case 3: ka = sa->frees; kb = sb->frees; break;
+		default: ka = sa->livebytes; kb = sb->livebytes; break;
+	}
+
+	if (ka == kb)
+		return 0;
+	return ka < kb ? 1 : -1;
+}
+
+// Returns the sites in use, sorted by zsortkey, in a malloc'd array
+static zsite_t **Z_SortedSites(void)
+{
+	zsite_t **sorted = zmalloc((numzsites + 1) * sizeof (*sorted));
+	int i, n = 0;
+
+	for (i = 0; i < MAXZSITES; i++)
+		if (zsites[i].file)
+			sorted[n++] = &zsites[i];
+
+	qsort(sorted, n, sizeof (*sorted), Z_CompareSites);
+	return sorted;
+}
+
+static void Z_ProfileWriteCSV(const char *filename)
+{
+	FILE *f = fopen(filename, "w");
+	zsite_t **sorted;
+	int i;
+
+	if (!f)
+	{
+		CONS_Printf("Couldn't open %s for writing\n", filename);
+		return;
+	}
+
+	sorted = Z_SortedSites();
+	fprintf(f, "file,line,tag,livebytes,livecount,peakbytes,allocs,frees,totalbytes\n");
+	for (i = 0; i < numzsites; i++)
+		fprintf(f, "%s,%d,%d,%lu,%lu,%lu,%lu,%lu,%lu\n", sorted[i]->file, sorted[i]->line,
+			sorted[i]->tag, (ULONG)sorted[i]->livebytes, sorted[i]->livecount,
+			(ULONG)sorted[i]->peakbytes, sorted[i]->allocs, sorted[i]->frees,
+			(ULONG)sorted[i]->totalbytes);
+	free(sorted);
+
+	fprintf(f, "\ntag,peakbytes\n");
+	for (i = 0; i < ZONETAGS; i++)
+		if (ztagpeak[i])
+			fprintf(f, "%d,%lu\n", i, (ULONG)ztagpeak[i]);
+
+	fprintf(f, "\nlevel,startbytes,peakbytes,levelpeak,levspecpeak,allocs\n");
+	for (i = max(0, numzlevels - MAXZLEVELS); i < numzlevels; i++)
+	{
+		zlevelmark_t *level = &zlevels[i % MAXZLEVELS];
+		fprintf(f, "%s,%lu,%lu,%lu,%lu,%lu\n", level->name, (ULONG)level->startbytes,
+			(ULONG)level->peakbytes, (ULONG)level->peaktag[PU_LEVEL],
+			(ULONG)level->peaktag[PU_LEVSPEC], level->allocs);
+	}
+
+	fclose(f);
+	CONS_Printf("Wrote %d allocation sites to %s\n", numzsites, filename);
+}
+
+static void Command_Zoneprofile_f(void)
+{
+	const char *arg = COM_Argc() > 1 ? COM_Argv(1) : "";
+	zsite_t **sorted;
+	int i;
+
+	if (!stricmp(arg, "on"))
+	{
+		zprofiling = true;
+		CONS_Printf("Zone profiling on\n");
+		return;
+	}
+	else if (!stricmp(arg, "off"))
+	{
+		zprofiling = false;
+		CONS_Printf("Zone profiling off\n");
+		return;
+	}
+	else if (!stricmp(arg, "reset"))
+	{
+		Z_ProfileReset();
+		return;
+	}
+	else if (!stricmp(arg, "csv"))
+	{
+		if (COM_Argc() < 3)
+			CONS_Printf("zoneprofile csv <filename>\n");
+		else
+			Z_ProfileWriteCSV(va("%s"PATHSEP"%s", srb2home, COM_Argv(2)));
+		return;
+	}
+	else if (!stricmp(arg, "levels"))
+	{
+		CONS_Printf("\2Level           Start KB  Peak KB  Level KB  Spec KB   Allocs\n");
+		for (i = max(0, numzlevels - MAXZLEVELS); i < numzlevels; i++)
+		{
+			zlevelmark_t *level = &zlevels[i % MAXZLEVELS];
+			CONS_Printf("%-16s%8lu %8lu  %8lu %8lu %8lu\n", level->name,
+				(ULONG)(level->startbytes>>10), (ULONG)(level->peakbytes>>10),
+				(ULONG)(level->peaktag[PU_LEVEL]>>10), (ULONG)(level->peaktag[PU_LEVSPEC]>>10),
+				level->allocs);
+		}
+		return;
+	}
+
+	if (!stricmp(arg, "peak"))
+		zsortkey = 1;
+	else if (!stricmp(arg, "allocs"))
+		zsortkey = 2;
+	else if (!stricmp(arg, "frees"))
+		zsortkey = 3;
+	else if (!stricmp(arg, "live") || !*arg)
+		zsortkey = 0;
+	else
+	{
+		CONS_Printf("zoneprofile on|off|reset|levels|csv <file>\n"
+					"zoneprofile [live|peak|allocs|frees]: list the top allocation sites\n");
+		return;
+	}
+
+	if (!zprofiling && !numzsites)
+	{
+		CONS_Printf("Zone profiling is off, use \"zoneprofile on\"\n");
+		return;
+	}
+
+	sorted = Z_SortedSites();
+	CONS_Printf("\2Site                       Tag  Live KB  Count  Peak KB   Allocs    Frees\n");
+	for (i = 0; i < numzsites && i < 20; i++)
+		CONS_Printf("%-22s:%-4d %3d %8lu %6lu %8lu %8lu %8lu\n", sorted[i]->file, sorted[i]->line,
+			sorted[i]->tag, (ULONG)(sorted[i]->livebytes>>10), sorted[i]->livecount,
+			(ULONG)(sorted[i]->peakbytes>>10), sorted[i]->allocs, sorted[i]->frees);
+	free(sorted);
+
+	CONS_Printf("\2Tag  Now KB  Peak KB\n");
+	for (i = 0; i < ZONETAGS; i++)
+		if (ztagpeak[i])
+			CONS_Printf("%3d %7lu %8lu\n", i, (ULONG)(tagusage[i]>>10), (ULONG)(ztagpeak[i]>>10));
+}
+#endif
+
+// Gets a block of the given total size from an arena,
+// or NULL if it's too big to come from one.
+static memblock_t *Z_ArenaAlloc(memarena_t *arena, size_t size)
+{
+	size_t sizeclass;
+	memchunk_t *chunk;
+	memblock_t *block;
+
+	size = (size + ARENAGRAIN - 1) & ~(size_t)(ARENAGRAIN - 1);
+	if (size > ARENAMAXBLOCK)
+		return NULL;
+	sizeclass = size/ARENAGRAIN - 1;
+
+	block = arena->freelists[sizeclass];
+	if (block)
+	{
+		arena->freelists[sizeclass] = block->next;
+		return block;
+	}
+
+	chunk = arena->chunks;
+	if (!chunk || chunk->used + size > ARENACHUNKSIZE)
+	{
+		chunk = zmalloc(ARENACHUNKSIZE);
+		chunk->arena = arena;
+		chunk->used = CHUNKHEADSIZE;
+		chunk->escaped = 0;
+		chunk->next = arena->chunks;
+		arena->chunks = chunk;
+		arena->numchunks++;
+	}
+
+	block = (memblock_t *)((byte *)chunk + chunk->used);
+	chunk->used += size;
+	block->chunk = chunk;
+	block->size = size;
+	return block;
+}
+
+// Throws away every block in an arena at once.
+static void Z_ReleaseArena(memarena_t *arena)
+{
+	memblock_t *head = &tagheads[arena->tag];
+	memblock_t *block, *next;
+	memchunk_t *chunk, *nextchunk;
+
+	// Only the blocks with a user are in the list
+	// (escaped blocks are in their new tag's list instead)
+	for (block = head->next; block != head; block = next)
+	{
+		next = block->next;
+		if (!block->chunk || block->chunk->arena != arena)
+			continue;
+		if (block->user)
+			*block->user = NULL;
+		Z_UnlinkBlock(block);
+	}
+
+	for (chunk = arena->chunks; chunk; chunk = nextchunk)
+	{
+		nextchunk = chunk->next;
+#ifdef ZDEBUG
+		if (numzsites)
+			Z_ProfileDropChunk(chunk, (byte *)chunk + chunk->used, arena);
+#endif
+		if (chunk->escaped)
+			chunk->arena = NULL;
+		else
+			free(chunk);
+	}
+
+	arena->chunks = NULL;
+	arena->numchunks = 0;
+	memset(arena->freelists, 0, sizeof (arena->freelists));
+}
+
+static void Z_FreeBlock(memblock_t *block)
+{
+	memchunk_t *chunk = block->chunk;
+
+#ifdef ZDEBUG
+	if (block->site)
+		Z_ProfileFree(block);
+#endif
+
+	// TODO: if zdebugging, make sure no other block has a user
+	// that is about to be freed.
+
+	// Clear the user's mark.
+	if (block->user != NULL)
+		*block->user = NULL; // SRB2CBTODO: This can cause crases!
+
+	if (block->flags & ZB_LINKED)
+		Z_UnlinkBlock(block);
+	tagusage[block->tag] -= block->size;
+
+	if (block->flags & ZB_POOLED)
+	{
+		block->next = block->pool->freelist;
+		block->pool->freelist = block;
+		block->pool->live--;
+		return;
+	}
+
+	if (!chunk)
+	{
+		free(block);
+		return;
+	}
+
+	if (Z_BlockEscaped(block, block->tag) && --chunk->escaped == 0 && !chunk->arena)
+	{
+		free(chunk); // last block of an orphaned chunk
+		return;
+	}
+
+	if (chunk->arena)
+	{
+		memblock_t **freelist = &chunk->arena->freelists[block->size/ARENAGRAIN - 1];
+		block->next = *freelist;
+		*freelist = block;
+	}
+}
+
+// Frees the least recently used purgable blocks until "needed" more bytes
+// fit in the cache budget. The block "keep" is never freed.
+static void Z_PurgeCache(size_t needed, memblock_t *keep)
+{
+	size_t limit = (size_t)cv_cachelimit.value<<20;
+	size_t used;
+	memblock_t *oldest;
+	int tag;
+
+	if (!limit || cacheholds)
+		return;
+
+	used = Z_TagsUsage(PU_PURGELEVEL, ZONETAGS - 1);
+	while (used + needed > limit)
+	{
+		// Every list is in use order, so the oldest block is one of the tails
+		oldest = NULL;
+		for (tag = PU_PURGELEVEL; tag < ZONETAGS; tag++)
+		{
+			memblock_t *tail = tagheads[tag].prev;
+			if (tail != &tagheads[tag] && tail != keep && tail != reallocblock
+				&& (!oldest || tail->lastuse < oldest->lastuse))
+				oldest = tail;
+		}
+
+		if (!oldest)
+			break;
+
+		used -= oldest->size;
+		Z_FreeBlock(oldest);
+		cacheevictions++;
+	}
+}
+
+static void CacheLimit_OnChange(void)
+{
+	Z_PurgeCache(0, NULL);
+}
+
+/** Stops purgable blocks from being freed until Z_ReleaseCache,
+  * for callers that keep pointers into the cache for a while. Holds nest.
+  */
+void Z_HoldCache(void)
+{
+	cacheholds++;
+}
+
+/** Ends a Z_HoldCache. The cache limit is enforced again when the
+  * last hold goes.
+  */
+void Z_ReleaseCache(void)
+{
+	if (cacheholds && !--cacheholds)
+		Z_PurgeCache(0, NULL);
+}
+
+/** Marks a purgable block as just used, so it's the last to be purged.
+  * Does nothing for blocks with other tags.
+  *
+  * \param ptr Pointer to the block's data.
+  */
+void Z_Touch(void *ptr)
+{
+	memblock_t *block;
+
+	if (ptr == NULL)
+		return;
+
+	block = ((memhdr_t *)((byte *)ptr - sizeof (memhdr_t)))->block;
+	if (block->tag < PU_PURGELEVEL)
+		return;
+
+	cachehits++;
+	if (tagheads[block->tag].next != block)
+	{
+		Z_UnlinkBlock(block);
+		Z_LinkBlock(block);
+	}
+}
+
+/** Creates a pool of fixed size objects.
+  * Objects are taken from it with Z_PoolCalloc and given back with Z_Free.
+  * The pool lives for the whole execution, its objects until their tag is freed.
+  *
+  * \param name Name shown by the memfree command.
+  * \param size Size of each object.
+  * \param tag  Tag of the objects, usually PU_LEVEL or PU_LEVSPEC.
+  * \return The new pool.
+  */
+mempool_t *Z_CreatePool(const char *name, size_t size, int tag)
+{
+	mempool_t *pool;
+
+	if (numpools >= MAXPOOLS)
+		I_Error("Z_CreatePool: too many pools (creating %s)", name);
+	if (tag < 0 || tag >= ZONETAGS)
+		I_Error("Z_CreatePool: bad tag %d", tag);
+
+	pool = &pools[numpools++];
+	pool->name = name;
+	pool->tag = tag;
+	pool->blocksize = (BLOCKHEADSIZE + size + ARENAGRAIN - 1) & ~(size_t)(ARENAGRAIN - 1);
+	pool->chunksize = max(POOLCHUNKSIZE, CHUNKHEADSIZE + POOLMINOBJECTS*pool->blocksize);
+	return pool;
+}
+
+// Gives back every chunk of a pool, the objects in them are gone
+static void Z_ResetPool(mempool_t *pool)
+{
+	memchunk_t *chunk, *next;
+
+	for (chunk = pool->chunks; chunk; chunk = next)
+	{
+		next = chunk->next;
+#ifdef ZDEBUG
+		if (numzsites)
+			Z_ProfileDropChunk(chunk, Z_PoolChunkEnd(pool, chunk), NULL);
+#endif
+		free(chunk);
+	}
+
+	pool->chunks = NULL;
+	pool->bump = pool->bumpend = NULL;
+	pool->freelist = NULL;
+	pool->live = pool->numchunks = 0;
+}
+
+#ifdef ZDEBUG
+void *Z_PoolCalloc2(mempool_t *pool, const char *file, int line)
+#else
+void *Z_PoolCalloc(mempool_t *pool)
+#endif
+{
+	memblock_t *block = pool->freelist;
+	memhdr_t *hdr;
+	void *given;
+
+	if (block)
+		pool->freelist = block->next;
+	else
+	{
+		if (pool->bump + pool->blocksize > pool->bumpend)
+		{
+			memchunk_t *chunk = zmalloc(pool->chunksize);
+
+			chunk->next = pool->chunks;
+			pool->chunks = chunk;
+			pool->numchunks++;
+			pool->bump = (byte *)chunk + CHUNKHEADSIZE;
+			pool->bumpend = (byte *)chunk + pool->chunksize;
+		}
+
+		block = (memblock_t *)pool->bump;
+		pool->bump += pool->blocksize;
+	}
+
+	given = (byte *)block + BLOCKHEADSIZE;
+	hdr = (memhdr_t *)((byte *)given - sizeof *hdr);
+
+	block->user = NULL;
+	block->tag = pool->tag;
+	block->flags = ZB_POOLED;
+	block->size = pool->blocksize;
+	block->realsize = pool->blocksize - BLOCKHEADSIZE;
+	block->chunk = NULL;
+	block->pool = pool;
+	tagusage[pool->tag] += pool->blocksize;
+#ifdef ZDEBUG
+	block->ownerfile = file;
+	block->ownerline = line;
+	block->site = NULL;
+	if (zprofiling)
+		Z_ProfileAlloc(block);
+#endif
+
+	hdr->id = ZONEID;
+	hdr->block = block;
+
+	pool->allocs++;
+	if (++pool->live > pool->peak)
+		pool->peak = pool->live;
+
+	return memset(given, 0, block->realsize);
 }
 
 #ifdef ZDEBUG
@@ -143,28 +932,10 @@ void Z_Free(void *ptr)
 	DEBFILE(va("Z_Free at %s:%d\n", file, line));
 #endif
 
-	// TODO: if zdebugging, make sure no other block has a user
-	// that is about to be freed.
-
-	// Clear the user's mark.
-	if (block->user != NULL)
-		*block->user = NULL; // SRB2CBTODO: This can cause crases!
+	// Stop the memhdr_t from matching if this pointer is freed twice
+	((memhdr_t *)((byte *)ptr - sizeof (memhdr_t)))->id = 0;
 
-	// Free the memory and get rid of the block.
-	free(block->real);
-	block->prev->next = block->next;
-	block->next->prev = block->prev;
-	free(block);
-}
-
-// malloc() that gives the game a memory error if it fails
-static void *zmalloc(size_t size)
-{
-	void *p;
-	p = malloc(size);
-	if (p == NULL)
-		I_Error("Out of memory allocating %lu bytes", (ULONG)size);
-	return p;
+	Z_FreeBlock(block);
 }
 
 // Z_Malloc
@@ -181,9 +952,8 @@ void *Z_MallocAlign(size_t size, int tag, void *user, int alignbits)
 #endif
 {
 	size_t extrabytes = (1<<alignbits) - 1;
-	memblock_t *block;
+	memblock_t *block = NULL;
 	memhdr_t *hdr;
-	void *ptr;
 	void *given;
 
 #ifdef ZDEBUG2
@@ -193,31 +963,46 @@ void *Z_MallocAlign(size_t size, int tag, void *user, int alignbits)
 	if(!size)
 		return user ? user = NULL : NULL;
 
-	block = zmalloc(sizeof(*block));
-	ptr = zmalloc(extrabytes + sizeof(*hdr) + size);
+	if (tag < 0 || tag >= ZONETAGS)
+		I_Error("Z_Malloc: bad tag %d", tag);
+
+	if (tag >= PU_PURGELEVEL)
+	{
+		cachemisses++;
+		Z_PurgeCache(BLOCKHEADSIZE + extrabytes + size, NULL);
+	}
+
+	if (!alignbits && tagarenas[tag])
+		block = Z_ArenaAlloc(tagarenas[tag], BLOCKHEADSIZE + size);
+
+	if (!block)
+	{
+		block = zmalloc(BLOCKHEADSIZE + extrabytes + size);
+		block->chunk = NULL;
+		block->size = BLOCKHEADSIZE + extrabytes + size;
+	}
 
 	// This horrible calculation makes sure that "given" is aligned
 	// properly.
-	given = (void *)((u_intptr_t)((byte *)ptr + extrabytes + sizeof *hdr)
+	given = (void *)((u_intptr_t)((byte *)block + BLOCKHEADSIZE + extrabytes)
 					 & ~extrabytes);
 
 	// The mem header lives 'sizeof (memhdr_t)' bytes before given.
 	hdr = (memhdr_t *)((byte *)given - sizeof *hdr);
 
-	block->next = head.next;
-	block->prev = &head;
-	block->next->prev = head.next = block;
-
-	block->real = ptr;
-	block->hdr = hdr;
 	block->tag = tag;
+	block->flags = 0;
+	block->pool = NULL;
 	block->user = NULL;
+	block->realsize = size;
+	tagusage[tag] += block->size;
 #ifdef ZDEBUG
 	block->ownerline = line;
 	block->ownerfile = file;
+	block->site = NULL;
+	if (zprofiling)
+		Z_ProfileAlloc(block);
 #endif
-	block->size = size + extrabytes + sizeof(*hdr);
-	block->realsize = size;
 
 	hdr->id = ZONEID;
 	hdr->block = block;
@@ -231,6 +1016,11 @@ void *Z_MallocAlign(size_t size, int tag, void *user, int alignbits)
 		I_Error("Z_Malloc: attempted to allocate purgable block "
 				"(size %lu) with no user", (ULONG)size);
 
+	// Arena blocks without a user are only found again through
+	// Z_Free, so they don't need to be in the tag list
+	if (!block->chunk || block->user)
+		Z_LinkBlock(block);
+
 	return given;
 }
 
@@ -276,23 +1066,19 @@ void *Z_ReallocAlign(void *ptr, size_t size, int tag, void *user, int alignbits)
 	block = Ptr2Memblock(ptr, "Z_Realloc");
 #endif
 
-#ifdef ZDEBUG
-	// Write every Z_Realloc call to a debug file.
-	DEBFILE(va("Z_Realloc at %s:%d\n", file, line));
-#endif
-
-	rez = Z_MallocAlign(size, tag, user, alignbits);
-
 	if (block == NULL)
 		return NULL;
 
 #ifdef ZDEBUG
 	// Write every Z_Realloc call to a debug file.
 	DEBFILE(va("Z_Realloc at %s:%d\n", file, line));
+	reallocblock = block;
 	rez = Z_Malloc2(size, tag, user, alignbits, file, line);
 #else
+	reallocblock = block;
 	rez = Z_MallocAlign(size, tag, user, alignbits);
 #endif
+	reallocblock = NULL;
 
 	if (size < block->realsize)
 		copysize = size;
@@ -309,19 +1095,37 @@ void *Z_ReallocAlign(void *ptr, size_t size, int tag, void *user, int alignbits)
 	return rez;
 }
 
- // SRB2CBTODO: Debugger issues when extra wad files loaded at start
 void Z_FreeTags(int lowtag, int hightag)
 {
-    return;
 	memblock_t *block, *next;
-
-//	Z_CheckHeap(420);
-	for (block = head.next; block != &head; block = next)
+	int tag, i;
+
+	// Only level memory is actually freed here. Blocks of the other tags
+	// still have owners outside the zone (HUD patch pointers, the GL
+	// mipmap cache) that nobody clears, so for those tags this stays
+	// the no-op it always was.
+	if (lowtag < PU_LEVEL)
+		lowtag = PU_LEVEL;
+	if (hightag > PU_PURGELEVEL - 1)
+		hightag = PU_PURGELEVEL - 1;
+
+	for (tag = lowtag; tag <= hightag; tag++)
 	{
-		next = block->next; // get link before freeing
+		if (tagarenas[tag])
+			Z_ReleaseArena(tagarenas[tag]);
+
+		for (i = 0; i < numpools; i++)
+			if (pools[i].tag == tag)
+				Z_ResetPool(&pools[i]);
+
+		// What's left are malloc'd blocks and blocks that escaped an arena
+		for (block = tagheads[tag].next; block != &tagheads[tag]; block = next)
+		{
+			next = block->next; // get link before freeing
+			Z_FreeBlock(block);
+		}
 
-		if (block->tag >= lowtag && block->tag <= hightag)
-			Z_Free((UINT8 *)block->hdr + sizeof *block->hdr);
+		tagusage[tag] = 0;
 	}
 }
 
@@ -359,7 +1163,38 @@ void Z_ChangeTag2(void *ptr, int tag)
 		I_Error("Internal memory management error: "
 				"tried to make block purgable but it has no owner");
 
+	if (tag < 0 || tag >= ZONETAGS)
+		I_Error("Z_ChangeTag: bad tag %d", tag);
+
+	if (tag == block->tag)
+		return;
+
+	if (block->flags & ZB_POOLED)
+		I_Error("Z_ChangeTag: can't change the tag of a %s pool object", block->pool->name);
+
+	if (block->chunk)
+	{
+		boolean wasescaped = Z_BlockEscaped(block, block->tag);
+		boolean escaped = Z_BlockEscaped(block, tag);
+
+		if (escaped && !wasescaped)
+			block->chunk->escaped++;
+		else if (wasescaped && !escaped)
+			block->chunk->escaped--;
+	}
+
+	if (block->flags & ZB_LINKED)
+		Z_UnlinkBlock(block);
+	tagusage[block->tag] -= block->size;
+
 	block->tag = tag;
+
+	tagusage[tag] += block->size;
+	if (!block->chunk || block->user || Z_BlockEscaped(block, tag))
+		Z_LinkBlock(block);
+
+	if (tag >= PU_PURGELEVEL)
+		Z_PurgeCache(0, block);
 }
 
 /** Calculates memory usage for a given set of tags.
@@ -371,16 +1206,16 @@ void Z_ChangeTag2(void *ptr, int tag)
  */
 static size_t Z_TagsUsage(int lowtag, int hightag)
 {
-    return 40400; // TODO: GET RID OF ZONE
 	size_t cnt = 0;
-	memblock_t *rover;
+	int tag;
 
-	for (rover = head.next; rover != &head; rover = rover->next)
-	{
-		if (rover->tag < lowtag || rover->tag > hightag)
-			continue;
-		cnt += rover->size + sizeof(*rover);
-	}
+	if (lowtag < 0)
+		lowtag = 0;
+	if (hightag >= ZONETAGS)
+		hightag = ZONETAGS - 1;
+
+	for (tag = lowtag; tag <= hightag; tag++)
+		cnt += tagusage[tag];
 
 	return cnt;
 }
@@ -390,9 +1225,15 @@ size_t Z_TagUsage(int tagnum)
 	return Z_TagsUsage(tagnum, tagnum);
 }
 
+size_t Z_TotalUsage(void)
+{
+	return Z_TagsUsage(0, ZONETAGS - 1);
+}
+
 void Command_Memfree_f(void)
 {
 	ULONG freebytes, totalbytes;
+	int i;
 
 	CONS_Printf("\2Memory Info\n");
 	CONS_Printf("Total heap used   : %7d KB\n", (int)(Z_TagsUsage(0, MAXINT)>>10));
@@ -401,8 +1242,20 @@ void Command_Memfree_f(void)
 	CONS_Printf("Static (music)    : %7d KB\n", (int)(Z_TagUsage(PU_MUSIC)>>10));
 	CONS_Printf("Level             : %7d KB\n", (int)(Z_TagUsage(PU_LEVEL)>>10));
 	CONS_Printf("Special thinker   : %7d KB\n", (int)(Z_TagUsage(PU_LEVSPEC)>>10));
+	CONS_Printf("Level arenas      : %7d KB\n",
+				(int)(((levelarena.numchunks + levspecarena.numchunks) * ARENACHUNKSIZE)>>10));
 	CONS_Printf("All purgable      : %7d KB\n",
 				(int)(Z_TagsUsage(PU_PURGELEVEL, MAXINT)>>10));
+	if (cv_cachelimit.value)
+		CONS_Printf("Purgable limit    : %7d KB\n", cv_cachelimit.value<<10);
+	CONS_Printf("Cache hits %lu, misses %lu, evictions %lu\n",
+				cachehits, cachemisses, cacheevictions);
+
+	CONS_Printf("\2Object Pools\n");
+	for (i = 0; i < numpools; i++)
+		CONS_Printf("%-18s: %6lu live, %6lu peak, %4d KB, %lu allocs\n", pools[i].name,
+					(ULONG)pools[i].live, (ULONG)pools[i].peak,
+					(int)((pools[i].numchunks * pools[i].chunksize)>>10), pools[i].allocs);
 
 #ifdef HWRENDER
 	if (rendermode == render_opengl)
@@ -85,6 +85,29 @@ void *Z_ReallocAlign(void *ptr, size_t size, int tag, void *user, int alignbits)
 #endif
 
 size_t Z_TagUsage(int tagnum);
+size_t Z_TotalUsage(void);
+
+// Purgable blocks are freed least recently used first once there are
+// more than cv_cachelimit megabytes of them
+void Z_Touch(void *ptr);
+// Nothing is purged between these, so pointers into cached blocks stay valid
+void Z_HoldCache(void);
+void Z_ReleaseCache(void);
+
+#ifdef ZDEBUG
+// Allocation statistics are kept per level, see the zoneprofile command
+void Z_ProfileLevel(const char *name);
+#endif
+
+// Pools of fixed size objects, freed with Z_Free
+typedef struct mempool_s mempool_t;
+mempool_t *Z_CreatePool(const char *name, size_t size, int tag);
+#ifdef ZDEBUG
+#define Z_PoolCalloc(p) Z_PoolCalloc2(p, __FILE__, __LINE__)
+void *Z_PoolCalloc2(mempool_t *pool, const char *file, int line);
+#else
+void *Z_PoolCalloc(mempool_t *pool);
+#endif
 
 char *Z_StrDup(const char *in);
 